@@ -26,21 +26,50 @@ interface MLRecommendation {
   basedOnExecutions: number
 }
 
+interface PlanckCoreAddon {
+  vectorize(features: CircuitFeatures): Float64Array
+}
+
+let planckCore: Promise<PlanckCoreAddon | null> | undefined
+
+/**
+ * Load the planck_core Node addon (cmake target planck_node) named by
+ * PLANCK_CORE_ADDON; null when unset or not loadable on this platform.
+ * "module" is imported lazily so the file stays safe to bundle for the browser.
+ */
+function loadPlanckCore(): Promise<PlanckCoreAddon | null> {
+  if (planckCore === undefined) planckCore = importPlanckCore()
+  return planckCore
+}
+
+async function importPlanckCore(): Promise<PlanckCoreAddon | null> {
+  const addonPath = typeof process !== "undefined" ? process.env.PLANCK_CORE_ADDON : undefined
+  if (!addonPath) return null
+  try {
+    const { createRequire } = await import("module")
+    return createRequire(import.meta.url)(addonPath) as PlanckCoreAddon
+  } catch (error) {
+    return null
+  }
+}
+
 export class CppMLEngine {
   /**
    * Generate normalized feature vector using C++ vectorizer
    */
   static async vectorizeFeatures(features: CircuitFeatures): Promise<number[]> {
     try {
-      // In production environment with C++ compilation:
-      // const { spawn } = await import("child_process")
-      // const result = await new Promise<string>((resolve, reject) => {
-      //   const process = spawn("./scripts/ml_feature_vectorizer", [JSON.stringify(features)])
-      //   let output = ""
-      //   process.stdout.on("data", (data) => (output += data))
-      //   process.on("close", (code) => (code === 0 ? resolve(output) : reject(new Error("Vectorizer failed"))))
-      // })
-      // return JSON.parse(result)
+      // Native planck_core addon: in-process, no JSON round trip
+      const addon = await loadPlanckCore()
+      if (addon) return Array.from(addon.vectorize(features))
+
+      // Without the addon, keep one
+      // ./scripts/ml_recommendation_server running (--socket /tmp/planck-ml.sock)
+      // and send tab-separated request lines instead of spawning a process per call:
+      // const { createConnection } = await import("net")
+      // const socket = createConnection("/tmp/planck-ml.sock")
+      // socket.write(`${requestId}\tvectorize\t${JSON.stringify(features)}\n`)
+      // ...match the "<requestId>\t<json>" response line and return JSON.parse(json)
 
       // Fallback TypeScript implementation for browser environment
       return this.vectorizeFeaturesTS(features)
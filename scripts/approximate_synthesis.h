@@ -0,0 +1,564 @@
+/*
+ * Approximate Synthesis - Fidelity-budgeted two-qubit resynthesis
+ * Runs on a routed circuit. Consecutive gates on one qubit pair (SWAPs
+ * included) are multiplied into a 4x4 unitary and split by the KAK
+ * decomposition into local gates around exp(i(x XX + y YY + z ZZ)). The
+ * Weyl coordinates (x, y, z) fix how many CNOTs the block needs (0-3), so
+ * SWAP followed by CX, for instance, needs 2 rather than 4. Zeroing the
+ * smallest coordinates gives cheaper approximations whose infidelity is
+ * known exactly; a block is rewritten when approximation error plus the
+ * CNOTs it keeps costs less than the CNOTs it had, until the error budget
+ * is spent. Near-identity rotations are dropped under the same rule.
+ */
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include <memory_resource>
+
+#include "quantum_transpiler.h"
+#include "quantum_hardware_benchmarks.h"
+#include "unitary.h"
+
+using namespace std;
+
+struct ApproximationOptions {
+    double two_qubit_error = 0.0;     // Infidelity of one CNOT
+    double single_qubit_error = 0.0;  // Infidelity of one single-qubit gate
+    double fidelity_budget = 0.0;     // Total infidelity approximations may add
+
+    // Budget counted in two-qubit gate errors of the device
+    static ApproximationOptions from_hardware(const HardwareSpec& hw, double budget_two_qubit_gates = 1.0) {
+        ApproximationOptions options;
+        options.two_qubit_error = 1.0 - hw.two_qubit_fidelity;
+        options.single_qubit_error = 1.0 - hw.single_qubit_fidelity;
+        options.fidelity_budget = budget_two_qubit_gates * options.two_qubit_error;
+        return options;
+    }
+};
+
+struct ApproximationReport {
+    int two_qubit_before = 0;  // CNOT count, SWAP = 3
+    int two_qubit_after = 0;
+    int blocks_resynthesized = 0;
+    int rotations_dropped = 0;
+    double approximation_error = 0.0;  // Budget spent
+};
+
+// U = (after_first ⊗ after_second) exp(i(x XX + y YY + z ZZ))
+//     (before_first ⊗ before_second), up to global phase
+struct KakDecomposition {
+    Matrix2 before_first, before_second;
+    Matrix2 after_first, after_second;
+    array<double, 3> coordinates;  // x, y, z
+};
+
+// Diagonal of XX, YY and ZZ in the magic basis; a canonical gate is
+// diag(exp(i coordinates . sign[j])) there
+const int MAGIC_SIGNS[4][3] = {{1, -1, 1}, {1, 1, -1}, {-1, -1, -1}, {-1, 1, 1}};
+
+inline Matrix4 magic_basis() {
+    const double r = 1 / sqrt(2.0);
+    const Complex i(0, r);
+    return {r, 0.0, 0.0, i, 0.0, i, r, 0.0, 0.0, i, -r, 0.0, r, 0.0, 0.0, -i};
+}
+
+// Eigenvectors (columns of vectors) of a real symmetric 4x4 matrix, by
+// cyclic Jacobi rotations
+inline void symmetric_eigenvectors(array<double, 16> a, array<double, 16>& vectors) {
+    vectors.fill(0.0);
+    for(int i = 0; i < 4; i++) vectors[i * 5] = 1.0;
+    for(int sweep = 0; sweep < 50; sweep++) {
+        double off = 0.0;
+        for(int p = 0; p < 4; p++) for(int q = p + 1; q < 4; q++) off += a[p * 4 + q] * a[p * 4 + q];
+        if(off < 1e-30) return;
+        for(int p = 0; p < 4; p++) {
+            for(int q = p + 1; q < 4; q++) {
+                double apq = a[p * 4 + q];
+                if(fabs(apq) < 1e-300) continue;
+                double theta = (a[q * 4 + q] - a[p * 4 + p]) / (2 * apq);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1));
+                double c = 1 / sqrt(t * t + 1), s = t * c;
+                for(int k = 0; k < 4; k++) {
+                    double akp = a[k * 4 + p], akq = a[k * 4 + q];
+                    a[k * 4 + p] = c * akp - s * akq;
+                    a[k * 4 + q] = s * akp + c * akq;
+                }
+                for(int k = 0; k < 4; k++) {
+                    double apk = a[p * 4 + k], aqk = a[q * 4 + k];
+                    a[p * 4 + k] = c * apk - s * aqk;
+                    a[q * 4 + k] = s * apk + c * aqk;
+                }
+                for(int k = 0; k < 4; k++) {
+                    double vkp = vectors[k * 4 + p], vkq = vectors[k * 4 + q];
+                    vectors[k * 4 + p] = c * vkp - s * vkq;
+                    vectors[k * 4 + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+}
+
+inline Complex determinant(Matrix4 m) {
+    Complex det = 1.0;
+    for(int col = 0; col < 4; col++) {
+        int pivot = col;
+        for(int row = col + 1; row < 4; row++) if(abs(m[row * 4 + col]) > abs(m[pivot * 4 + col])) pivot = row;
+        if(abs(m[pivot * 4 + col]) < 1e-300) return 0.0;
+        if(pivot != col) {
+            for(int k = 0; k < 4; k++) swap(m[col * 4 + k], m[pivot * 4 + k]);
+            det = -det;
+        }
+        det *= m[col * 4 + col];
+        for(int row = col + 1; row < 4; row++) {
+            Complex factor = m[row * 4 + col] / m[col * 4 + col];
+            for(int k = col; k < 4; k++) m[row * 4 + k] -= factor * m[col * 4 + k];
+        }
+    }
+    return det;
+}
+
+// Splits a tensor product of single-qubit unitaries into its factors
+inline void split_local(const Matrix4& m, Matrix2& first, Matrix2& second) {
+    auto block = [&](int i, int j) {
+        return Matrix2{m[(2 * i) * 4 + 2 * j], m[(2 * i) * 4 + 2 * j + 1],
+                       m[(2 * i + 1) * 4 + 2 * j], m[(2 * i + 1) * 4 + 2 * j + 1]};
+    };
+    int bi = 0, bj = 0;
+    double best = -1.0;
+    for(int i = 0; i < 2; i++) {
+        for(int j = 0; j < 2; j++) {
+            Matrix2 b = block(i, j);
+            double weight = norm(b[0]) + norm(b[1]) + norm(b[2]) + norm(b[3]);
+            if(weight > best) {
+                best = weight;
+                bi = i;
+                bj = j;
+            }
+        }
+    }
+    second = block(bi, bj);
+    Complex scale = sqrt(second[0] * second[3] - second[1] * second[2]);
+    for(auto& v : second) v /= scale;
+    Matrix2 inverse = adjoint(second);
+    for(int i = 0; i < 2; i++) {
+        for(int j = 0; j < 2; j++) {
+            Matrix2 b = multiply(inverse, block(i, j));
+            first[i * 2 + j] = (b[0] + b[3]) / 2.0;
+        }
+    }
+}
+
+// KAK decomposition in the magic basis, where local gates are real
+// orthogonal and canonical gates diagonal: U_B^T U_B is diagonalised by a
+// real rotation, whose eigenphases give the coordinates. False if the
+// eigenproblem does not separate (numerically degenerate input).
+inline bool kak_decompose(const Matrix4& unitary, KakDecomposition& kak) {
+    Matrix4 magic = magic_basis();
+    Matrix4 u = unitary;
+    Complex phase = pow(determinant(u), -0.25);
+    for(auto& v : u) v *= phase;
+    Matrix4 um = multiply(adjoint(magic), multiply(u, magic));
+
+    Matrix4 square{};  // um^T um
+    for(int i = 0; i < 4; i++)
+        for(int j = 0; j < 4; j++)
+            for(int k = 0; k < 4; k++) square[i * 4 + j] += um[k * 4 + i] * um[k * 4 + j];
+
+    // Real and imaginary parts commute; a generic mix shares their eigenvectors
+    array<double, 16> rotation;
+    bool diagonal = false;
+    for(double mix : {0.6180339887, 1.4142135623, 2.7182818284, 0.3141592653}) {
+        array<double, 16> combined;
+        for(int i = 0; i < 16; i++) combined[i] = square[i].real() + mix * square[i].imag();
+        symmetric_eigenvectors(combined, rotation);
+        diagonal = true;
+        for(int i = 0; i < 4 && diagonal; i++) {
+            for(int j = 0; j < 4 && diagonal; j++) {
+                if(i == j) continue;
+                Complex entry = 0.0;
+                for(int k = 0; k < 4; k++)
+                    for(int l = 0; l < 4; l++) entry += rotation[k * 4 + i] * square[k * 4 + l] * rotation[l * 4 + j];
+                diagonal = abs(entry) < 1e-9;
+            }
+        }
+        if(diagonal) break;
+    }
+    if(!diagonal) return false;
+
+    Matrix4 p;
+    for(int i = 0; i < 16; i++) p[i] = rotation[i];
+    if(determinant(p).real() < 0) for(int k = 0; k < 4; k++) p[k * 4] = -p[k * 4];
+
+    // um = o1 diag(d) p^T with o1 real orthogonal
+    Matrix4 up = multiply(um, p);
+    array<Complex, 4> d;
+    for(int j = 0; j < 4; j++) {
+        Complex eigenvalue = 0.0;
+        for(int k = 0; k < 4; k++)
+            for(int l = 0; l < 4; l++) eigenvalue += p[k * 4 + j] * square[k * 4 + l] * p[l * 4 + j];
+        d[j] = sqrt(eigenvalue);
+    }
+    Matrix4 o1;
+    for(int i = 0; i < 4; i++) for(int j = 0; j < 4; j++) o1[i * 4 + j] = up[i * 4 + j] / d[j];
+    if(determinant(o1).real() < 0) {
+        d[0] = -d[0];
+        for(int k = 0; k < 4; k++) o1[k * 4] = -o1[k * 4];
+    }
+
+    Matrix4 after = multiply(magic, multiply(o1, adjoint(magic)));
+    Matrix4 before = multiply(magic, multiply(adjoint(p), adjoint(magic)));
+    split_local(after, kak.after_first, kak.after_second);
+    split_local(before, kak.before_first, kak.before_second);
+
+    double theta[4];
+    for(int j = 0; j < 4; j++) theta[j] = arg(d[j]);
+    kak.coordinates = {(theta[0] + theta[1] - theta[2] - theta[3]) / 4,
+                       (-theta[0] + theta[1] - theta[2] + theta[3]) / 4,
+                       (theta[0] - theta[1] - theta[2] + theta[3]) / 4};
+    return true;
+}
+
+// Average gate fidelity between two canonical gates
+inline double canonical_fidelity(const array<double, 3>& a, const array<double, 3>& b) {
+    Complex trace = 0.0;
+    for(int j = 0; j < 4; j++) {
+        double angle = 0.0;
+        for(int c = 0; c < 3; c++) angle += (b[c] - a[c]) * MAGIC_SIGNS[j][c];
+        trace += polar(1.0, angle);
+    }
+    return (4 + norm(trace)) / 20;
+}
+
+class ApproximateSynthesizer {
+private:
+    // Circuit over a qubit pair: single-qubit matrices and CNOTs
+    struct PairOp {
+        enum Kind { FIRST, SECOND, CX_FIRST_SECOND, CX_SECOND_FIRST } kind;
+        Matrix2 matrix;
+    };
+
+    ApproximationOptions options;
+    double budget_left = 0.0;
+
+    static constexpr double ZERO = 1e-9;
+
+    static int cnots_needed(const array<double, 3>& c) {
+        int nonzero = 0;
+        double largest = 0.0;
+        for(double v : c) {
+            if(fabs(v) > ZERO) nonzero++;
+            largest = max(largest, fabs(v));
+        }
+        if(nonzero == 0) return 0;
+        if(nonzero == 1 && fabs(largest - M_PI / 4) < ZERO) return 1;
+        return nonzero == 3 ? 3 : 2;
+    }
+
+    static Matrix2 pauli(int axis) {
+        const Complex i(0, 1);
+        if(axis == 0) return {0.0, 1.0, 1.0, 0.0};
+        if(axis == 1) return {0.0, -i, i, 0.0};
+        return {1.0, 0.0, 0.0, -1.0};
+    }
+
+    static void local(vector<PairOp>& ops, const Matrix2& first, const Matrix2& second) {
+        ops.push_back({PairOp::FIRST, first});
+        ops.push_back({PairOp::SECOND, second});
+    }
+
+    static void cx(vector<PairOp>& ops, bool first_controls = true) {
+        ops.push_back({first_controls ? PairOp::CX_FIRST_SECOND : PairOp::CX_SECOND_FIRST, identity2()});
+    }
+
+    // exp(i(x XX + z ZZ)) = CX (Rx(-2x) ⊗ Rz(-2z)) CX
+    static void xx_zz(vector<PairOp>& ops, double x, double z) {
+        cx(ops);
+        local(ops, rx_matrix(-2 * x), rz_matrix(-2 * z));
+        cx(ops);
+    }
+
+    // Canonical gate with coordinates already in [-pi/4, pi/4], using
+    // cnots_needed(c) CNOTs
+    static void canonical_circuit(vector<PairOp>& ops, const array<double, 3>& c) {
+        const Matrix2 s = {1.0, 0.0, 0.0, Complex(0, 1)};
+        const Matrix2 h = {M_SQRT1_2, M_SQRT1_2, M_SQRT1_2, -M_SQRT1_2};
+        int cnots = cnots_needed(c);
+        if(cnots == 0) return;
+
+        if(cnots == 3) {
+            // Vatan-Williams three-CNOT circuit
+            local(ops, identity2(), rz_matrix(M_PI / 2));
+            cx(ops, false);
+            local(ops, rz_matrix(-M_PI / 2 - 2 * c[2]), ry_matrix(-M_PI / 2 - 2 * c[0]));
+            cx(ops);
+            local(ops, identity2(), ry_matrix(M_PI / 2 + 2 * c[1]));
+            cx(ops, false);
+            local(ops, rz_matrix(-M_PI / 2), identity2());
+            return;
+        }
+
+        if(cnots == 1) {
+            // exp(i pi/4 XX) = (H ⊗ I) CX (Rz(-pi/2) ⊗ Rx(-pi/2)) (H ⊗ I);
+            // to_axis maps X onto the coordinate's axis, -pi/4 adds X ⊗ X
+            int axis = fabs(c[0]) > ZERO ? 0 : fabs(c[1]) > ZERO ? 1 : 2;
+            Matrix2 to_axis = axis == 0 ? identity2() : axis == 1 ? s : h;
+            local(ops, adjoint(to_axis), adjoint(to_axis));
+            if(c[axis] < 0) local(ops, pauli(0), pauli(0));
+            local(ops, multiply(rz_matrix(-M_PI / 2), h), rx_matrix(-M_PI / 2));
+            cx(ops);
+            local(ops, multiply(to_axis, h), to_axis);
+            return;
+        }
+
+        // The XX+ZZ form covers every pair after a basis change that maps
+        // X (or Z) onto Y on both qubits
+        bool x = fabs(c[0]) > ZERO, y = fabs(c[1]) > ZERO;
+        Matrix2 basis = identity2();
+        double first_angle = c[0], second_angle = c[2];
+        if(y && !x) {
+            basis = s;  // S X S^dagger = Y, Z fixed
+            first_angle = c[1];
+        } else if(y) {
+            basis = rx_matrix(M_PI / 2);  // Z -> Y, X fixed
+            second_angle = c[1];
+        }
+        local(ops, adjoint(basis), adjoint(basis));
+        xx_zz(ops, first_angle, second_angle);
+        local(ops, basis, basis);
+    }
+
+    static Matrix4 pair_unitary(const vector<PairOp>& ops) {
+        static const Matrix4 CX_FS = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0};
+        static const Matrix4 CX_SF = {1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0};
+        Matrix4 u = identity4();
+        for(const PairOp& op : ops) {
+            switch(op.kind) {
+                case PairOp::FIRST: u = multiply(kron(op.matrix, identity2()), u); break;
+                case PairOp::SECOND: u = multiply(kron(identity2(), op.matrix), u); break;
+                case PairOp::CX_FIRST_SECOND: u = multiply(CX_FS, u); break;
+                case PairOp::CX_SECOND_FIRST: u = multiply(CX_SF, u); break;
+            }
+        }
+        return u;
+    }
+
+    // Fuses runs of single-qubit matrices and appends u3 / rz / cx gates
+    static void emit(const vector<PairOp>& ops, int first, int second, pmr::vector<Gate>& out) {
+        Matrix2 pending[2] = {identity2(), identity2()};
+        auto flush = [&](int side) {
+            double theta, phi, lambda;
+            u3_angles(pending[side], theta, phi, lambda);
+            pending[side] = identity2();
+            int qubit = side == 0 ? first : second;
+            double turn = remainder(phi + lambda, 2 * M_PI);
+            if(fabs(theta) < ZERO) {
+                if(fabs(turn) > ZERO) out.emplace_back("rz", initializer_list<int>{qubit}, initializer_list<GateParameters::value_type>{{"theta", turn}});
+                return;
+            }
+            out.emplace_back("u3", initializer_list<int>{qubit},
+                             initializer_list<GateParameters::value_type>{{"lambda", lambda}, {"phi", phi}, {"theta", theta}});
+        };
+        for(const PairOp& op : ops) {
+            if(op.kind == PairOp::FIRST || op.kind == PairOp::SECOND) {
+                int side = op.kind == PairOp::FIRST ? 0 : 1;
+                pending[side] = multiply(op.matrix, pending[side]);
+                continue;
+            }
+            flush(0);
+            flush(1);
+            bool forward = op.kind == PairOp::CX_FIRST_SECOND;
+            out.emplace_back("cx", initializer_list<int>{forward ? first : second, forward ? second : first});
+        }
+        flush(0);
+        flush(1);
+    }
+
+    // Cheapest circuit for the block within the budget; empty if nothing
+    // beats the current cnots
+    bool resynthesize(const Matrix4& unitary, int cnots, vector<PairOp>& ops, double& error) {
+        KakDecomposition kak;
+        if(!kak_decompose(unitary, kak)) return false;
+
+        // Shift coordinates into [-pi/4, pi/4]; exp(i pi/2 PP) = i P ⊗ P
+        // joins the local gates in front
+        array<double, 3> c = kak.coordinates;
+        for(int axis = 0; axis < 3; axis++) {
+            Matrix2 p = pauli(axis);
+            while(c[axis] > M_PI / 4 + ZERO) {
+                c[axis] -= M_PI / 2;
+                kak.before_first = multiply(p, kak.before_first);
+                kak.before_second = multiply(p, kak.before_second);
+            }
+            while(c[axis] < -M_PI / 4 - ZERO) {
+                c[axis] += M_PI / 2;
+                kak.before_first = multiply(p, kak.before_first);
+                kak.before_second = multiply(p, kak.before_second);
+            }
+        }
+
+        // Candidates: exact, smallest coordinate dropped, nearest CNOT, identity
+        array<int, 3> order = {0, 1, 2};
+        sort(order.begin(), order.end(), [&](int a, int b) { return fabs(c[a]) > fabs(c[b]); });
+        array<array<double, 3>, 4> candidates;
+        candidates[0] = c;
+        candidates[1] = c;
+        candidates[1][order[2]] = 0.0;
+        candidates[2] = {0.0, 0.0, 0.0};
+        candidates[2][order[0]] = c[order[0]] < 0 ? -M_PI / 4 : M_PI / 4;
+        candidates[3] = {0.0, 0.0, 0.0};
+
+        double best_cost = cnots * options.two_qubit_error;
+        int best = -1, best_cnots = cnots;
+        for(int i = 0; i < 4; i++) {
+            int needed = cnots_needed(candidates[i]);
+            if(needed >= cnots) continue;
+            double infidelity = max(0.0, 1.0 - canonical_fidelity(c, candidates[i]));
+            if(infidelity > budget_left + ZERO) continue;
+            double cost = infidelity + needed * options.two_qubit_error;
+            // Ties (e.g. exact reductions with no error model) go to fewer CNOTs
+            if(cost < best_cost - 1e-15 || (cost <= best_cost + 1e-15 && needed < best_cnots)) {
+                best_cost = cost;
+                best_cnots = needed;
+                best = i;
+                error = infidelity;
+            }
+        }
+        if(best < 0) return false;
+
+        ops.clear();
+        local(ops, kak.before_first, kak.before_second);
+        canonical_circuit(ops, candidates[best]);
+        local(ops, kak.after_first, kak.after_second);
+
+        // The KAK factors are numerical; never ship a circuit that misses
+        // the fidelity it was chosen for
+        return 1.0 - average_gate_fidelity(unitary, pair_unitary(ops)) <= error + 1e-6;
+    }
+
+public:
+    explicit ApproximateSynthesizer(const ApproximationOptions& opts) : options(opts) {}
+
+    // Rewritten copy of a routed circuit, allocated like the input
+    pmr::vector<Gate> compile(const pmr::vector<Gate>& circuit, ApproximationReport* report = nullptr) {
+        ApproximationReport stats;
+        budget_left = options.fidelity_budget;
+        size_t n = circuit.size();
+        vector<char> removed(n, 0);
+        for(const Gate& gate : circuit) stats.two_qubit_before += cnot_cost(gate);
+
+        // Rotations whose error as identity is below a gate's own error
+        for(size_t i = 0; i < n; i++) {
+            double theta;
+            if(!rotation_angle(circuit[i], theta)) continue;
+            double half = remainder(theta, 2 * M_PI) / 2;
+            double infidelity = 2.0 / 3.0 * sin(half) * sin(half);
+            if(infidelity <= options.single_qubit_error && infidelity <= budget_left) {
+                removed[i] = 1;
+                budget_left -= infidelity;
+                stats.approximation_error += infidelity;
+                stats.rotations_dropped++;
+            }
+        }
+
+        // Blocks: maximal runs of gates on one pair between other
+        // interactions of either qubit
+        struct Block {
+            int first, second;
+            vector<size_t> members;
+            int cnots = 0;
+        };
+        vector<Block> blocks;
+        vector<int> open;
+        auto qubit_slot = [&](int q) -> int& {
+            if(q >= (int)open.size()) open.resize(q + 1, -1);
+            return open[q];
+        };
+        auto close = [&](int q) {
+            int b = qubit_slot(q);
+            if(b < 0) return;
+            qubit_slot(blocks[b].first) = -1;
+            qubit_slot(blocks[b].second) = -1;
+        };
+        for(size_t i = 0; i < n; i++) {
+            if(removed[i]) continue;
+            const Gate& gate = circuit[i];
+            Matrix2 m2;
+            Matrix4 m4;
+            if(single_qubit_unitary(gate, m2)) {
+                int b = qubit_slot(gate.qubits[0]);
+                if(b >= 0) blocks[b].members.push_back(i);
+            } else if(two_qubit_unitary(gate, m4) && gate.qubits[0] != gate.qubits[1]) {
+                int p = gate.qubits[0], q = gate.qubits[1];
+                int b = qubit_slot(p);
+                if(b < 0 || b != qubit_slot(q)) {
+                    close(p);
+                    close(q);
+                    blocks.push_back({p, q, {}, 0});
+                    b = blocks.size() - 1;
+                    qubit_slot(p) = b;
+                    qubit_slot(q) = b;
+                }
+                blocks[b].members.push_back(i);
+                blocks[b].cnots += cnot_cost(gate);
+            } else {
+                for(int q : gate.qubits) close(q);
+            }
+        }
+
+        // Replacement circuits, emitted where each block's last gate was
+        vector<int> replaced_at(n, -1);
+        vector<vector<PairOp>> replacements;
+        vector<const Block*> replaced_blocks;
+        for(const Block& block : blocks) {
+            if(block.cnots < 2) continue;
+            Matrix4 u = identity4();
+            for(size_t i : block.members) {
+                const Gate& gate = circuit[i];
+                Matrix2 m2;
+                Matrix4 m4;
+                if(single_qubit_unitary(gate, m2)) {
+                    u = multiply(gate.qubits[0] == block.first ? kron(m2, identity2()) : kron(identity2(), m2), u);
+                } else {
+                    two_qubit_unitary(gate, m4);
+                    if(gate.qubits[0] != block.first) {
+                        Matrix4 swapped;  // Same gate with the qubit roles exchanged
+                        static const int perm[4] = {0, 2, 1, 3};
+                        for(int r = 0; r < 4; r++) for(int c = 0; c < 4; c++) swapped[perm[r] * 4 + perm[c]] = m4[r * 4 + c];
+                        m4 = swapped;
+                    }
+                    u = multiply(m4, u);
+                }
+            }
+
+            vector<PairOp> ops;
+            double error = 0.0;
+            if(!resynthesize(u, block.cnots, ops, error)) continue;
+            budget_left -= error;
+            stats.approximation_error += error;
+            stats.blocks_resynthesized++;
+            for(size_t i : block.members) removed[i] = 1;
+            replaced_at[block.members.back()] = replacements.size();
+            replacements.push_back(move(ops));
+            replaced_blocks.push_back(&block);
+        }
+
+        pmr::vector<Gate> out(circuit.get_allocator());
+        out.reserve(n);
+        for(size_t i = 0; i < n; i++) {
+            if(replaced_at[i] >= 0) {
+                const Block* block = replaced_blocks[replaced_at[i]];
+                emit(replacements[replaced_at[i]], block->first, block->second, out);
+            } else if(!removed[i]) {
+                out.push_back(circuit[i]);
+            }
+        }
+        for(const Gate& gate : out) stats.two_qubit_after += cnot_cost(gate);
+        if(report) *report = stats;
+        return out;
+    }
+};
@@ -0,0 +1,52 @@
+/*
+ * Allocation Counter - Global operator new hook
+ * Counts with a relaxed atomic so the hook adds a few nanoseconds at most.
+ * With PLANCK_METRICS the core library already owns the hook, so the
+ * benchmark thread's own allocation counter is read instead.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "alloc_counter.h"
+#include "core/metrics.h"
+
+#ifdef PLANCK_METRICS
+
+size_t allocation_count() { return metrics_thread_value(Metric::ALLOCATIONS); }
+
+#else
+
+static std::atomic<size_t> allocations{0};
+
+size_t allocation_count() { return allocations.load(std::memory_order_relaxed); }
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// std::pmr's default resource allocates through the aligned forms
+void* operator new(size_t size, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t align = (size_t)alignment;
+    if(void* p = std::aligned_alloc(align, (size + align) / align * align)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * Allocation Counter - Heap allocations made inside a benchmark loop
+ * alloc_counter.cpp replaces the global operator new, so every allocation in
+ * the process is counted. Benchmarks snapshot the count around their loop
+ * and report allocations per iteration alongside throughput.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <benchmark/benchmark.h>
+
+size_t allocation_count();
+
+class AllocationScope {
+private:
+    benchmark::State& state;
+    size_t start;
+
+public:
+    AllocationScope(benchmark::State& s) : state(s), start(allocation_count()) {}
+
+    ~AllocationScope() {
+        state.counters["allocs_per_iter"] = benchmark::Counter(
+            (double)(allocation_count() - start), benchmark::Counter::kAvgIterations);
+    }
+};
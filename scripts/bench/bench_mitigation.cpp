@@ -0,0 +1,162 @@
+/*
+ * Mitigation benchmarks - Count handling and readout correction at 10^5 shots
+ */
+
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include "alloc_counter.h"
+#include "shot_results.h"
+#include "error_mitigation.h"
+#include "mitigation_benchmark.h"
+#include "core/arena.h"
+
+using namespace std;
+
+// Shots biased towards low-weight outcomes, like a noisy near-basis state
+static ShotResults synthetic_shots(int num_qubits, size_t shots, unsigned seed) {
+    mt19937_64 gen(seed);
+    uint64_t mask = num_qubits == 64 ? ~0ULL : (1ULL << num_qubits) - 1;
+    ShotResults results(num_qubits);
+    results.reserve(shots);
+    for(size_t i = 0; i < shots; i++) results.add_shot(gen() & gen() & gen() & mask);
+    return results;
+}
+
+static void BM_CountShots(benchmark::State& state) {
+    ShotResults shots = synthetic_shots(state.range(0), 100000, 1);
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(shots.counts());
+    }
+    state.SetItemsProcessed(state.iterations() * shots.size());
+}
+BENCHMARK(BM_CountShots)->Arg(8)->Arg(16)->Arg(24);
+
+static void BM_Marginal(benchmark::State& state) {
+    ShotResults shots = synthetic_shots(24, 100000, 2);
+    vector<int> keep = {0, 3, 5, 8, 13, 21};
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(shots.marginal(keep));
+    }
+    state.SetItemsProcessed(state.iterations() * shots.size());
+}
+BENCHMARK(BM_Marginal);
+
+static void BM_ParityExpectation(benchmark::State& state) {
+    ShotResults shots = synthetic_shots(24, 100000, 3);
+    uint64_t mask = 0xA5A5A5;
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(parity_expectation(shots, &mask));
+    }
+    state.SetItemsProcessed(state.iterations() * shots.size());
+}
+BENCHMARK(BM_ParityExpectation);
+
+static void BM_MitigateReadout(benchmark::State& state) {
+    int n = state.range(0);
+    CountTable counts = synthetic_shots(n, 100000, 4).counts();
+    vector<double> p01(n, 0.02), p10(n, 0.04);
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(mitigate_readout(counts, p01, p10));
+    }
+    state.SetItemsProcessed(state.iterations() * counts.size());
+}
+BENCHMARK(BM_MitigateReadout)->Arg(8)->Arg(16)->Unit(benchmark::kMillisecond);
+
+static void BM_CountsToJson(benchmark::State& state) {
+    CountTable counts = synthetic_shots(16, 100000, 5).counts();
+    string out;
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        out.clear();
+        counts.write_json(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * counts.size());
+}
+BENCHMARK(BM_CountsToJson);
+
+static void BM_ErrorMitigatorCancellationMap(benchmark::State& state) {
+    map<string, double> counts = synthetic_shots(16, 100000, 6).counts().to_map();
+    ErrorMitigator mitigator(16, MitigationLevel::MEDIUM);
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(mitigator.probabilisticErrorCancellation(counts, 100000));
+    }
+    state.SetItemsProcessed(state.iterations() * counts.size());
+}
+BENCHMARK(BM_ErrorMitigatorCancellationMap);
+
+static void BM_ErrorMitigatorCancellationTable(benchmark::State& state) {
+    CountTable counts = synthetic_shots(16, 100000, 6).counts();
+    ErrorMitigator mitigator(16, MitigationLevel::MEDIUM);
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(mitigator.probabilisticErrorCancellation(counts, 100000));
+    }
+    state.SetItemsProcessed(state.iterations() * counts.size());
+}
+BENCHMARK(BM_ErrorMitigatorCancellationTable);
+
+static void BM_ErrorMitigatorReadout(benchmark::State& state) {
+    CountTable counts = synthetic_shots(12, 100000, 7).counts();
+    ErrorMitigator mitigator(12, MitigationLevel::LOW, 0.01);
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(mitigator.mitigateReadout(counts));
+    }
+    state.SetItemsProcessed(state.iterations() * counts.size());
+}
+BENCHMARK(BM_ErrorMitigatorReadout)->Unit(benchmark::kMillisecond);
+
+static void BM_ErrorMitigatorReadoutArena(benchmark::State& state) {
+    CountTable source = synthetic_shots(12, 100000, 7).counts();
+    ErrorMitigator mitigator(12, MitigationLevel::LOW, 0.01);
+    RequestArena arena;
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        {
+            CountTable counts(source, arena.resource());
+            benchmark::DoNotOptimize(mitigator.mitigateReadout(counts));
+        }
+        arena.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * source.size());
+}
+BENCHMARK(BM_ErrorMitigatorReadoutArena)->Unit(benchmark::kMillisecond);
+
+static void BM_ZeroNoiseExtrapolation(benchmark::State& state) {
+    ErrorMitigator mitigator(8, MitigationLevel::HIGH);
+    vector<double> results(state.range(0)), factors(state.range(0));
+    for(size_t i = 0; i < results.size(); i++) {
+        factors[i] = 1.0 + i;
+        results[i] = 0.9 / factors[i];
+    }
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(mitigator.zeroNoiseExtrapolation(results, factors));
+    }
+    state.SetItemsProcessed(state.iterations() * results.size() * results.size());
+}
+BENCHMARK(BM_ZeroNoiseExtrapolation)->Arg(3)->Arg(8)->Arg(64);
+
+// Monte-Carlo benchmark of every level on the shipped algorithms with
+// range(0) threads (0 = all cores), 1000 shots per run
+static void BM_MitigationBenchmark(benchmark::State& state) {
+    vector<BenchmarkCircuit> circuits = load_algorithm_circuits(PLANCK_ALGORITHMS_DIR);
+    QuantumHardwareDatabase db;
+    MitigationBenchmarkOptions options;
+    options.shots = options.calibration_shots = 1000;
+    options.threads = state.range(0);
+    MitigationBenchmark benchmark(NoiseModel::from_hardware(db.get_hardware("ibm_falcon")), options);
+    vector<MitigationMeasurement> rows;
+    for(auto _ : state) {
+        rows = benchmark.run(circuits);
+    }
+    for(const MitigationMeasurement& row : rows) state.counters[string("gain_") + mitigation_level_name(row.level)] = row.fidelity_gain;
+}
+BENCHMARK(BM_MitigationBenchmark)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,168 @@
+/*
+ * ML benchmarks - Feature vectorization and recommendation over large histories
+ */
+
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include "alloc_counter.h"
+#include "ml_feature_vectorizer.h"
+#include "ml_reinforcement_engine.h"
+#include "ml_policy_replay.h"
+
+using namespace std;
+
+static const vector<string> BACKENDS = {"classical", "hpc", "quantum"};
+
+static CircuitFeatures sample_features() {
+    CircuitFeatures features;
+    reset_features(features);
+    features.qubits = 12;
+    features.depth = 140;
+    features.gates = 900;
+    features.algorithm = "vqe";
+    features.data_size = 4096;
+    features.complexity_score = 0.6;
+    features.target_latency = 500;
+    features.backend_preference = "quantum";
+    return features;
+}
+
+static vector<double> random_vector(mt19937& gen) {
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    vector<double> vec(FEATURE_DIM);
+    for(double& v : vec) v = unit(gen);
+    return vec;
+}
+
+static void BM_Vectorize(benchmark::State& state) {
+    FeatureVectorizer vectorizer;
+    CircuitFeatures features = sample_features();
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(vectorizer.vectorize(features));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Vectorize);
+
+static void BM_VectorizeInto(benchmark::State& state) {
+    FeatureVectorizer vectorizer;
+    CircuitFeatures features = sample_features();
+    double vec[FEATURE_DIM];
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        vectorizer.vectorize_into(features, vec);
+        benchmark::DoNotOptimize(vec);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_VectorizeInto);
+
+static void BM_VectorizeNdjson(benchmark::State& state) {
+    string input;
+    for(int i = 0; i < 10000; i++) {
+        input += "{\"qubits\":" + to_string(2 + i % 60) + ",\"depth\":" + to_string(10 + i % 500) +
+                 ",\"gates\":" + to_string(50 + i % 5000) + ",\"algorithm\":\"qaoa\",\"dataSize\":1024"
+                 ",\"complexityScore\":0.4,\"targetLatency\":250,\"backendPreference\":\"hpc\"}\n";
+    }
+    FeatureVectorizer vectorizer;
+    vector<double> matrix;
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        matrix.clear();
+        benchmark::DoNotOptimize(vectorize_ndjson(vectorizer, input, matrix));
+    }
+    state.SetItemsProcessed(state.iterations() * 10000);
+    state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(BM_VectorizeNdjson);
+
+// Bandit recommendation after observing N executions; cost should not grow with N
+static void BM_RecommendBandit(benchmark::State& state) {
+    mt19937 gen(21);
+    ReinforcementEngine engine;
+    for(long i = 0; i < state.range(0); i++) {
+        vector<double> x = random_vector(gen);
+        engine.observe(x.data(), x.size(), 100 << (gen() % 7), BACKENDS[gen() % 3], 50.0 + gen() % 50);
+    }
+    vector<double> query = random_vector(gen);
+
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(engine.recommend(query, 1000, "quantum"));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["history_rows"] = state.range(0);
+}
+BENCHMARK(BM_RecommendBandit)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ObserveBandit(benchmark::State& state) {
+    mt19937 gen(22);
+    vector<vector<double>> rows(1024);
+    for(auto& row : rows) row = random_vector(gen);
+    ReinforcementEngine engine;
+    size_t i = 0;
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        const vector<double>& x = rows[i & 1023];
+        engine.observe(x.data(), x.size(), 1000, BACKENDS[i % 3], 75.0);
+        i++;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ObserveBandit);
+
+// Similarity voting scans the whole history on every call. Rows are kept in
+// memory (about 200 bytes each), so the range stops at 10^6.
+static void BM_RecommendSimilarity(benchmark::State& state) {
+    mt19937 gen(23);
+    vector<HistoricalExecution> history(state.range(0));
+    for(auto& exec : history) {
+        exec.features = random_vector(gen);
+        exec.shots_used = 100 << (gen() % 7);
+        exec.backend_used = BACKENDS[gen() % 3];
+        exec.fidelity_achieved = 0.9;
+        exec.runtime_ms = 100;
+        exec.reward_score = 50.0 + gen() % 50;
+    }
+    vector<double> query = random_vector(gen);
+    ReinforcementEngine engine;
+
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(engine.recommend(query, history, 1000, "quantum"));
+    }
+    state.SetItemsProcessed(state.iterations() * history.size());
+}
+BENCHMARK(BM_RecommendSimilarity)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+// Off-policy replay of range(0) logged executions through LinUCB (trained on
+// the first 10^4) and a fixed configuration, on all cores
+static void BM_PolicyReplay(benchmark::State& state) {
+    mt19937 gen(24);
+    string path = "/tmp/planck_bench_replay_" + to_string(state.range(0)) + ".log";
+    unlink(path.c_str());
+    ReinforcementEngine engine;
+    {
+        HistoryLogWriter writer(path, FEATURE_DIM);
+        for(long i = 0; i < state.range(0); i++) {
+            vector<double> x = random_vector(gen);
+            int shots = 100 << (gen() % 7);
+            const string& backend = BACKENDS[gen() % 3];
+            double reward = 50.0 + gen() % 50;
+            writer.append(x.data(), x.size(), shots, backend, 0.9, 100.0, reward);
+            if(i < 10000) engine.observe(x.data(), x.size(), shots, backend, reward);
+        }
+    }
+    HistoryLogReader log(path);
+    PolicyReplay replay(log);
+    vector<ReplayPolicy> policies = {linucb_policy(engine, 1000, "quantum"), fixed_policy(1000, "quantum")};
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(replay.evaluate(policies));
+    }
+    state.SetItemsProcessed(state.iterations() * replay.record_count() * policies.size());
+    unlink(path.c_str());
+}
+BENCHMARK(BM_PolicyReplay)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,319 @@
+/*
+ * Transpiler benchmarks - Routing on the shipped algorithms and random circuits
+ */
+
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <benchmark/benchmark.h>
+
+#include "alloc_counter.h"
+#include "quantum_transpiler.h"
+#include "parameter_binding_cache.h"
+#include "transpile_cache.h"
+#include "approximate_synthesis.h"
+#include "circuit_cutting.h"
+#include "circuit_dag.h"
+#include "core/arena.h"
+#include "qasm_reader.h"
+
+using namespace std;
+
+static QPUTopology make_topology(int index) {
+    switch(index) {
+        case 0: return QPUTopology(QPUType::IBM_FALCON, 27);
+        case 1: return QPUTopology(QPUType::RIGETTI_ASPEN, 40);
+        default: return QPUTopology(QPUType::IONQ_ARIA, 25);
+    }
+}
+
+static vector<Gate> load_algorithm(const string& name, int& num_qubits) {
+    ifstream file(string(PLANCK_ALGORITHMS_DIR) + "/" + name + ".qasm");
+    stringstream source;
+    source << file.rdbuf();
+
+    vector<Gate> gates;
+    QasmReader reader;
+    reader.parse(source.str(), [&](const QasmOp& op) {
+        if(op.name == "barrier") return;
+        Gate gate(op.name, op.qubits);
+        for(size_t i = 0; i < op.params.size(); i++) gate.parameters.emplace("p" + to_string(i), op.params[i]);
+        gates.push_back(gate);
+    });
+    num_qubits = reader.get_num_qubits();
+    return gates;
+}
+
+// 60% single-qubit rotations, 40% CNOTs between random pairs
+static vector<Gate> random_circuit(size_t num_gates, int num_qubits, unsigned seed) {
+    mt19937 gen(seed);
+    uniform_int_distribution<int> qubit(0, num_qubits - 1);
+    uniform_real_distribution<double> angle(0.0, 2 * M_PI);
+    vector<Gate> gates;
+    gates.reserve(num_gates);
+    for(size_t i = 0; i < num_gates; i++) {
+        if(gen() % 10 < 6) {
+            gates.push_back({"rz", {qubit(gen)}, {{"theta", angle(gen)}}});
+        } else {
+            int a = qubit(gen), b = qubit(gen);
+            while(b == a) b = qubit(gen);
+            gates.push_back({"cx", {a, b}, {}});
+        }
+    }
+    return gates;
+}
+
+static void BM_ShortestPath(benchmark::State& state) {
+    QPUTopology topology = make_topology(state.range(0));
+    int n = topology.get_num_qubits();
+    mt19937 gen(7);
+    vector<pair<int, int>> pairs(1024);
+    for(auto& p : pairs) p = {int(gen() % n), int(gen() % n)};
+
+    size_t i = 0;
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        auto& p = pairs[i++ & 1023];
+        benchmark::DoNotOptimize(topology.shortest_path(p.first, p.second));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(topology.get_topology_name());
+}
+BENCHMARK(BM_ShortestPath)->DenseRange(0, 2);
+
+static void BM_TranspileAlgorithm(benchmark::State& state, const string& name) {
+    int num_qubits = 0;
+    vector<Gate> gates = load_algorithm(name, num_qubits);
+    QPUTopology topology(QPUType::IBM_FALCON, 27);
+    QuantumTranspiler transpiler(&topology);
+
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(transpiler.transpile(gates, num_qubits));
+    }
+    state.SetItemsProcessed(state.iterations() * gates.size());
+}
+BENCHMARK_CAPTURE(BM_TranspileAlgorithm, bell_state, string("bell_state"));
+BENCHMARK_CAPTURE(BM_TranspileAlgorithm, grover_search, string("grover_search"));
+BENCHMARK_CAPTURE(BM_TranspileAlgorithm, qaoa_maxcut, string("qaoa_maxcut"));
+BENCHMARK_CAPTURE(BM_TranspileAlgorithm, shor_period_finding, string("shor_period_finding"));
+BENCHMARK_CAPTURE(BM_TranspileAlgorithm, vqe_ansatz, string("vqe_ansatz"));
+
+static void BM_TranspileRandom(benchmark::State& state) {
+    vector<Gate> gates = random_circuit(state.range(0), 20, 11);
+    QPUTopology topology(QPUType::IBM_FALCON, 27);
+    QuantumTranspiler transpiler(&topology);
+
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(transpiler.transpile(gates, 20));
+    }
+    state.SetItemsProcessed(state.iterations() * gates.size());
+}
+BENCHMARK(BM_TranspileRandom)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+// One job per iteration as a service would run it: fresh transpiler on a
+// reused arena, released in one step afterwards
+static void BM_TranspileArena(benchmark::State& state) {
+    vector<Gate> gates = random_circuit(state.range(0), 20, 11);
+    QPUTopology topology(QPUType::IBM_FALCON, 27);
+    RequestArena arena;
+
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        {
+            QuantumTranspiler transpiler(&topology, arena.resource());
+            benchmark::DoNotOptimize(transpiler.transpile(gates, 20).data());
+        }
+        arena.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * gates.size());
+    state.counters["arena_bytes"] = arena.capacity();
+}
+BENCHMARK(BM_TranspileArena)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond);
+
+static void BM_ParameterRebind(benchmark::State& state) {
+    vector<Gate> gates = random_circuit(state.range(0), 20, 13);
+    QPUTopology topology(QPUType::IBM_FALCON, 27);
+    QuantumTranspiler transpiler(&topology);
+    ParameterBindingCache cache;
+    cache.transpile(transpiler, topology, gates, 20);
+
+    size_t rotation = 0;
+    while(gates[rotation].parameters.empty()) rotation++;
+    double theta = 0.0;
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        gates[rotation].parameters["theta"] = theta += 0.01;
+        benchmark::DoNotOptimize(cache.transpile(transpiler, topology, gates, 20));
+    }
+    state.SetItemsProcessed(state.iterations() * gates.size());
+}
+BENCHMARK(BM_ParameterRebind)->RangeMultiplier(10)->Range(100, 100000);
+
+// Resubmitting the same circuit: route every time (arg 0), hit the
+// in-process LRU (arg 1), or hit only the shared disk tier, as a fresh
+// process would (arg 2)
+static void BM_TranspileCache(benchmark::State& state) {
+    vector<Gate> gates = random_circuit(state.range(0), 20, 23);
+    QPUTopology topology(QPUType::IBM_FALCON, 27);
+    QuantumTranspiler transpiler(&topology);
+    string path = "/tmp/planck_bench_transpile_cache";
+    unlink(path.c_str());
+    TranspileCache cache(1024, state.range(1) == 2 ? path : "");
+    cache.transpile(transpiler, topology, gates, 20);
+
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        if(state.range(1) == 0) {
+            benchmark::DoNotOptimize(transpiler.transpile(gates, 20).data());
+        } else {
+            if(state.range(1) == 2) cache.clear();
+            benchmark::DoNotOptimize(cache.transpile(transpiler, topology, gates, 20).data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * gates.size());
+    unlink(path.c_str());
+}
+BENCHMARK(BM_TranspileCache)->ArgsProduct({{1000, 100000}, {0, 1, 2}})->Unit(benchmark::kMillisecond);
+
+// Calibration drops one coupler: patch the routing (arg 1) or route again
+// from scratch on the new map (arg 0)
+static void BM_Reroute(benchmark::State& state) {
+    vector<Gate> gates = random_circuit(state.range(0), 20, 17);
+    bool incremental = state.range(1);
+    QPUTopology original(QPUType::IBM_FALCON, 27);
+    original.build_distance_table();
+    QuantumTranspiler routed(&original);
+    pmr::vector<Gate> previous = routed.transpile(gates, 20);
+    pmr::vector<int> source = routed.get_source_gates();
+
+    QPUTopology topology = original;
+    CouplingMapDiff diff;
+    diff.removed_edges.push_back({6, 9});
+    topology.apply_diff(diff);
+    QuantumTranspiler transpiler(&topology);
+
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        if(incremental) {
+            transpiler.set_routing(previous, source);
+            benchmark::DoNotOptimize(transpiler.reroute(gates, 20).data());
+        } else {
+            benchmark::DoNotOptimize(transpiler.transpile(gates, 20).data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * gates.size());
+    if(incremental) state.counters["rerouted_windows"] = transpiler.get_rerouted_windows();
+}
+BENCHMARK(BM_Reroute)->ArgsProduct({{1000, 100000}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+// Coupler toggled off and on: incremental table update (arg 1) against a
+// full rebuild with one BFS per qubit (arg 0)
+static void BM_DistanceTableUpdate(benchmark::State& state) {
+    QPUTopology topology = make_topology(state.range(0));
+    topology.build_distance_table();
+    bool incremental = state.range(1);
+    pair<int, int> edge = qpu_coupling_map(QPUType(state.range(0))).front();
+
+    AllocationScope allocations(state);
+    for(auto _ : state) {
+        if(incremental) {
+            topology.remove_edge(edge.first, edge.second);
+            topology.add_edge(edge.first, edge.second);
+        } else {
+            topology.build_distance_table();
+            topology.build_distance_table();
+        }
+        benchmark::DoNotOptimize(topology.distance(edge.first, edge.second));
+    }
+    state.SetLabel(topology.get_topology_name());
+}
+BENCHMARK(BM_DistanceTableUpdate)->ArgsProduct({{0, 1, 2}, {0, 1}});
+
+// Routed random circuit on Falcon, resynthesised with a budget of range(1)
+// two-qubit gate errors
+static void BM_ApproximateSynthesis(benchmark::State& state) {
+    vector<Gate> gates = random_circuit(state.range(0), 20, 19);
+    QPUTopology topology(QPUType::IBM_FALCON, 27);
+    QuantumTranspiler transpiler(&topology);
+    const pmr::vector<Gate>& routed = transpiler.transpile(gates, 20);
+
+    QuantumHardwareDatabase db;
+    ApproximationOptions options = ApproximationOptions::from_hardware(db.get_hardware("ibm_falcon"), state.range(1));
+    ApproximationReport report;
+    for(auto _ : state) {
+        ApproximateSynthesizer synthesizer(options);
+        benchmark::DoNotOptimize(synthesizer.compile(routed, &report).data());
+    }
+    state.SetItemsProcessed(state.iterations() * routed.size());
+    state.counters["cx_before"] = report.two_qubit_before;
+    state.counters["cx_after"] = report.two_qubit_after;
+    state.counters["error_spent"] = report.approximation_error;
+}
+BENCHMARK(BM_ApproximateSynthesis)->ArgsProduct({{1000, 10000}, {0, 10}})->Unit(benchmark::kMillisecond);
+
+// Two linear chains of range(0)/2 qubits joined by two CX, as a layered
+// ansatz; range(1) 0 simulates it whole, 1 cuts it into halves and
+// reconstructs <Z0 Zn/2>
+static vector<Gate> coupled_chains(int n) {
+    int half = n / 2;
+    vector<Gate> gates;
+    for(int q = 0; q < n; q++) gates.push_back(Gate("h", {q}));
+    for(int layer = 0; layer < 4; layer++) {
+        for(int q = 0; q < n; q++) {
+            int base = q < half ? 0 : half;
+            int next = base + (q - base + 1) % half;
+            gates.push_back(Gate("cx", {q, next}));
+            gates.push_back(Gate("rz", {next}, {{"theta", 0.1 * q + layer}}));
+        }
+    }
+    gates.push_back(Gate("cx", {0, half}));
+    gates.push_back(Gate("cx", {half - 1, n - 1}));
+    return gates;
+}
+
+static void BM_CircuitCutting(benchmark::State& state) {
+    int n = state.range(0);
+    vector<Gate> gates = coupled_chains(n);
+    CutOptions options;
+    options.max_fragment_qubits = n / 2;
+    for(auto _ : state) {
+        if(state.range(1) == 0) {
+            StatevectorSimulator sim(n);
+            sim.run(gates);
+            benchmark::DoNotOptimize(sim.get_amplitudes().data());
+        } else {
+            CircuitCutter cutter(gates, n, options);
+            cutter.execute();
+            benchmark::DoNotOptimize(cutter.expectation({0, n / 2}));
+            state.counters["cuts"] = cutter.get_num_cuts();
+        }
+    }
+}
+BENCHMARK(BM_CircuitCutting)->ArgsProduct({{16, 20}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+// DAG passes (optimise, translate, schedule) on a routed random circuit with
+// range(1) threads
+static void BM_DagPasses(benchmark::State& state) {
+    vector<Gate> gates = random_circuit(state.range(0), 20, 23);
+    QPUTopology topology(QPUType::IBM_FALCON, 27);
+    QuantumTranspiler transpiler(&topology);
+    const pmr::vector<Gate>& routed = transpiler.transpile(gates, 20);
+
+    QuantumHardwareDatabase db;
+    DagScheduleOptions timing = DagScheduleOptions::from_hardware(db.get_hardware("ibm_falcon"));
+    TaskScheduler tasks(state.range(1));
+    DagPassManager passes(tasks);
+    DagPassReport report;
+    for(auto _ : state) {
+        report = DagPassReport();
+        benchmark::DoNotOptimize(passes.compile(routed, 27, timing, &report).data());
+    }
+    state.SetItemsProcessed(state.iterations() * routed.size());
+    state.counters["gates_after"] = report.gates_after;
+    state.counters["merged"] = report.rotations_merged;
+    state.counters["cancelled"] = report.pairs_cancelled;
+    state.counters["depth"] = report.depth;
+}
+BENCHMARK(BM_DagPasses)->ArgsProduct({{10000, 100000}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,556 @@
+/*
+ * Circuit Cutting - Run circuits wider than the device as smaller fragments
+ * The qubit interaction graph (edge weight: two-qubit gates between a pair)
+ * is split by recursive min-cut bisection with Fiduccia-Mattheyses
+ * refinement until every fragment fits max_fragment_qubits. Each CX/CZ left
+ * crossing two fragments is cut with the quasi-probability decomposition of
+ * CZ (Mitarai-Fujii) into six products of local operations:
+ *
+ *     CZ rho CZ = 1/2 [ (I,I) + (Z,Z) + (M,Sdg) - (M,S) + (Sdg,M) - (S,M) ]
+ *
+ * each side followed by S, where M is a Z measurement whose outcome (+1/-1)
+ * signs the rest of the shot. A fragment with k cut endpoints has 5^k
+ * variants (five distinct local operations per endpoint). Variants run in
+ * parallel on the local statevector simulator or through a caller-supplied
+ * runner (e.g. one device per fragment), and the full result is recombined
+ * as P = sum_t c_t (x)_f P_f[v_f(t)] over all 6^K term assignments of the
+ * K cuts. Exact for exact fragment results; with shots the variance grows
+ * as 9^K, so max_cuts keeps K small.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <cstdint>
+#include <cmath>
+
+#include "quantum_transpiler.h"
+#include "statevector.h"
+
+using namespace std;
+
+struct CutOptions {
+    int max_fragment_qubits = 20;      // Device (or simulator) width
+    int max_cuts = 8;                  // Reconstruction enumerates 6^max_cuts terms
+    unsigned threads = 0;              // Parallel variant runs; 0 = hardware concurrency
+    int max_distribution_qubits = 24;  // Widest circuit distribution() will expand
+};
+
+struct CutFragment {
+    vector<int> qubits;             // Original circuit qubit of each local qubit
+    vector<Gate> gates;             // Local indices; "cut" placeholders at cut points
+    vector<int> slots;              // Per gate: index into cuts, -1 for ordinary gates
+    vector<int> cuts;               // Cut ids in variant digit order
+    vector<int> sides;              // Side taken on each cut: 0 first qubit, 1 second
+    vector<vector<double>> results; // Quasi-probabilities per variant after execute()
+
+    size_t variant_count() const {
+        size_t count = 1;
+        for(size_t i = 0; i < cuts.size(); i++) count *= CUT_LOCAL_OPS;
+        return count;
+    }
+
+    static constexpr int CUT_LOCAL_OPS = 5;  // I, Z, M, Sdg, S
+};
+
+// Runs one variant circuit (local qubits 0..num_qubits-1, "cut_measure"
+// marking a signed Z measurement) and returns its quasi-probability vector
+// of size 2^num_qubits
+using FragmentRunner = function<vector<double>(int fragment, const vector<Gate>& circuit, int num_qubits)>;
+
+// Simulates every outcome branch of the signed measurements exactly
+inline void simulate_signed(const vector<Gate>& circuit, size_t start, StatevectorSimulator& sim, double sign,
+                            vector<double>& out) {
+    for(size_t i = start; i < circuit.size(); i++) {
+        if(circuit[i].type != "cut_measure") {
+            sim.apply(circuit[i]);
+            continue;
+        }
+        StatevectorSimulator one = sim;
+        one.project(circuit[i].qubits[0], 1);
+        simulate_signed(circuit, i + 1, one, -sign, out);
+        sim.project(circuit[i].qubits[0], 0);
+    }
+    const vector<Complex>& amplitudes = sim.get_amplitudes();
+    for(size_t x = 0; x < amplitudes.size(); x++) out[x] += sign * norm(amplitudes[x]);
+}
+
+inline vector<double> simulate_fragment(const vector<Gate>& circuit, int num_qubits) {
+    StatevectorSimulator sim(num_qubits);
+    vector<double> out(size_t(1) << num_qubits, 0.0);
+    simulate_signed(circuit, 0, sim, 1.0, out);
+    return out;
+}
+
+class CircuitCutter {
+private:
+    struct Cut {
+        int fragment[2];  // Fragment holding each side
+        int digit[2];     // Position of the cut in that fragment's cuts
+    };
+
+    // Local operation index per term and side, and the term coefficients
+    static constexpr int TERM_OPS[6][2] = {{0, 0}, {1, 1}, {2, 3}, {2, 4}, {3, 2}, {4, 2}};
+    static constexpr double TERM_COEFFICIENTS[6] = {0.5, 0.5, 0.5, -0.5, 0.5, -0.5};
+    static constexpr int UNCUTTABLE = 1 << 20;
+
+    CutOptions options;
+    int num_qubits = 0;
+    vector<CutFragment> fragments;
+    vector<Cut> cuts;
+    vector<int> fragment_of;  // Per original qubit
+    vector<int> local_of;
+    bool executed = false;
+
+    static bool cuttable(const Gate& gate) {
+        return gate.type == "cx" || gate.type == "cz" || gate.type == "swap";
+    }
+
+    // Dense symmetric weights; gates that cannot be cut pin their qubits
+    // together
+    static vector<int> interaction_graph(const vector<Gate>& gates, int n) {
+        vector<int> weights((size_t)n * n, 0);
+        for(const Gate& gate : gates) {
+            if(gate.qubits.size() < 2 || gate.type == "measure" || gate.type == "barrier") continue;
+            int w = !cuttable(gate) ? UNCUTTABLE : gate.type == "swap" ? 3 : 1;
+            for(size_t i = 0; i < gate.qubits.size(); i++) {
+                for(size_t j = i + 1; j < gate.qubits.size(); j++) {
+                    int a = gate.qubits[i], b = gate.qubits[j];
+                    if(a == b) continue;
+                    weights[(size_t)a * n + b] += w;
+                    weights[(size_t)b * n + a] += w;
+                }
+            }
+        }
+        return weights;
+    }
+
+    // Min-cut bisection of vertices with |A| <= cap_a, |B| <= cap_b:
+    // greedy growth of A from its best-connected vertex, then FM passes
+    // moving the best-gain vertex and keeping the best prefix of each pass
+    static void bisect(const vector<int>& vertices, const vector<int>& weights, int n, int cap_a, int cap_b,
+                       vector<int>& a, vector<int>& b) {
+        int m = vertices.size();
+        vector<long long> w((size_t)m * m);
+        for(int i = 0; i < m; i++)
+            for(int j = 0; j < m; j++) w[(size_t)i * m + j] = weights[(size_t)vertices[i] * n + vertices[j]];
+
+        int target = min(cap_a, max(m - cap_b, (m + 1) / 2));
+        vector<char> side(m, 1);
+        vector<long long> to_a(m, 0);
+        int seed = 0;
+        long long best_degree = -1;
+        for(int i = 0; i < m; i++) {
+            long long degree = 0;
+            for(int j = 0; j < m; j++) degree += w[(size_t)i * m + j];
+            if(degree > best_degree) best_degree = degree, seed = i;
+        }
+        for(int size_a = 0, next = seed; size_a < target; size_a++) {
+            side[next] = 0;
+            for(int j = 0; j < m; j++) to_a[j] += w[(size_t)next * m + j];
+            next = -1;
+            for(int j = 0; j < m; j++) {
+                if(side[j] == 1 && (next < 0 || to_a[j] > to_a[next])) next = j;
+            }
+        }
+
+        int size_a = target;
+        for(int pass = 0; pass < 16; pass++) {
+            vector<long long> gain(m, 0);
+            for(int i = 0; i < m; i++) {
+                for(int j = 0; j < m; j++) gain[i] += side[i] != side[j] ? w[(size_t)i * m + j] : -w[(size_t)i * m + j];
+            }
+            vector<char> locked(m, 0);
+            vector<int> moves;
+            long long cumulative = 0, best = 0;
+            size_t best_moves = 0;
+            for(int step = 0; step < m; step++) {
+                int pick = -1;
+                for(int i = 0; i < m; i++) {
+                    if(locked[i]) continue;
+                    int new_a = size_a + (side[i] == 0 ? -1 : 1);
+                    if(new_a < 1 || new_a > cap_a || m - new_a < 1 || m - new_a > cap_b) continue;
+                    if(pick < 0 || gain[i] > gain[pick]) pick = i;
+                }
+                if(pick < 0) break;
+                size_a += side[pick] == 0 ? -1 : 1;
+                side[pick] ^= 1;
+                locked[pick] = 1;
+                cumulative += gain[pick];
+                moves.push_back(pick);
+                for(int j = 0; j < m; j++) {
+                    long long wj = w[(size_t)pick * m + j];
+                    gain[j] += side[j] == side[pick] ? -2 * wj : 2 * wj;
+                }
+                if(cumulative > best) best = cumulative, best_moves = moves.size();
+            }
+            for(size_t i = moves.size(); i > best_moves; i--) {
+                int v = moves[i - 1];
+                size_a += side[v] == 0 ? -1 : 1;
+                side[v] ^= 1;
+            }
+            if(best <= 0) break;
+        }
+
+        for(int i = 0; i < m; i++) (side[i] == 0 ? a : b).push_back(vertices[i]);
+    }
+
+    void partition(const vector<int>& vertices, const vector<int>& weights, vector<vector<int>>& parts) const {
+        int cap = options.max_fragment_qubits;
+        int count = ((int)vertices.size() + cap - 1) / cap;
+        if(count <= 1) {
+            parts.push_back(vertices);
+            return;
+        }
+        int count_a = (count + 1) / 2;
+        vector<int> a, b;
+        bisect(vertices, weights, num_qubits, count_a * cap, (count - count_a) * cap, a, b);
+        partition(a, weights, parts);
+        partition(b, weights, parts);
+    }
+
+    void add_local(int q, Gate gate) {
+        CutFragment& fragment = fragments[fragment_of[q]];
+        for(int& target : gate.qubits) target = local_of[target];
+        fragment.gates.push_back(move(gate));
+        fragment.slots.push_back(-1);
+    }
+
+    void add_cut(int first, int second) {
+        Cut cut;
+        int qubits[2] = {first, second};
+        for(int side = 0; side < 2; side++) {
+            CutFragment& fragment = fragments[fragment_of[qubits[side]]];
+            cut.fragment[side] = fragment_of[qubits[side]];
+            cut.digit[side] = fragment.cuts.size();
+            fragment.slots.push_back(fragment.cuts.size());
+            fragment.gates.push_back(Gate("cut", {local_of[qubits[side]]}));
+            fragment.cuts.push_back(cuts.size());
+            fragment.sides.push_back(side);
+        }
+        cuts.push_back(cut);
+    }
+
+    void add_cut_cx(int control, int target) {
+        add_local(target, Gate("h", {target}));
+        add_cut(control, target);
+        add_local(target, Gate("h", {target}));
+    }
+
+    // Local simulation of all variants of a fragment. Variants differ only
+    // at cut slots, so a depth-first walk over the cut digits simulates each
+    // segment once per prefix of choices rather than once per variant;
+    // only_op restricts the first digit so walks can run in parallel.
+    static void walk(CutFragment& fragment, size_t i, size_t variant, size_t place, int only_op,
+                     StatevectorSimulator& sim, double sign) {
+        for(; i < fragment.gates.size() && fragment.slots[i] < 0; i++) sim.apply(fragment.gates[i]);
+        if(i == fragment.gates.size()) {
+            vector<double>& out = fragment.results[variant];
+            const vector<Complex>& amplitudes = sim.get_amplitudes();
+            for(size_t x = 0; x < amplitudes.size(); x++) out[x] += sign * norm(amplitudes[x]);
+            return;
+        }
+        const Matrix2 s = {1.0, 0.0, 0.0, Complex(0, 1)}, sdg = {1.0, 0.0, 0.0, Complex(0, -1)};
+        const Matrix2 z = {1.0, 0.0, 0.0, -1.0};
+        int q = fragment.gates[i].qubits[0];
+        for(int op = 0; op < CutFragment::CUT_LOCAL_OPS; op++) {
+            if(only_op >= 0 && op != only_op) continue;
+            size_t next = variant + op * place, next_place = place * CutFragment::CUT_LOCAL_OPS;
+            StatevectorSimulator branch = sim;
+            if(op == 2) {
+                StatevectorSimulator one = sim;
+                one.project(q, 1);
+                one.apply(s, q);
+                walk(fragment, i + 1, next, next_place, -1, one, -sign);
+                branch.project(q, 0);
+            }
+            if(op == 0 || op == 2) branch.apply(s, q);
+            else if(op == 1) branch.apply(sdg, q);
+            else if(op == 4) branch.apply(z, q);
+            walk(fragment, i + 1, next, next_place, -1, branch, sign);
+        }
+    }
+
+    // Calls visit(coefficient, variants) for every term assignment, updating
+    // the per-fragment variant indices incrementally like an odometer
+    template<typename Visit>
+    void for_each_term(Visit visit) const {
+        size_t K = cuts.size();
+        vector<int> term(K, 0);
+        vector<size_t> variants(fragments.size(), 0);
+        vector<vector<size_t>> place(fragments.size());
+        for(size_t f = 0; f < fragments.size(); f++) {
+            size_t value = 1;
+            for(size_t d = 0; d < fragments[f].cuts.size(); d++, value *= CutFragment::CUT_LOCAL_OPS) place[f].push_back(value);
+        }
+        auto set_term = [&](size_t c, int t) {
+            for(int side = 0; side < 2; side++) {
+                const Cut& cut = cuts[c];
+                long long delta = (long long)TERM_OPS[t][side] - TERM_OPS[term[c]][side];
+                variants[cut.fragment[side]] += delta * (long long)place[cut.fragment[side]][cut.digit[side]];
+            }
+            term[c] = t;
+        };
+        double magnitude = pow(0.5, K);
+        int negatives = 0;
+        while(true) {
+            visit(negatives % 2 ? -magnitude : magnitude, variants);
+            size_t c = 0;
+            for(; c < K; c++) {
+                if(TERM_COEFFICIENTS[term[c]] < 0) negatives--;
+                if(term[c] < 5) {
+                    set_term(c, term[c] + 1);
+                    if(TERM_COEFFICIENTS[term[c]] < 0) negatives++;
+                    break;
+                }
+                set_term(c, 0);
+            }
+            if(c == K) break;
+        }
+    }
+
+public:
+    // Partitions the circuit and builds the fragments; throws if it needs
+    // more than max_cuts cuts or a gate that cannot be cut spans fragments
+    CircuitCutter(const vector<Gate>& gates, int qubits, CutOptions opts = CutOptions())
+        : options(opts), num_qubits(qubits) {
+        if(options.max_fragment_qubits < 1) throw runtime_error("max_fragment_qubits must be positive");
+        for(const Gate& gate : gates) {
+            for(int q : gate.qubits) {
+                if(q < 0 || q >= num_qubits) throw runtime_error("Gate on qubit " + to_string(q) + " outside the circuit");
+            }
+        }
+
+        vector<int> all(num_qubits);
+        for(int q = 0; q < num_qubits; q++) all[q] = q;
+        vector<vector<int>> parts;
+        partition(all, interaction_graph(gates, num_qubits), parts);
+
+        fragment_of.assign(num_qubits, -1);
+        local_of.assign(num_qubits, -1);
+        fragments.resize(parts.size());
+        for(size_t f = 0; f < parts.size(); f++) {
+            sort(parts[f].begin(), parts[f].end());
+            fragments[f].qubits = parts[f];
+            for(size_t i = 0; i < parts[f].size(); i++) {
+                fragment_of[parts[f][i]] = f;
+                local_of[parts[f][i]] = i;
+            }
+        }
+
+        for(const Gate& gate : gates) {
+            if(gate.qubits.empty() || gate.type == "measure" || gate.type == "barrier") continue;
+            bool local = true;
+            for(int q : gate.qubits) local = local && fragment_of[q] == fragment_of[gate.qubits[0]];
+            if(local) {
+                add_local(gate.qubits[0], gate);
+                continue;
+            }
+            int a = gate.qubits[0], b = gate.qubits[1];
+            if(gate.type == "cz") add_cut(a, b);
+            else if(gate.type == "cx") add_cut_cx(a, b);
+            else if(gate.type == "swap") {
+                add_cut_cx(a, b);
+                add_cut_cx(b, a);
+                add_cut_cx(a, b);
+            } else throw runtime_error("Gate " + string(gate.type) + " spans fragments and cannot be cut");
+        }
+        if((int)cuts.size() > options.max_cuts) {
+            throw runtime_error("Circuit needs " + to_string(cuts.size()) + " cuts, limit is " + to_string(options.max_cuts));
+        }
+    }
+
+    // Circuit of one fragment variant: each cut placeholder becomes its
+    // local operation followed by the S of the CZ decomposition
+    vector<Gate> variant_circuit(int f, size_t variant) const {
+        const CutFragment& fragment = fragments[f];
+        vector<int> ops(fragment.cuts.size());
+        for(size_t d = 0; d < ops.size(); d++, variant /= CutFragment::CUT_LOCAL_OPS) {
+            ops[d] = variant % CutFragment::CUT_LOCAL_OPS;
+        }
+        vector<Gate> circuit;
+        circuit.reserve(fragment.gates.size() + ops.size());
+        for(size_t i = 0; i < fragment.gates.size(); i++) {
+            if(fragment.slots[i] < 0) {
+                circuit.push_back(fragment.gates[i]);
+                continue;
+            }
+            int q = fragment.gates[i].qubits[0];
+            switch(ops[fragment.slots[i]]) {
+                case 0: circuit.push_back(Gate("s", {q})); break;         // S I
+                case 1: circuit.push_back(Gate("sdg", {q})); break;       // S Z
+                case 2: circuit.push_back(Gate("cut_measure", {q}));      // S M
+                        circuit.push_back(Gate("s", {q})); break;
+                case 3: break;                                            // S Sdg
+                default: circuit.push_back(Gate("z", {q})); break;        // S S
+            }
+        }
+        return circuit;
+    }
+
+    // Runs every fragment variant in parallel, through runner when given
+    // (one call per variant circuit) or else on the local statevector
+    // simulator with shared prefixes
+    void execute(FragmentRunner runner = nullptr) {
+        unsigned count = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+        vector<pair<int, size_t>> jobs;  // (fragment, variant) or, locally, (fragment, first digit + 1)
+        for(size_t f = 0; f < fragments.size(); f++) {
+            CutFragment& fragment = fragments[f];
+            size_t size = size_t(1) << fragment.qubits.size();
+            if(runner) {
+                fragment.results.assign(fragment.variant_count(), vector<double>());
+                for(size_t v = 0; v < fragment.variant_count(); v++) jobs.push_back({(int)f, v});
+            } else {
+                fragment.results.assign(fragment.variant_count(), vector<double>(size, 0.0));
+                if(count == 1 || fragment.cuts.empty()) jobs.push_back({(int)f, 0});
+                else for(int op = 0; op < CutFragment::CUT_LOCAL_OPS; op++) jobs.push_back({(int)f, op + 1});
+            }
+        }
+
+        atomic<size_t> next(0);
+        exception_ptr error;
+        atomic<bool> failed(false);
+        auto work = [&]() {
+            for(size_t j = next++; j < jobs.size() && !failed; j = next++) {
+                try {
+                    CutFragment& fragment = fragments[jobs[j].first];
+                    int n = fragment.qubits.size();
+                    if(!runner) {
+                        StatevectorSimulator sim(n);
+                        walk(fragment, 0, 0, 1, (int)jobs[j].second - 1, sim, 1.0);
+                        continue;
+                    }
+                    vector<double> result = runner(jobs[j].first, variant_circuit(jobs[j].first, jobs[j].second), n);
+                    if(result.size() != size_t(1) << n) throw runtime_error("Fragment runner returned a wrong-sized result");
+                    fragment.results[jobs[j].second] = move(result);
+                } catch(...) {
+                    if(!failed.exchange(true)) error = current_exception();
+                }
+            }
+        };
+        count = min<size_t>(count, jobs.size());
+        vector<thread> workers;
+        for(unsigned t = 1; t < count; t++) workers.emplace_back(work);
+        work();
+        for(thread& worker : workers) worker.join();
+        if(error) rethrow_exception(error);
+        executed = true;
+    }
+
+    // <Z...Z> over the given original qubits; each variant reduces to a
+    // parity expectation first, so this works at any width
+    double expectation(const vector<int>& z_qubits) const {
+        if(!executed) throw runtime_error("Circuit cutter has not been executed");
+        vector<uint64_t> masks(fragments.size(), 0);
+        for(int q : z_qubits) masks[fragment_of.at(q)] ^= 1ULL << local_of[q];
+
+        vector<vector<double>> parity(fragments.size());
+        for(size_t f = 0; f < fragments.size(); f++) {
+            for(const vector<double>& p : fragments[f].results) {
+                double e = 0.0;
+                for(size_t x = 0; x < p.size(); x++) e += __builtin_parityll(x & masks[f]) ? -p[x] : p[x];
+                parity[f].push_back(e);
+            }
+        }
+
+        double total = 0.0;
+        for_each_term([&](double coefficient, const vector<size_t>& variants) {
+            for(size_t f = 0; f < fragments.size(); f++) coefficient *= parity[f][variants[f]];
+            total += coefficient;
+        });
+        return total;
+    }
+
+    // Full quasi-probability distribution over the original qubits (bit q
+    // is qubit q). Terms are grouped by the variants of all but the widest
+    // fragment, whose vectors are summed first; each group is then one
+    // outer product scattered into the result.
+    vector<double> distribution() const {
+        if(!executed) throw runtime_error("Circuit cutter has not been executed");
+        if(num_qubits > options.max_distribution_qubits) {
+            throw runtime_error("Distribution over " + to_string(num_qubits) + " qubits exceeds max_distribution_qubits");
+        }
+        size_t last = 0;
+        for(size_t f = 1; f < fragments.size(); f++) {
+            if(fragments[f].qubits.size() > fragments[last].qubits.size()) last = f;
+        }
+
+        // Global index of every local outcome of each fragment
+        vector<vector<size_t>> global(fragments.size());
+        for(size_t f = 0; f < fragments.size(); f++) {
+            const vector<int>& qubits = fragments[f].qubits;
+            global[f].assign(size_t(1) << qubits.size(), 0);
+            for(size_t x = 1; x < global[f].size(); x++) {
+                int low = __builtin_ctzll(x);
+                global[f][x] = global[f][x & (x - 1)] | (size_t(1) << qubits[low]);
+            }
+        }
+        vector<size_t> prefix_global = {0};
+        for(size_t f = 0; f < fragments.size(); f++) {
+            if(f == last) continue;
+            vector<size_t> expanded;
+            expanded.reserve(prefix_global.size() * global[f].size());
+            for(size_t g : prefix_global) for(size_t x : global[f]) expanded.push_back(g | x);
+            prefix_global.swap(expanded);
+        }
+
+        struct Group {
+            vector<size_t> variants;
+            vector<pair<size_t, double>> last_terms;
+        };
+        vector<Group> groups;
+        unordered_map<uint64_t, size_t> group_of;
+        for_each_term([&](double coefficient, const vector<size_t>& variants) {
+            uint64_t key = 0;
+            for(size_t f = 0; f < fragments.size(); f++) {
+                if(f != last) key = key * fragments[f].variant_count() + variants[f];
+            }
+            auto it = group_of.find(key);
+            if(it == group_of.end()) {
+                it = group_of.emplace(key, groups.size()).first;
+                groups.push_back({variants, {}});
+            }
+            groups[it->second].last_terms.push_back({variants[last], coefficient});
+        });
+
+        vector<double> result(size_t(1) << num_qubits, 0.0);
+        vector<double> summed(global[last].size()), prefix;
+        for(const Group& group : groups) {
+            fill(summed.begin(), summed.end(), 0.0);
+            for(const auto& term : group.last_terms) {
+                const vector<double>& p = fragments[last].results[term.first];
+                for(size_t x = 0; x < summed.size(); x++) summed[x] += term.second * p[x];
+            }
+            prefix.assign(1, 1.0);
+            for(size_t f = 0; f < fragments.size(); f++) {
+                if(f == last) continue;
+                const vector<double>& p = fragments[f].results[group.variants[f]];
+                vector<double> expanded;
+                expanded.reserve(prefix.size() * p.size());
+                for(double a : prefix) for(double b : p) expanded.push_back(a * b);
+                prefix.swap(expanded);
+            }
+            for(size_t i = 0; i < prefix.size(); i++) {
+                if(prefix[i] == 0.0) continue;
+                size_t base = prefix_global[i];
+                for(size_t x = 0; x < summed.size(); x++) result[base | global[last][x]] += prefix[i] * summed[x];
+            }
+        }
+        return result;
+    }
+
+    int get_num_cuts() const { return cuts.size(); }
+    const vector<CutFragment>& get_fragments() const { return fragments; }
+
+    // Shot multiplier versus the uncut circuit at equal variance: gamma^2
+    // per cut with gamma = sum |c_t| = 3
+    double sampling_overhead() const { return pow(9.0, cuts.size()); }
+};
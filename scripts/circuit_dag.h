@@ -0,0 +1,451 @@
+/*
+ * Circuit DAG - Commutation-aware dependency graph and parallel passes
+ * QuantumTranspiler emits a flat gate list in program order; CircuitDag
+ * turns it into a dependency graph so passes can see which gates are
+ * independent. On each wire a gate acts Z-diagonally (rz, cz, CX control),
+ * X-diagonally (rx, sx, CX target) or generally. Consecutive gates on a wire
+ * with the same diagonal action form a commuting group; a gate depends only
+ * on the previous group of every wire it touches, so members of one group
+ * may run in any order. Layers are ASAP levels of that graph. Built with
+ * commutation off, every gate depends on the last gate of each wire, which
+ * is the ordering hardware needs for timing.
+ *
+ * DagPassManager runs passes over disjoint regions on a TaskScheduler:
+ *   optimize   per wire: merges the single-qubit rotations of each commuting
+ *              group into one, and cancels CX/CZ pairs that sit in the same
+ *              groups on both wires
+ *   translate  per chunk of gates: rewrites into the {rz, sx, x, cx} basis
+ *   schedule   per layer: start time of each gate from its predecessors,
+ *              with rz virtual (zero duration)
+ * Each region is written by one task only, so the passes need no locks.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <memory_resource>
+
+#include "quantum_transpiler.h"
+#include "quantum_hardware_benchmarks.h"
+#include "unitary.h"
+#include "core/task_scheduler.h"
+
+using namespace std;
+
+// How a gate acts on one of its qubits; gates diagonal in the same basis on
+// every wire they share commute
+enum class WireAction {
+    Z,
+    X,
+    GENERAL
+};
+
+inline WireAction wire_action(const Gate& gate, size_t index) {
+    const auto& t = gate.type;
+    size_t arity = gate.qubits.size();
+    if(arity == 1) {
+        if(t == "z" || t == "s" || t == "sdg" || t == "t" || t == "tdg" || t == "rz" ||
+           t == "p" || t == "u1" || t == "id") return WireAction::Z;
+        if(t == "x" || t == "sx" || t == "sxdg" || t == "rx") return WireAction::X;
+        return WireAction::GENERAL;
+    }
+    if(arity == 2) {
+        if(t == "cz" || t == "cp" || t == "cu1" || t == "crz" || t == "rzz") return WireAction::Z;
+        if(t == "rxx") return WireAction::X;
+        if(t == "cx" || t == "crx") return index == 0 ? WireAction::Z : WireAction::X;
+    }
+    if(arity == 3 && t == "ccx") return index < 2 ? WireAction::Z : WireAction::X;
+    return WireAction::GENERAL;
+}
+
+// Rotation angle of a single-qubit Z-type (rz up to phase) or X-type (rx up
+// to phase) gate
+inline double axis_angle(const Gate& gate) {
+    const auto& t = gate.type;
+    if(t == "z" || t == "x") return M_PI;
+    if(t == "s" || t == "sx") return M_PI / 2;
+    if(t == "sdg" || t == "sxdg") return -M_PI / 2;
+    if(t == "t") return M_PI / 4;
+    if(t == "tdg") return -M_PI / 4;
+    if(t == "p" || t == "u1") return gate_angle(gate, 0, "lambda");
+    if(t == "rz" || t == "rx") return gate_angle(gate, 0, "theta");
+    return 0.0;
+}
+
+// True for multiples of 2*pi (identity up to global phase)
+inline bool trivial_angle(double theta) {
+    return abs(remainder(theta, 2 * M_PI)) < 1e-12;
+}
+
+class CircuitDag {
+public:
+    struct Node {
+        Gate gate;
+        vector<int> predecessors;
+        vector<int> successors;
+        vector<int> groups;   // Per qubit of the gate: its commuting group on that wire
+        int layer = 0;
+        bool removed = false;
+    };
+
+private:
+    vector<Node> nodes;
+    vector<vector<int>> wires;  // Per qubit: its nodes in program order
+    int num_qubits;
+    int depth = 0;
+    bool commutation_aware;
+
+public:
+    template<typename Gates>
+    CircuitDag(const Gates& gates, int qubits, bool commutation = true)
+        : wires(qubits), num_qubits(qubits), commutation_aware(commutation) {
+        struct WireState {
+            WireAction action = WireAction::GENERAL;
+            vector<int> current, previous;  // Current group and the one before
+            int group = -1;
+        };
+        vector<WireState> state(qubits);
+
+        nodes.reserve(gates.size());
+        for(const Gate& gate : gates) {
+            int index = nodes.size();
+            Node& node = nodes.emplace_back();
+            node.gate = gate;
+            for(size_t k = 0; k < gate.qubits.size(); k++) {
+                int q = gate.qubits[k];
+                if(q < 0 || q >= qubits) throw runtime_error("Gate " + string(gate.type) + " on qubit outside the DAG");
+                WireAction action = commutation ? wire_action(gate, k) : WireAction::GENERAL;
+                WireState& wire = state[q];
+                if(action != WireAction::GENERAL && action == wire.action && !wire.current.empty()) {
+                    wire.current.push_back(index);
+                } else {
+                    wire.previous.swap(wire.current);
+                    wire.current.assign(1, index);
+                    wire.action = action;
+                    wire.group++;
+                }
+                node.groups.push_back(wire.group);
+                node.predecessors.insert(node.predecessors.end(), wire.previous.begin(), wire.previous.end());
+                wires[q].push_back(index);
+            }
+
+            sort(node.predecessors.begin(), node.predecessors.end());
+            node.predecessors.erase(unique(node.predecessors.begin(), node.predecessors.end()), node.predecessors.end());
+            for(int p : node.predecessors) {
+                nodes[p].successors.push_back(index);
+                node.layer = max(node.layer, nodes[p].layer + 1);
+            }
+            depth = max(depth, node.layer + 1);
+        }
+    }
+
+    size_t node_count() const { return nodes.size(); }
+    Node& node(size_t index) { return nodes[index]; }
+    const Node& node(size_t index) const { return nodes[index]; }
+    const vector<int>& wire(int q) const { return wires[q]; }
+    int get_num_qubits() const { return num_qubits; }
+    int get_depth() const { return depth; }
+    bool is_commutation_aware() const { return commutation_aware; }
+
+    // Commuting group of node index on wire q (q must be one of its qubits)
+    int group_on(int index, int q) const {
+        const Node& n = nodes[index];
+        for(size_t k = 0; k < n.gate.qubits.size(); k++) {
+            if(n.gate.qubits[k] == q) return n.groups[k];
+        }
+        return -1;
+    }
+
+    // Node indices per ASAP layer
+    vector<vector<int>> layers() const {
+        vector<vector<int>> result(depth);
+        for(size_t i = 0; i < nodes.size(); i++) result[nodes[i].layer].push_back(i);
+        return result;
+    }
+
+    // Remaining gates in program order
+    pmr::vector<Gate> to_gates(pmr::memory_resource* memory = pmr::get_default_resource()) const {
+        pmr::vector<Gate> gates(memory);
+        gates.reserve(nodes.size());
+        for(const Node& n : nodes) {
+            if(!n.removed) gates.push_back(n.gate);
+        }
+        return gates;
+    }
+};
+
+struct DagScheduleOptions {
+    double single_qubit_ns = 35.0;
+    double two_qubit_ns = 300.0;
+    double readout_ns = 1000.0;
+
+    static DagScheduleOptions from_hardware(const HardwareSpec& hw) {
+        DagScheduleOptions options;
+        options.single_qubit_ns = hw.single_qubit_gate_time;
+        options.two_qubit_ns = hw.two_qubit_gate_time;
+        options.readout_ns = hw.readout_time;
+        return options;
+    }
+};
+
+struct DagSchedule {
+    vector<double> start;   // Per node, in ns
+    double duration = 0.0;
+};
+
+struct DagPassReport {
+    size_t gates_before = 0;
+    size_t gates_after = 0;
+    int rotations_merged = 0;      // Rotations folded into another of their group
+    int pairs_cancelled = 0;       // CX/CZ pairs removed
+    int commutation_depth = 0;     // Input layers when commuting gates may reorder
+    int depth = 0;                 // Output layers in wire order
+    double duration_ns = 0.0;      // Scheduled length of the output
+};
+
+class DagPassManager {
+private:
+    TaskScheduler& tasks;
+
+    static constexpr size_t CHUNK = 1024;  // Gates per translation task
+    static constexpr size_t GRAIN = 256;   // Gates per scheduling task within a layer
+
+    static Gate rz(int q, double theta) { return Gate("rz", {q}, {{"theta", theta}}); }
+
+    // U3(theta, phi, lambda) = RZ(phi + pi) SX RZ(theta + pi) SX RZ(lambda) up to
+    // phase; theta = pi/2 (e.g. h) needs one SX: RZ(phi + pi/2) SX RZ(lambda - pi/2),
+    // theta = pi needs X: RZ(phi - lambda - pi) X
+    static void emit_u3(int q, double theta, double phi, double lambda, vector<Gate>& out) {
+        auto emit_rz = [&](double angle) {
+            if(!trivial_angle(angle)) out.push_back(rz(q, remainder(angle, 2 * M_PI)));
+        };
+        if(trivial_angle(theta)) {
+            emit_rz(phi + lambda);
+        } else if(trivial_angle(theta - M_PI / 2) || trivial_angle(theta + M_PI / 2)) {
+            // U3(-theta, phi, lambda) = U3(theta, phi + pi, lambda + pi) up to phase
+            double shift = trivial_angle(theta - M_PI / 2) ? 0.0 : M_PI;
+            emit_rz(lambda + shift - M_PI / 2);
+            out.push_back(Gate("sx", {q}));
+            emit_rz(phi + shift + M_PI / 2);
+        } else if(trivial_angle(theta - M_PI)) {
+            out.push_back(Gate("x", {q}));
+            emit_rz(phi - lambda - M_PI);
+        } else {
+            emit_rz(lambda);
+            out.push_back(Gate("sx", {q}));
+            out.push_back(rz(q, theta + M_PI));
+            out.push_back(Gate("sx", {q}));
+            emit_rz(phi + M_PI);
+        }
+    }
+
+    static void translate_gate(const Gate& gate, vector<Gate>& out) {
+        const auto& t = gate.type;
+        const auto& q = gate.qubits;
+        if(t == "measure" || t == "barrier" || t == "reset" || t == "cx" || t == "sx" || t == "x" || t == "rz") {
+            out.push_back(gate);
+            return;
+        }
+        if(q.size() == 1) {
+            if(wire_action(gate, 0) == WireAction::Z) {
+                double theta = axis_angle(gate);
+                if(!trivial_angle(theta)) out.push_back(rz(q[0], theta));
+                return;
+            }
+            Matrix2 m;
+            if(!single_qubit_unitary(gate, m)) throw runtime_error("Basis translation does not support gate " + string(t));
+            double theta, phi, lambda;
+            u3_angles(m, theta, phi, lambda);
+            emit_u3(q[0], theta, phi, lambda, out);
+            return;
+        }
+
+        // Multi-qubit gates expand into cx and single-qubit gates, which are
+        // translated in turn
+        vector<Gate> expansion;
+        if(q.size() == 2) {
+            int a = q[0], b = q[1];
+            if(t == "cz") {
+                expansion = {Gate("h", {b}), Gate("cx", {a, b}), Gate("h", {b})};
+            } else if(t == "swap") {
+                expansion = {Gate("cx", {a, b}), Gate("cx", {b, a}), Gate("cx", {a, b})};
+            } else if(t == "cp" || t == "cu1") {
+                double lambda = gate_angle(gate, 0, "lambda");
+                expansion = {rz(a, lambda / 2), Gate("cx", {a, b}), rz(b, -lambda / 2), Gate("cx", {a, b}), rz(b, lambda / 2)};
+            } else if(t == "crz") {
+                double theta = gate_angle(gate, 0, "theta");
+                expansion = {rz(b, theta / 2), Gate("cx", {a, b}), rz(b, -theta / 2), Gate("cx", {a, b})};
+            } else if(t == "rzz") {
+                expansion = {Gate("cx", {a, b}), rz(b, gate_angle(gate, 0, "theta")), Gate("cx", {a, b})};
+            }
+        } else if(q.size() == 3 && t == "ccx") {
+            int a = q[0], b = q[1], c = q[2];
+            expansion = {Gate("h", {c}), Gate("cx", {b, c}), Gate("tdg", {c}), Gate("cx", {a, c}), Gate("t", {c}),
+                         Gate("cx", {b, c}), Gate("tdg", {c}), Gate("cx", {a, c}), Gate("t", {b}), Gate("t", {c}),
+                         Gate("h", {c}), Gate("cx", {a, b}), Gate("t", {a}), Gate("tdg", {b}), Gate("cx", {a, b})};
+        }
+        if(expansion.empty()) throw runtime_error("Basis translation does not support gate " + string(t));
+        for(const Gate& part : expansion) translate_gate(part, out);
+    }
+
+    // Rotations and CX/CZ pairs of one commuting group [begin, end) on wire q
+    static void optimize_group(CircuitDag& dag, int q, const vector<int>& wire, size_t begin, size_t end,
+                               int& merged, int& cancelled) {
+        // Single-qubit gates of a Z or X group all commute: fold them into the first
+        int keep = -1;
+        int folded = 0;
+        double theta = 0.0;
+        WireAction action = WireAction::GENERAL;
+        for(size_t i = begin; i < end; i++) {
+            CircuitDag::Node& n = dag.node(wire[i]);
+            if(n.gate.qubits.size() != 1) continue;
+            action = wire_action(n.gate, 0);
+            if(action == WireAction::GENERAL) continue;
+            theta += axis_angle(n.gate);
+            if(keep < 0) keep = wire[i];
+            else {
+                n.removed = true;
+                folded++;
+            }
+        }
+        if(keep >= 0) {
+            CircuitDag::Node& n = dag.node(keep);
+            if(trivial_angle(theta)) {
+                n.removed = true;
+            } else if(folded > 0) {
+                n.gate.type = action == WireAction::Z ? "rz" : "rx";
+                n.gate.parameters.clear();
+                n.gate.parameters.emplace("theta", theta);
+            }
+            merged += folded;
+        }
+
+        // Identical CX (owned by the control wire) or CZ (owned by the lower
+        // wire) in the same groups on both wires commute past everything
+        // between them and cancel
+        map<pair<int, int>, int> open;  // (other qubit, its group) -> unmatched node
+        for(size_t i = begin; i < end; i++) {
+            int index = wire[i];
+            const Gate& gate = dag.node(index).gate;
+            if(gate.qubits.size() != 2 || gate.qubits[0] == gate.qubits[1]) continue;
+            bool is_cx = gate.type == "cx" && gate.qubits[0] == q;
+            bool is_cz = gate.type == "cz" && min(gate.qubits[0], gate.qubits[1]) == q;
+            if(!is_cx && !is_cz) continue;
+            int other = gate.qubits[0] == q ? gate.qubits[1] : gate.qubits[0];
+            auto key = make_pair(is_cx ? other : -1 - other, dag.group_on(index, other));
+            auto it = open.find(key);
+            if(it == open.end()) {
+                open[key] = index;
+            } else {
+                dag.node(it->second).removed = true;
+                dag.node(index).removed = true;
+                open.erase(it);
+                cancelled++;
+            }
+        }
+    }
+
+public:
+    explicit DagPassManager(TaskScheduler& scheduler) : tasks(scheduler) {}
+
+    // One task per wire; commuting groups are contiguous runs of a wire
+    void optimize(CircuitDag& dag, DagPassReport* report = nullptr) {
+        int qubits = dag.get_num_qubits();
+        vector<int> merged(qubits, 0), cancelled(qubits, 0);
+        tasks.parallel_for(qubits, [&](size_t q) {
+            const vector<int>& wire = dag.wire(q);
+            size_t begin = 0;
+            while(begin < wire.size()) {
+                int group = dag.group_on(wire[begin], q);
+                size_t end = begin + 1;
+                while(end < wire.size() && dag.group_on(wire[end], q) == group) end++;
+                if(end - begin > 1 || dag.node(wire[begin]).gate.qubits.size() == 1) {
+                    optimize_group(dag, q, wire, begin, end, merged[q], cancelled[q]);
+                }
+                begin = end;
+            }
+        });
+        if(report) {
+            for(int q = 0; q < qubits; q++) {
+                report->rotations_merged += merged[q];
+                report->pairs_cancelled += cancelled[q];
+            }
+        }
+    }
+
+    // Remaining gates in program order, in the {rz, sx, x, cx} basis
+    pmr::vector<Gate> translate(const CircuitDag& dag, pmr::memory_resource* memory = pmr::get_default_resource()) {
+        size_t chunks = (dag.node_count() + CHUNK - 1) / CHUNK;
+        vector<vector<Gate>> parts(chunks);
+        tasks.parallel_for(chunks, [&](size_t c) {
+            size_t end = min(dag.node_count(), (c + 1) * CHUNK);
+            for(size_t i = c * CHUNK; i < end; i++) {
+                if(!dag.node(i).removed) translate_gate(dag.node(i).gate, parts[c]);
+            }
+        });
+
+        size_t total = 0;
+        for(const auto& part : parts) total += part.size();
+        pmr::vector<Gate> gates(memory);
+        gates.reserve(total);
+        for(auto& part : parts) {
+            for(Gate& gate : part) gates.push_back(move(gate));
+        }
+        return gates;
+    }
+
+    // ASAP start times over a wire-order DAG, one layer at a time
+    DagSchedule schedule(const CircuitDag& dag, const DagScheduleOptions& timing) {
+        if(dag.is_commutation_aware()) throw runtime_error("Scheduling needs a wire-order DAG (commutation off)");
+        DagSchedule result;
+        result.start.assign(dag.node_count(), 0.0);
+        vector<double> finish(dag.node_count(), 0.0);
+
+        auto duration = [&](const Gate& gate) {
+            if(gate.type == "barrier" || gate.type == "rz") return 0.0;
+            if(gate.type == "measure") return timing.readout_ns;
+            return gate.qubits.size() >= 2 ? timing.two_qubit_ns : timing.single_qubit_ns;
+        };
+
+        for(const vector<int>& layer : dag.layers()) {
+            tasks.parallel_for((layer.size() + GRAIN - 1) / GRAIN, [&](size_t c) {
+                size_t end = min(layer.size(), (c + 1) * GRAIN);
+                for(size_t i = c * GRAIN; i < end; i++) {
+                    int index = layer[i];
+                    const CircuitDag::Node& n = dag.node(index);
+                    double start = 0.0;
+                    for(int p : n.predecessors) start = max(start, finish[p]);
+                    result.start[index] = start;
+                    finish[index] = start + duration(n.gate);
+                }
+            });
+        }
+        for(double f : finish) result.duration = max(result.duration, f);
+        return result;
+    }
+
+    // optimize, translate and schedule
+    template<typename Gates>
+    pmr::vector<Gate> compile(const Gates& gates, int num_qubits, const DagScheduleOptions& timing,
+                              DagPassReport* report = nullptr, pmr::memory_resource* memory = pmr::get_default_resource()) {
+        CircuitDag dag(gates, num_qubits);
+        DagPassReport local;
+        DagPassReport& r = report ? *report : local;
+        r.gates_before = gates.size();
+        r.commutation_depth = dag.get_depth();
+
+        optimize(dag, &r);
+        pmr::vector<Gate> output = translate(dag, memory);
+
+        CircuitDag ordered(output, num_qubits, false);
+        r.gates_after = output.size();
+        r.depth = ordered.get_depth();
+        r.duration_ns = schedule(ordered, timing).duration;
+        return output;
+    }
+};
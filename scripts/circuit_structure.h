@@ -0,0 +1,165 @@
+/*
+ * Circuit Structure Analysis - Hardware-cost features read from the circuit
+ * Consumes a circuit's operations in one streaming pass and summarizes its
+ * interaction graph, two-qubit gate load, critical path and gate mix.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <algorithm>
+#include <cstdint>
+
+#include "qasm_reader.h"
+#include "core/metrics.h"
+
+using namespace std;
+
+// Gate classes for the histogram (order is part of the feature layout)
+enum GateClass {
+    GATE_PAULI,        // id, x, y, z
+    GATE_HADAMARD,     // h
+    GATE_PHASE,        // s, sdg, t, tdg, sx, sxdg
+    GATE_ROTATION,     // rx, ry, rz, p, u1, u2, u3, u
+    GATE_CNOT,         // cx
+    GATE_CONTROLLED,   // cz, cy, ch, cp, crz, cu1, cu3, rzz, rxx, ...
+    GATE_SWAP,         // swap
+    GATE_MULTI,        // ccx, cswap and anything on 3+ qubits
+    GATE_CLASS_COUNT
+};
+
+struct CircuitStructure {
+    int qubits = 0;
+    int gates = 0;                 // Unitary gates (excludes measure/reset/barrier)
+    int two_qubit_gates = 0;       // Gates touching 2+ qubits
+    int critical_path_depth = 0;   // Longest dependency chain
+    int entangling_depth = 0;      // Longest chain counting multi-qubit gates only
+    int interaction_edges = 0;     // Distinct qubit pairs that interact
+    int max_degree = 0;
+    double mean_degree = 0.0;
+    int connected_components = 0;  // Among qubits that are used at all
+    int measurements = 0;
+    int gate_histogram[GATE_CLASS_COUNT] = {};
+};
+
+class CircuitStructureExtractor {
+private:
+    vector<int> level;            // Per-qubit depth of the last gate
+    vector<int> entangling_level; // Per-qubit multi-qubit depth
+    vector<int> degree;
+    vector<bool> used;
+    unordered_set<uint64_t> edges;
+    CircuitStructure structure;
+
+    static GateClass classify(const string& name, size_t arity) {
+        if(arity >= 3) return GATE_MULTI;
+        if(arity == 2) {
+            if(name == "cx" || name == "CX") return GATE_CNOT;
+            if(name == "swap") return GATE_SWAP;
+            return GATE_CONTROLLED;
+        }
+        if(name == "h") return GATE_HADAMARD;
+        if(name == "x" || name == "y" || name == "z" || name == "id") return GATE_PAULI;
+        if(name == "s" || name == "sdg" || name == "t" || name == "tdg" ||
+           name == "sx" || name == "sxdg") return GATE_PHASE;
+        return GATE_ROTATION;
+    }
+
+    void ensure_qubit(int q) {
+        if(q >= (int)level.size()) {
+            level.resize(q + 1, 0);
+            entangling_level.resize(q + 1, 0);
+            degree.resize(q + 1, 0);
+            used.resize(q + 1, false);
+        }
+    }
+
+    static uint64_t edge_key(int a, int b) {
+        if(a > b) swap(a, b);
+        return (uint64_t(a) << 32) | uint32_t(b);
+    }
+
+public:
+    void add(const QasmOp& op) {
+        for(int q : op.qubits) ensure_qubit(q);
+        if(op.name == "barrier") return;
+        if(op.name == "measure") {
+            structure.measurements++;
+            return;
+        }
+        if(op.name == "reset") return;
+
+        structure.gates++;
+        structure.gate_histogram[classify(op.name, op.qubits.size())]++;
+
+        int layer = 0;
+        for(int q : op.qubits) {
+            layer = max(layer, level[q] + 1);
+            used[q] = true;
+        }
+        for(int q : op.qubits) level[q] = layer;
+        structure.critical_path_depth = max(structure.critical_path_depth, layer);
+
+        if(op.qubits.size() >= 2) {
+            structure.two_qubit_gates++;
+            int ent_layer = 0;
+            for(int q : op.qubits) ent_layer = max(ent_layer, entangling_level[q] + 1);
+            for(int q : op.qubits) entangling_level[q] = ent_layer;
+            structure.entangling_depth = max(structure.entangling_depth, ent_layer);
+
+            for(size_t i = 0; i < op.qubits.size(); i++) {
+                for(size_t j = i + 1; j < op.qubits.size(); j++) {
+                    int a = op.qubits[i], b = op.qubits[j];
+                    if(a != b && edges.insert(edge_key(a, b)).second) {
+                        degree[a]++;
+                        degree[b]++;
+                    }
+                }
+            }
+        }
+    }
+
+    CircuitStructure finish(int num_qubits) {
+        ensure_qubit(max(0, num_qubits - 1));
+        structure.qubits = num_qubits;
+        structure.interaction_edges = edges.size();
+
+        int used_qubits = 0;
+        long degree_sum = 0;
+        for(size_t q = 0; q < degree.size(); q++) {
+            structure.max_degree = max(structure.max_degree, degree[q]);
+            degree_sum += degree[q];
+            if(used[q]) used_qubits++;
+        }
+        structure.mean_degree = used_qubits > 0 ? (double)degree_sum / used_qubits : 0.0;
+
+        // Union-find over the interaction graph
+        vector<int> parent(degree.size());
+        for(size_t q = 0; q < parent.size(); q++) parent[q] = q;
+        function<int(int)> find_root = [&](int q) {
+            while(parent[q] != q) q = parent[q] = parent[parent[q]];
+            return q;
+        };
+        int components = used_qubits;
+        for(uint64_t key : edges) {
+            int a = find_root(key >> 32), b = find_root(key & 0xFFFFFFFF);
+            if(a != b) {
+                parent[a] = b;
+                components--;
+            }
+        }
+        structure.connected_components = components;
+        return structure;
+    }
+};
+
+inline CircuitStructure extract_structure(string_view qasm) {
+    PLANCK_TIME_STAGE(PARSE);
+    QasmReader reader;
+    CircuitStructureExtractor extractor;
+    reader.parse(qasm, [&](const QasmOp& op) { extractor.add(op); });
+    return extractor.finish(reader.get_num_qubits());
+}
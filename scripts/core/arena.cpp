@@ -0,0 +1,37 @@
+/*
+ * Request Arena - Block management
+ */
+
+#include <algorithm>
+#include "arena.h"
+
+using namespace std;
+
+void* RequestArena::OverflowResource::do_allocate(size_t bytes, size_t alignment) {
+    requested += bytes;
+    return pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void RequestArena::OverflowResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool RequestArena::OverflowResource::do_is_equal(const pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+RequestArena::RequestArena(size_t initial_bytes) : block_size(max<size_t>(initial_bytes, 256)) {
+    block.reset(new byte[block_size]);
+    arena.emplace(block.get(), block_size, &overflow);
+}
+
+void RequestArena::reset() {
+    size_t needed = block_size + overflow.requested;
+    arena.reset();  // Returns any overflow chunks upstream
+    if(overflow.requested) {
+        while(block_size < needed) block_size *= 2;
+        block.reset(new byte[block_size]);
+        overflow.requested = 0;
+    }
+    arena.emplace(block.get(), block_size, &overflow);
+}
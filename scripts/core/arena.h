@@ -0,0 +1,52 @@
+/*
+ * Request Arena - Per-job monotonic memory for transpilation and mitigation
+ * Containers built on resource() bump-allocate from one block and are
+ * released together by reset(). The block grows to the largest job seen, so
+ * a long-running service settles at zero heap allocations per job.
+ *
+ * Everything allocated from the arena must be destroyed (or at least no
+ * longer used) before reset(): construct the per-job QuantumTranspiler,
+ * ErrorMitigator and result tables on it, drop them, then reset.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+using namespace std;
+
+class RequestArena {
+private:
+    // Upstream of the monotonic resource; records how far a job overflowed
+    class OverflowResource : public pmr::memory_resource {
+    public:
+        size_t requested = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override;
+    };
+
+    unique_ptr<byte[]> block;
+    size_t block_size;
+    OverflowResource overflow;
+    optional<pmr::monotonic_buffer_resource> arena;
+
+public:
+    explicit RequestArena(size_t initial_bytes = 64 * 1024);
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    pmr::memory_resource* resource() { return &*arena; }
+
+    // Frees the whole job at once; if it spilled past the block, the block
+    // is regrown to cover it next time
+    void reset();
+
+    size_t capacity() const { return block_size; }
+};
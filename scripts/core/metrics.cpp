@@ -0,0 +1,227 @@
+/*
+ * Metrics - Thread slot registry, allocation hook and exporters
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <vector>
+#include "metrics.h"
+
+using namespace std;
+
+const char* metric_name(Metric metric) {
+    switch(metric) {
+        case Metric::SWAPS_INSERTED: return "swaps_inserted";
+        case Metric::BFS_CALLS: return "bfs_calls";
+        case Metric::SIMILARITY_COMPARISONS: return "similarity_comparisons";
+        case Metric::ALLOCATIONS: return "allocations";
+        case Metric::COUNT: break;
+    }
+    return "unknown";
+}
+
+static const char* metric_help(Metric metric) {
+    switch(metric) {
+        case Metric::SWAPS_INSERTED: return "SWAP gates inserted by routing";
+        case Metric::BFS_CALLS: return "Shortest-path searches on the coupling map";
+        case Metric::SIMILARITY_COMPARISONS: return "Feature vector cosine similarities computed";
+        case Metric::ALLOCATIONS: return "Heap allocations through operator new";
+        case Metric::COUNT: break;
+    }
+    return "";
+}
+
+const char* stage_name(Stage stage) {
+    switch(stage) {
+        case Stage::PARSE: return "parse";
+        case Stage::ROUTE: return "route";
+        case Stage::MITIGATE: return "mitigate";
+        case Stage::VECTORIZE: return "vectorize";
+        case Stage::RECOMMEND: return "recommend";
+        case Stage::COUNT: break;
+    }
+    return "unknown";
+}
+
+#ifdef PLANCK_METRICS
+
+static void export_at_exit();
+
+struct MetricsRegistry {
+    mutex lock;
+    vector<MetricsSlot*> live;
+    MetricsSnapshot retired;  // Folded in by threads as they exit
+};
+
+// Leaked on purpose: thread slots deregister during exit, after statics
+// could already have been destroyed
+static MetricsRegistry& registry() {
+    static MetricsRegistry* instance = [] {
+        MetricsRegistry* r = new MetricsRegistry();
+        atexit(export_at_exit);
+        return r;
+    }();
+    return *instance;
+}
+
+thread_local MetricsThread metrics_thread;
+
+// Probes that fire while a thread is being torn down land here
+static MetricsSlot discarded{};
+
+MetricsSlot& metrics_register(MetricsThread& thread) {
+    if(thread.exited) return discarded;
+    // Set first: registering allocates, which re-enters through operator new
+    thread.registered = true;
+    MetricsRegistry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    r.live.push_back(&thread.slot);
+    return thread.slot;
+}
+
+static void accumulate(MetricsSnapshot& into, const MetricsSlot& slot) {
+    for(int m = 0; m < METRIC_COUNT; m++) into.counters[m] += slot.counters[m].load(memory_order_relaxed);
+    for(int s = 0; s < STAGE_COUNT; s++) {
+        for(int b = 0; b < LATENCY_BUCKETS; b++) into.latency[s][b] += slot.latency[s][b].load(memory_order_relaxed);
+        into.latency_sum_ns[s] += slot.latency_sum_ns[s].load(memory_order_relaxed);
+    }
+}
+
+MetricsThread::~MetricsThread() {
+    exited = true;
+    if(!registered) return;
+    MetricsRegistry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    accumulate(r.retired, slot);
+    for(size_t i = 0; i < r.live.size(); i++) {
+        if(r.live[i] == &slot) {
+            r.live[i] = r.live.back();
+            r.live.pop_back();
+            break;
+        }
+    }
+}
+
+MetricsSnapshot metrics_snapshot() {
+    MetricsRegistry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    MetricsSnapshot snapshot = r.retired;
+    for(const MetricsSlot* slot : r.live) accumulate(snapshot, *slot);
+    return snapshot;
+}
+
+bool metrics_enabled() { return true; }
+
+void* operator new(size_t size) {
+    metrics_add(Metric::ALLOCATIONS);
+    if(void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// std::pmr's default resource allocates through the aligned forms
+void* operator new(size_t size, align_val_t alignment) {
+    metrics_add(Metric::ALLOCATIONS);
+    size_t align = (size_t)alignment;
+    if(void* p = aligned_alloc(align, (size + align) / align * align)) return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size, align_val_t alignment) { return operator new(size, alignment); }
+
+void operator delete(void* p, align_val_t) noexcept { free(p); }
+void operator delete[](void* p, align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { free(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { free(p); }
+
+#else
+
+MetricsSnapshot metrics_snapshot() { return MetricsSnapshot(); }
+
+bool metrics_enabled() { return false; }
+
+#endif
+
+string metrics_prometheus() {
+    MetricsSnapshot snapshot = metrics_snapshot();
+    ostringstream out;
+    for(int m = 0; m < METRIC_COUNT; m++) {
+        const char* name = metric_name((Metric)m);
+        out << "# HELP planck_" << name << "_total " << metric_help((Metric)m) << "\n";
+        out << "# TYPE planck_" << name << "_total counter\n";
+        out << "planck_" << name << "_total " << snapshot.counters[m] << "\n";
+    }
+
+    out << "# HELP planck_stage_latency_seconds Wall time per pipeline stage\n";
+    out << "# TYPE planck_stage_latency_seconds histogram\n";
+    for(int s = 0; s < STAGE_COUNT; s++) {
+        const char* name = stage_name((Stage)s);
+        uint64_t cumulative = 0;
+        for(int b = 0; b < LATENCY_BUCKETS; b++) {
+            cumulative += snapshot.latency[s][b];
+            out << "planck_stage_latency_seconds_bucket{stage=\"" << name << "\",le=\"";
+            if(b == LATENCY_BUCKETS - 1) out << "+Inf";
+            else out << (double)(1ULL << b) * 1e-6;
+            out << "\"} " << cumulative << "\n";
+        }
+        out << "planck_stage_latency_seconds_sum{stage=\"" << name << "\"} "
+            << snapshot.latency_sum_ns[s] * 1e-9 << "\n";
+        out << "planck_stage_latency_seconds_count{stage=\"" << name << "\"} " << cumulative << "\n";
+    }
+    return out.str();
+}
+
+// Stage buckets are per-bucket counts (bucket i: under 2^i us), not cumulative
+string metrics_json() {
+    MetricsSnapshot snapshot = metrics_snapshot();
+    ostringstream out;
+    out << "{\"enabled\":" << (metrics_enabled() ? "true" : "false") << ",\"counters\":{";
+    for(int m = 0; m < METRIC_COUNT; m++) {
+        if(m) out << ",";
+        out << "\"" << metric_name((Metric)m) << "\":" << snapshot.counters[m];
+    }
+    out << "},\"stages\":{";
+    for(int s = 0; s < STAGE_COUNT; s++) {
+        if(s) out << ",";
+        out << "\"" << stage_name((Stage)s) << "\":{\"count\":" << snapshot.stage_count((Stage)s)
+            << ",\"sum_ms\":" << snapshot.latency_sum_ns[s] * 1e-6 << ",\"buckets_us\":[";
+        int last = LATENCY_BUCKETS - 1;
+        while(last > 0 && snapshot.latency[s][last] == 0) last--;
+        for(int b = 0; b <= last; b++) {
+            if(b) out << ",";
+            out << snapshot.latency[s][b];
+        }
+        out << "]}";
+    }
+    out << "}}";
+    return out.str();
+}
+
+#ifdef PLANCK_METRICS
+
+static void export_at_exit() {
+    const char* format = getenv("PLANCK_METRICS_EXPORT");
+    if(!format) return;
+    string text;
+    if(strcmp(format, "json") == 0) text = metrics_json() + "\n";
+    else if(strcmp(format, "prometheus") == 0) text = metrics_prometheus();
+    else return;
+
+    const char* path = getenv("PLANCK_METRICS_FILE");
+    FILE* out = path ? fopen(path, "w") : stderr;
+    if(!out) return;
+    fwrite(text.data(), 1, text.size(), out);
+    if(path) fclose(out);
+}
+
+#endif
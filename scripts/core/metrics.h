@@ -0,0 +1,142 @@
+/*
+ * Metrics - Hot-path counters and per-stage latency histograms
+ * Every thread accumulates into its own slot with relaxed single-writer
+ * stores, so probes never contend; exports sum the live slots and those of
+ * threads that have exited. Configure with -DPLANCK_METRICS=OFF to compile
+ * every probe out.
+ *
+ * Tools write an export at exit when PLANCK_METRICS_EXPORT is "json" or
+ * "prometheus" (to PLANCK_METRICS_FILE, or stderr when unset).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+enum class Metric {
+    SWAPS_INSERTED,
+    BFS_CALLS,
+    SIMILARITY_COMPARISONS,
+    ALLOCATIONS,
+    COUNT
+};
+
+enum class Stage {
+    PARSE,
+    ROUTE,
+    MITIGATE,
+    VECTORIZE,
+    RECOMMEND,
+    COUNT
+};
+
+const int METRIC_COUNT = (int)Metric::COUNT;
+const int STAGE_COUNT = (int)Stage::COUNT;
+
+// Bucket i counts stage runs shorter than 2^i microseconds; the last
+// bucket also takes everything slower (about 4 s and up)
+const int LATENCY_BUCKETS = 24;
+
+const char* metric_name(Metric metric);
+const char* stage_name(Stage stage);
+
+struct MetricsSlot {
+    atomic<uint64_t> counters[METRIC_COUNT];
+    atomic<uint64_t> latency[STAGE_COUNT][LATENCY_BUCKETS];
+    atomic<uint64_t> latency_sum_ns[STAGE_COUNT];
+};
+
+struct MetricsSnapshot {
+    uint64_t counters[METRIC_COUNT] = {};
+    uint64_t latency[STAGE_COUNT][LATENCY_BUCKETS] = {};
+    uint64_t latency_sum_ns[STAGE_COUNT] = {};
+
+    uint64_t stage_count(Stage stage) const {
+        uint64_t total = 0;
+        for(int b = 0; b < LATENCY_BUCKETS; b++) total += latency[(int)stage][b];
+        return total;
+    }
+};
+
+// Process-wide totals; all zero when metrics are compiled out
+MetricsSnapshot metrics_snapshot();
+bool metrics_enabled();
+string metrics_prometheus();
+string metrics_json();
+
+inline int latency_bucket(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    int bucket = us ? 64 - __builtin_clzll(us) : 0;
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+#ifdef PLANCK_METRICS
+
+struct MetricsThread {
+    MetricsSlot slot{};
+    bool registered = false;
+    bool exited = false;
+    ~MetricsThread();
+};
+
+extern thread_local MetricsThread metrics_thread;
+
+// Publishes the calling thread's slot on first use
+MetricsSlot& metrics_register(MetricsThread& thread);
+
+inline MetricsSlot& metrics_local() {
+    MetricsThread& thread = metrics_thread;
+    if(!thread.registered) return metrics_register(thread);
+    return thread.slot;
+}
+
+// Only the owning thread writes a slot, so a relaxed load/store suffices
+inline void bump(atomic<uint64_t>& cell, uint64_t n) {
+    cell.store(cell.load(memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+inline void metrics_add(Metric metric, uint64_t n = 1) {
+    bump(metrics_local().counters[(int)metric], n);
+}
+
+inline void metrics_record(Stage stage, uint64_t ns) {
+    MetricsSlot& slot = metrics_local();
+    bump(slot.latency[(int)stage][latency_bucket(ns)], 1);
+    bump(slot.latency_sum_ns[(int)stage], ns);
+}
+
+// The calling thread's own count, e.g. allocations inside a benchmark loop
+inline uint64_t metrics_thread_value(Metric metric) {
+    return metrics_local().counters[(int)metric].load(memory_order_relaxed);
+}
+
+class StageTimer {
+private:
+    Stage stage;
+    chrono::steady_clock::time_point start;
+
+public:
+    explicit StageTimer(Stage s) : stage(s), start(chrono::steady_clock::now()) {}
+
+    ~StageTimer() {
+        auto elapsed = chrono::steady_clock::now() - start;
+        metrics_record(stage, chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    }
+};
+
+#define PLANCK_METRICS_CONCAT_(a, b) a##b
+#define PLANCK_METRICS_CONCAT(a, b) PLANCK_METRICS_CONCAT_(a, b)
+#define PLANCK_COUNT(metric, n) metrics_add(Metric::metric, (n))
+#define PLANCK_TIME_STAGE(stage) StageTimer PLANCK_METRICS_CONCAT(stage_timer_, __LINE__)(Stage::stage)
+
+#else
+
+#define PLANCK_COUNT(metric, n) ((void)0)
+#define PLANCK_TIME_STAGE(stage) ((void)0)
+
+#endif
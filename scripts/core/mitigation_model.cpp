@@ -0,0 +1,59 @@
+/*
+ * Mitigation Model - Qubit overhead and residual error per mitigation level
+ */
+
+#include <cmath>
+#include "mitigation_model.h"
+
+using namespace std;
+
+MitigationLevel parse_mitigation_level(const string& name) {
+    if(name == "low") return MitigationLevel::LOW;
+    if(name == "medium") return MitigationLevel::MEDIUM;
+    if(name == "high") return MitigationLevel::HIGH;
+    return MitigationLevel::NONE;
+}
+
+const char* mitigation_level_name(MitigationLevel level) {
+    switch(level) {
+        case MitigationLevel::NONE: return "none";
+        case MitigationLevel::LOW: return "low";
+        case MitigationLevel::MEDIUM: return "medium";
+        case MitigationLevel::HIGH: return "high";
+    }
+    return "unknown";
+}
+
+int mitigation_qubit_overhead(MitigationLevel level) {
+    switch(level) {
+        case MitigationLevel::NONE:
+            return 1;
+        case MitigationLevel::LOW:
+            // Simple repetition code: 2x overhead
+            return 2;
+        case MitigationLevel::MEDIUM:
+            // Steane code: 5x overhead
+            return 5;
+        case MitigationLevel::HIGH:
+            // Surface code: ~10x overhead for logical error rate 10^-3
+            return 10;
+    }
+    return 1;
+}
+
+double mitigated_error_rate(MitigationLevel level, double base_rate) {
+    switch(level) {
+        case MitigationLevel::NONE:
+            return base_rate;
+        case MitigationLevel::LOW:
+            // Majority voting reduces error rate
+            return base_rate * base_rate;  // ~O(p^2)
+        case MitigationLevel::MEDIUM:
+            // Steane code: O(p^3)
+            return pow(base_rate, 3);
+        case MitigationLevel::HIGH:
+            // Surface code with higher threshold
+            return pow(base_rate, 5);
+    }
+    return base_rate;
+}
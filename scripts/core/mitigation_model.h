@@ -0,0 +1,39 @@
+/*
+ * Mitigation Model - Qubit overhead and residual error per mitigation level
+ * Single definition used by ErrorMitigator and the configuration CLI.
+ */
+
+#pragma once
+
+#include <string>
+
+using namespace std;
+
+// Error mitigation strategies
+enum class MitigationLevel {
+    NONE,
+    LOW,
+    MEDIUM,
+    HIGH
+};
+
+// "none", "low", "medium" or "high"; anything else is NONE
+MitigationLevel parse_mitigation_level(const string& name);
+
+const char* mitigation_level_name(MitigationLevel level);
+
+// Physical qubits per logical qubit
+int mitigation_qubit_overhead(MitigationLevel level);
+
+// Effective error rate after mitigation for a base physical error rate
+double mitigated_error_rate(MitigationLevel level, double base_rate);
+
+// Measured effect of one level on sampled noisy executions
+// (see mitigation_benchmark.h)
+struct MitigationMeasurement {
+    MitigationLevel level;
+    double raw_fidelity;        // Mean fidelity to the ideal output, unmitigated
+    double mitigated_fidelity;  // Same after the level's techniques
+    double fidelity_gain;       // mitigated_fidelity / raw_fidelity
+    double shot_overhead;       // Shots executed per unmitigated shot
+};
@@ -0,0 +1,234 @@
+/*
+ * Planck Node Addon - Node-API bindings over the planck_core C ABI
+ * Feature vectors are written straight into Float64Array storage, so the
+ * TypeScript engine no longer round-trips JSON through a child process.
+ */
+
+#include <node_api.h>
+#include <string>
+#include <vector>
+
+#include "core/planck_c.h"
+#include "ml_feature_vectorizer.h"
+
+using namespace std;
+
+#define NAPI_CALL(env, call)                                            \
+    do {                                                                \
+        if((call) != napi_ok) {                                         \
+            napi_throw_error((env), nullptr, "Node-API call failed");   \
+            return nullptr;                                             \
+        }                                                               \
+    } while(0)
+
+static napi_value throw_last_error(napi_env env) {
+    napi_throw_error(env, nullptr, planck_last_error());
+    return nullptr;
+}
+
+static bool get_args(napi_env env, napi_callback_info info, size_t expected, napi_value* argv) {
+    size_t argc = expected;
+    if(napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr) != napi_ok || argc < expected) {
+        napi_throw_type_error(env, nullptr, "Wrong number of arguments");
+        return false;
+    }
+    return true;
+}
+
+static bool get_string(napi_env env, napi_value value, string& out) {
+    size_t len = 0;
+    if(napi_get_value_string_utf8(env, value, nullptr, 0, &len) != napi_ok) return false;
+    out.resize(len);
+    return napi_get_value_string_utf8(env, value, &out[0], len + 1, &len) == napi_ok;
+}
+
+// Missing or non-numeric properties keep the default, like parse_features
+static double get_number_property(napi_env env, napi_value obj, const char* key, double fallback) {
+    napi_value value;
+    napi_valuetype type;
+    double result;
+    if(napi_get_named_property(env, obj, key, &value) != napi_ok) return fallback;
+    if(napi_typeof(env, value, &type) != napi_ok || type != napi_number) return fallback;
+    if(napi_get_value_double(env, value, &result) != napi_ok) return fallback;
+    return result;
+}
+
+static bool get_string_property(napi_env env, napi_value obj, const char* key, string& out) {
+    napi_value value;
+    napi_valuetype type;
+    if(napi_get_named_property(env, obj, key, &value) != napi_ok) return false;
+    if(napi_typeof(env, value, &type) != napi_ok || type != napi_string) return false;
+    return get_string(env, value, out);
+}
+
+static bool get_float64_array(napi_env env, napi_value value, const double** data, size_t* length) {
+    bool is_typed = false;
+    napi_typedarray_type type;
+    void* raw = nullptr;
+    if(napi_is_typedarray(env, value, &is_typed) != napi_ok || !is_typed) return false;
+    if(napi_get_typedarray_info(env, value, &type, length, &raw, nullptr, nullptr) != napi_ok) return false;
+    if(type != napi_float64_array) return false;
+    *data = static_cast<const double*>(raw);
+    return true;
+}
+
+static planck_engine* get_engine(napi_env env, napi_value value) {
+    void* engine = nullptr;
+    if(napi_get_value_external(env, value, &engine) != napi_ok) return nullptr;
+    return static_cast<planck_engine*>(engine);
+}
+
+// vectorize({qubits, depth, gates, algorithm, ...}) -> Float64Array
+static napi_value Vectorize(napi_env env, napi_callback_info info) {
+    napi_value argv[1];
+    if(!get_args(env, info, 1, argv)) return nullptr;
+
+    // Same keys and defaults as parse_features
+    napi_value obj = argv[0];
+    string algorithm = "bell";
+    string backend = "classical";
+    string mitigation;
+    get_string_property(env, obj, "algorithm", algorithm);
+    if(!get_string_property(env, obj, "backendPreference", backend) &&
+       get_string_property(env, obj, "errorMitigation", mitigation)) {
+        backend = backend_for_mitigation(mitigation);
+    }
+
+    planck_circuit_features features;
+    features.qubits = (int)get_number_property(env, obj, "qubits", 2);
+    features.depth = (int)get_number_property(env, obj, "depth", 10);
+    features.gates = (int)get_number_property(env, obj, "gateCount", get_number_property(env, obj, "gates", 20));
+    features.algorithm = algorithm.c_str();
+    features.data_size = (int)get_number_property(env, obj, "dataSize", 100);
+    features.complexity_score = get_number_property(env, obj, "dataComplexity", 0.5);
+    features.target_latency = get_number_property(env, obj, "targetLatency", 1000.0);
+    features.backend_preference = backend.c_str();
+
+    size_t dim = planck_feature_dim();
+    napi_value buffer, result;
+    void* data = nullptr;
+    NAPI_CALL(env, napi_create_arraybuffer(env, dim * sizeof(double), &data, &buffer));
+    if(planck_vectorize(&features, static_cast<double*>(data), dim) < 0) return throw_last_error(env);
+    NAPI_CALL(env, napi_create_typedarray(env, napi_float64_array, dim, buffer, 0, &result));
+    return result;
+}
+
+static napi_value CosineSimilarity(napi_env env, napi_callback_info info) {
+    napi_value argv[2];
+    if(!get_args(env, info, 2, argv)) return nullptr;
+    const double *a, *b;
+    size_t len_a, len_b;
+    if(!get_float64_array(env, argv[0], &a, &len_a) || !get_float64_array(env, argv[1], &b, &len_b)) {
+        napi_throw_type_error(env, nullptr, "Expected two Float64Arrays");
+        return nullptr;
+    }
+    napi_value result;
+    NAPI_CALL(env, napi_create_double(env, len_a == len_b ? planck_cosine_similarity(a, b, len_a) : 0.0, &result));
+    return result;
+}
+
+static void finalize_engine(napi_env, void* engine, void*) {
+    planck_engine_destroy(static_cast<planck_engine*>(engine));
+}
+
+static napi_value CreateEngine(napi_env env, napi_callback_info) {
+    planck_engine* engine = planck_engine_create();
+    if(!engine) return throw_last_error(env);
+    napi_value result;
+    if(napi_create_external(env, engine, finalize_engine, nullptr, &result) != napi_ok) {
+        planck_engine_destroy(engine);
+        napi_throw_error(env, nullptr, "Failed to wrap engine");
+        return nullptr;
+    }
+    return result;
+}
+
+// loadHistory(engine, path) -> number of executions replayed
+static napi_value LoadHistory(napi_env env, napi_callback_info info) {
+    napi_value argv[2];
+    if(!get_args(env, info, 2, argv)) return nullptr;
+    planck_engine* engine = get_engine(env, argv[0]);
+    string path;
+    if(!engine || !get_string(env, argv[1], path)) {
+        napi_throw_type_error(env, nullptr, "Expected (engine, path)");
+        return nullptr;
+    }
+    long loaded = planck_engine_load_history(engine, path.c_str());
+    if(loaded < 0) return throw_last_error(env);
+    napi_value result;
+    NAPI_CALL(env, napi_create_int64(env, loaded, &result));
+    return result;
+}
+
+// observe(engine, features, shots, backend, reward)
+static napi_value Observe(napi_env env, napi_callback_info info) {
+    napi_value argv[5];
+    if(!get_args(env, info, 5, argv)) return nullptr;
+    planck_engine* engine = get_engine(env, argv[0]);
+    const double* features;
+    size_t dim;
+    int32_t shots;
+    string backend;
+    double reward;
+    if(!engine || !get_float64_array(env, argv[1], &features, &dim) ||
+       napi_get_value_int32(env, argv[2], &shots) != napi_ok ||
+       !get_string(env, argv[3], backend) ||
+       napi_get_value_double(env, argv[4], &reward) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "Expected (engine, Float64Array, shots, backend, reward)");
+        return nullptr;
+    }
+    if(planck_engine_observe(engine, features, dim, shots, backend.c_str(), reward) < 0) return throw_last_error(env);
+    return nullptr;
+}
+
+// recommend(engine, features, defaultShots, defaultBackend) -> {shots, backend, confidence}
+static napi_value Recommend(napi_env env, napi_callback_info info) {
+    napi_value argv[4];
+    if(!get_args(env, info, 4, argv)) return nullptr;
+    planck_engine* engine = get_engine(env, argv[0]);
+    const double* features;
+    size_t dim;
+    int32_t default_shots;
+    string default_backend;
+    if(!engine || !get_float64_array(env, argv[1], &features, &dim) ||
+       napi_get_value_int32(env, argv[2], &default_shots) != napi_ok ||
+       !get_string(env, argv[3], default_backend)) {
+        napi_throw_type_error(env, nullptr, "Expected (engine, Float64Array, defaultShots, defaultBackend)");
+        return nullptr;
+    }
+
+    planck_recommendation rec;
+    if(planck_engine_recommend(engine, features, dim, default_shots, default_backend.c_str(), &rec) < 0) {
+        return throw_last_error(env);
+    }
+    napi_value result, shots, backend, confidence;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, napi_create_int32(env, rec.shots, &shots));
+    NAPI_CALL(env, napi_create_string_utf8(env, rec.backend, NAPI_AUTO_LENGTH, &backend));
+    NAPI_CALL(env, napi_create_double(env, rec.confidence, &confidence));
+    NAPI_CALL(env, napi_set_named_property(env, result, "shots", shots));
+    NAPI_CALL(env, napi_set_named_property(env, result, "backend", backend));
+    NAPI_CALL(env, napi_set_named_property(env, result, "confidence", confidence));
+    return result;
+}
+
+static napi_value Init(napi_env env, napi_value exports) {
+    napi_property_descriptor methods[] = {
+        {"vectorize", nullptr, Vectorize, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"cosineSimilarity", nullptr, CosineSimilarity, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"createEngine", nullptr, CreateEngine, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"loadHistory", nullptr, LoadHistory, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"observe", nullptr, Observe, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"recommend", nullptr, Recommend, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+    NAPI_CALL(env, napi_define_properties(env, exports, sizeof(methods) / sizeof(methods[0]), methods));
+
+    napi_value version, dim;
+    NAPI_CALL(env, napi_create_int32(env, planck_api_version(), &version));
+    NAPI_CALL(env, napi_create_uint32(env, (uint32_t)planck_feature_dim(), &dim));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "apiVersion", version));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "featureDim", dim));
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,151 @@
+/*
+ * Planck Core C ABI - Implementation over the C++ modules
+ * No exception crosses the ABI; failures are reported via planck_last_error.
+ */
+
+#include <cstring>
+#include <string>
+
+#include "planck_c.h"
+#include "similarity.h"
+#include "topology.h"
+#include "mitigation_model.h"
+#include "ml_feature_vectorizer.h"
+#include "ml_reinforcement_engine.h"
+#include "ml_history_log.h"
+
+using namespace std;
+
+struct planck_engine {
+    ReinforcementEngine engine;
+};
+
+static thread_local string last_error;
+
+static int fail(const string& message) {
+    last_error = message;
+    return -1;
+}
+
+template<typename F>
+static int guarded(F&& body) {
+    try {
+        return body();
+    } catch(const exception& e) {
+        return fail(e.what());
+    } catch(...) {
+        return fail("unknown error");
+    }
+}
+
+extern "C" {
+
+int planck_api_version(void) { return PLANCK_C_API_VERSION; }
+
+const char* planck_last_error(void) { return last_error.c_str(); }
+
+size_t planck_feature_dim(void) { return FEATURE_DIM; }
+
+int planck_vectorize(const planck_circuit_features* features, double* out, size_t out_len) {
+    if(!features || !out) return fail("null argument");
+    if(out_len < FEATURE_DIM) return fail("output buffer smaller than planck_feature_dim()");
+    return guarded([&] {
+        static const FeatureVectorizer vectorizer;
+        CircuitFeatures f;
+        reset_features(f);
+        f.qubits = features->qubits;
+        f.depth = features->depth;
+        f.gates = features->gates;
+        if(features->algorithm) f.algorithm = features->algorithm;
+        f.data_size = features->data_size;
+        f.complexity_score = features->complexity_score;
+        f.target_latency = features->target_latency;
+        if(features->backend_preference) f.backend_preference = features->backend_preference;
+        vectorizer.vectorize_into(f, out);
+        return (int)FEATURE_DIM;
+    });
+}
+
+int planck_vectorize_json(const char* json, size_t len, double* out, size_t out_len) {
+    if(!json || !out) return fail("null argument");
+    if(out_len < FEATURE_DIM) return fail("output buffer smaller than planck_feature_dim()");
+    return guarded([&] {
+        static const FeatureVectorizer vectorizer;
+        CircuitFeatures f;
+        parse_features(string_view(json, len), f);
+        vectorizer.vectorize_into(f, out);
+        return (int)FEATURE_DIM;
+    });
+}
+
+double planck_cosine_similarity(const double* a, const double* b, size_t n) {
+    if(!a || !b) return 0.0;
+    return cosine_similarity(a, b, n);
+}
+
+planck_engine* planck_engine_create(void) {
+    try {
+        return new planck_engine();
+    } catch(const exception& e) {
+        fail(e.what());
+        return nullptr;
+    }
+}
+
+void planck_engine_destroy(planck_engine* engine) { delete engine; }
+
+long planck_engine_load_history(planck_engine* engine, const char* path) {
+    if(!engine || !path) return fail("null argument");
+    try {
+        HistoryLogReader reader(path);
+        return (long)reader.feed(engine->engine);
+    } catch(const exception& e) {
+        return fail(e.what());
+    }
+}
+
+int planck_engine_observe(planck_engine* engine, const double* features, size_t dim,
+                          int shots, const char* backend, double reward) {
+    if(!engine || !features || !backend) return fail("null argument");
+    return guarded([&] {
+        engine->engine.observe(features, dim, shots, backend, reward);
+        return 0;
+    });
+}
+
+int planck_engine_recommend(const planck_engine* engine, const double* features, size_t dim,
+                            int default_shots, const char* default_backend,
+                            planck_recommendation* out) {
+    if(!engine || !features || !default_backend || !out) return fail("null argument");
+    return guarded([&] {
+        vector<double> x(features, features + dim);
+        Recommendation rec = engine->engine.recommend(x, default_shots, default_backend);
+        out->shots = rec.recommended_shots;
+        out->confidence = rec.confidence;
+        strncpy(out->backend, rec.recommended_backend.c_str(), sizeof(out->backend) - 1);
+        out->backend[sizeof(out->backend) - 1] = '\0';
+        return 0;
+    });
+}
+
+int planck_mitigation_overhead(const char* level) {
+    if(!level) return fail("null argument");
+    MitigationLevel parsed = parse_mitigation_level(level);
+    if(parsed == MitigationLevel::NONE && strcmp(level, "none") != 0) return fail(string("unknown mitigation level: ") + level);
+    return mitigation_qubit_overhead(parsed);
+}
+
+double planck_mitigated_error_rate(const char* level, double base_rate) {
+    if(!level) return fail("null argument");
+    MitigationLevel parsed = parse_mitigation_level(level);
+    if(parsed == MitigationLevel::NONE && strcmp(level, "none") != 0) return fail(string("unknown mitigation level: ") + level);
+    return mitigated_error_rate(parsed, base_rate);
+}
+
+int planck_qpu_qubit_count(const char* qpu) {
+    QPUType type;
+    if(!qpu || !parse_qpu_type(qpu, type)) return fail(string("unknown QPU: ") + (qpu ? qpu : "(null)"));
+    return qpu_qubit_count(type);
+}
+
+}
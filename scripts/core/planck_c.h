@@ -0,0 +1,68 @@
+/*
+ * Planck Core C ABI - Stable C entry points into planck_core
+ * For FFI callers (the Node-API addon, Python ctypes, ...). Functions return
+ * 0 (or a count) on success and -1 on failure, with the message available
+ * from planck_last_error() on the calling thread. Engines are not internally
+ * synchronized: callers serialize access to one handle.
+ */
+
+#ifndef PLANCK_C_H
+#define PLANCK_C_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped on any incompatible change to the declarations below */
+#define PLANCK_C_API_VERSION 1
+
+typedef struct planck_engine planck_engine;
+
+typedef struct {
+    int qubits;
+    int depth;
+    int gates;
+    const char* algorithm;           /* bell, grover, shor, vqe, qaoa, ... */
+    int data_size;
+    double complexity_score;
+    double target_latency;           /* Milliseconds; <= 0 means unspecified */
+    const char* backend_preference;  /* classical, hpc or quantum */
+} planck_circuit_features;
+
+typedef struct {
+    int shots;
+    char backend[32];
+    double confidence;
+} planck_recommendation;
+
+int planck_api_version(void);
+const char* planck_last_error(void);
+
+/* Feature vectors: out must hold planck_feature_dim() doubles */
+size_t planck_feature_dim(void);
+int planck_vectorize(const planck_circuit_features* features, double* out, size_t out_len);
+int planck_vectorize_json(const char* json, size_t len, double* out, size_t out_len);
+double planck_cosine_similarity(const double* a, const double* b, size_t n);
+
+/* Contextual-bandit recommendation engine */
+planck_engine* planck_engine_create(void);
+void planck_engine_destroy(planck_engine* engine);
+long planck_engine_load_history(planck_engine* engine, const char* path);
+int planck_engine_observe(planck_engine* engine, const double* features, size_t dim,
+                          int shots, const char* backend, double reward);
+int planck_engine_recommend(const planck_engine* engine, const double* features, size_t dim,
+                            int default_shots, const char* default_backend,
+                            planck_recommendation* out);
+
+/* Mitigation and topology models; unknown names give -1 */
+int planck_mitigation_overhead(const char* level);
+double planck_mitigated_error_rate(const char* level, double base_rate);
+int planck_qpu_qubit_count(const char* qpu);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Planck Core - Public C++ API of the planck_core library
+ * Shared models every tool links against; the same functionality is
+ * exported to other languages through planck_c.h.
+ */
+
+#pragma once
+
+#include "similarity.h"
+#include "topology.h"
+#include "mitigation_model.h"
+#include "planck_c.h"
@@ -0,0 +1,105 @@
+/*
+ * RNG Streams - Counter-based random numbers for exploration and sampling
+ * RngStream is Philox4x32-10 (Salmon et al., SC'11): output block i of a
+ * stream is a keyed bijection of the counter (i, stream), so any number of
+ * streams from one seed are independent, need no shared state or locks, and
+ * jump ahead in O(1). Give each thread, request or work chunk its own stream
+ * id and results reproduce for a given seed regardless of scheduling.
+ * Satisfies UniformRandomBitGenerator, so <random> distributions accept it.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+using namespace std;
+
+class RngStream {
+private:
+    uint32_t key[2];
+    uint64_t stream;
+    uint64_t block = 0;     // Index of the next block to generate
+    uint64_t buffer[2];
+    int available = 0;      // Unread words left in buffer
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+        uint64_t product = (uint64_t)a * b;
+        hi = product >> 32;
+        lo = (uint32_t)product;
+    }
+
+    void generate() {
+        uint32_t ctr[4] = {(uint32_t)block, (uint32_t)(block >> 32), (uint32_t)stream, (uint32_t)(stream >> 32)};
+        uint32_t k0 = key[0], k1 = key[1];
+        for(int round = 0; round < 10; round++) {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(0xD2511F53u, ctr[0], hi0, lo0);
+            mulhilo(0xCD9E8D57u, ctr[2], hi1, lo1);
+            uint32_t next[4] = {hi1 ^ ctr[1] ^ k0, lo1, hi0 ^ ctr[3] ^ k1, lo0};
+            ctr[0] = next[0], ctr[1] = next[1], ctr[2] = next[2], ctr[3] = next[3];
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        buffer[0] = (uint64_t)ctr[1] << 32 | ctr[0];
+        buffer[1] = (uint64_t)ctr[3] << 32 | ctr[2];
+        block++;
+        available = 2;
+    }
+
+public:
+    using result_type = uint64_t;
+
+    explicit RngStream(uint64_t seed = 0, uint64_t stream_id = 0)
+        : key{(uint32_t)seed, (uint32_t)(seed >> 32)}, stream(stream_id) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~0ULL; }
+
+    result_type operator()() {
+        if(available == 0) generate();
+        return buffer[2 - available--];
+    }
+
+    // Skips n outputs without generating them
+    void discard(uint64_t n) {
+        uint64_t position = 2 * block - available + n;
+        block = position / 2;
+        available = 0;
+        if(position % 2) {
+            generate();
+            available = 1;
+        }
+    }
+
+    // Uniform in [0, 1) with 53 random bits
+    double uniform() { return ((*this)() >> 11) * 0x1.0p-53; }
+
+    // Uniform in [0, n), unbiased (Lemire's multiply-and-reject)
+    uint64_t below(uint64_t n) {
+        __uint128_t m = (__uint128_t)(*this)() * n;
+        uint64_t low = (uint64_t)m;
+        if(low < n) {
+            uint64_t threshold = -n % n;
+            while(low < threshold) {
+                m = (__uint128_t)(*this)() * n;
+                low = (uint64_t)m;
+            }
+        }
+        return m >> 64;
+    }
+
+    uint64_t get_stream() const { return stream; }
+};
+
+// Process-wide seed: PLANCK_SEED when set (reproducible runs and replays),
+// otherwise drawn once from random_device
+inline uint64_t rng_default_seed() {
+    static const uint64_t seed = [] {
+        if(const char* text = getenv("PLANCK_SEED")) return (uint64_t)strtoull(text, nullptr, 0);
+        random_device rd;
+        return (uint64_t)rd() << 32 | rd();
+    }();
+    return seed;
+}
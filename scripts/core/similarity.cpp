@@ -0,0 +1,27 @@
+/*
+ * Similarity - Vector similarity shared by the vectorizer and the RL engine
+ */
+
+#include <cmath>
+#include "similarity.h"
+#include "metrics.h"
+
+using namespace std;
+
+double cosine_similarity(const double* v1, const double* v2, size_t n) {
+    PLANCK_COUNT(SIMILARITY_COMPARISONS, 1);
+    double dot = 0.0, mag1 = 0.0, mag2 = 0.0;
+    for(size_t i = 0; i < n; i++) {
+        dot += v1[i] * v2[i];
+        mag1 += v1[i] * v1[i];
+        mag2 += v2[i] * v2[i];
+    }
+
+    double denom = sqrt(mag1) * sqrt(mag2);
+    return denom > 1e-9 ? dot / denom : 0.0;
+}
+
+double cosine_similarity(const vector<double>& v1, const vector<double>& v2) {
+    if(v1.size() != v2.size()) return 0.0;
+    return cosine_similarity(v1.data(), v2.data(), v1.size());
+}
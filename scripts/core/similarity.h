@@ -0,0 +1,16 @@
+/*
+ * Similarity - Vector similarity shared by the vectorizer and the RL engine
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+// Cosine of the angle between v1 and v2; 0 when either is (near) zero
+double cosine_similarity(const double* v1, const double* v2, size_t n);
+
+// Vectors of different lengths are treated as dissimilar
+double cosine_similarity(const vector<double>& v1, const vector<double>& v2);
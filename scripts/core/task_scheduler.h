@@ -0,0 +1,108 @@
+/*
+ * Task Scheduler - Persistent worker pool for data-parallel compiler passes
+ * parallel_for(count, body) runs body(0..count-1) on the pool and the calling
+ * thread, handing out indices from one atomic counter, and returns when all
+ * have finished. Workers sleep between calls, so passes that issue one
+ * parallel_for per DAG layer pay a wake-up rather than a thread start. The
+ * first exception thrown by body is rethrown to the caller once the others
+ * have stopped. Calls must not nest (body may not call parallel_for).
+ */
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+class TaskScheduler {
+private:
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake, finished;
+    size_t generation = 0;    // Bumped once per parallel_for
+    unsigned active = 0;      // Workers still inside the current call
+    bool stopping = false;
+
+    const function<void(size_t)>* body = nullptr;
+    size_t count = 0;
+    atomic<size_t> next{0};
+    atomic<bool> failed{false};
+    exception_ptr error;
+
+    void run_tasks() {
+        for(size_t i = next++; i < count && !failed; i = next++) {
+            try {
+                (*body)(i);
+            } catch(...) {
+                if(!failed.exchange(true)) error = current_exception();
+            }
+        }
+    }
+
+    void worker_loop() {
+        size_t seen = 0;
+        unique_lock<mutex> guard(lock);
+        for(;;) {
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if(stopping) return;
+            seen = generation;
+            guard.unlock();
+            run_tasks();
+            guard.lock();
+            if(--active == 0) finished.notify_one();
+        }
+    }
+
+public:
+    // threads counts the caller; 0 = hardware concurrency
+    explicit TaskScheduler(unsigned threads = 0) {
+        unsigned total = threads ? threads : max(1u, thread::hardware_concurrency());
+        for(unsigned t = 1; t < total; t++) workers.emplace_back([this] { worker_loop(); });
+    }
+
+    ~TaskScheduler() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(thread& worker : workers) worker.join();
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    unsigned size() const { return workers.size() + 1; }
+
+    void parallel_for(size_t tasks, const function<void(size_t)>& task) {
+        if(tasks == 0) return;
+        if(workers.empty() || tasks == 1) {
+            for(size_t i = 0; i < tasks; i++) task(i);
+            return;
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            body = &task;
+            count = tasks;
+            next = 0;
+            failed = false;
+            error = nullptr;
+            active = workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        run_tasks();
+
+        unique_lock<mutex> guard(lock);
+        finished.wait(guard, [&] { return active == 0; });
+        body = nullptr;
+        if(error) rethrow_exception(error);
+    }
+};
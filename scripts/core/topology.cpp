@@ -0,0 +1,84 @@
+/*
+ * QPU Topologies - Coupling maps of the supported processors
+ */
+
+#include "topology.h"
+
+using namespace std;
+
+static void build_heavy_hex(int n, vector<pair<int, int>>& edges) {
+    // Simplified IBM heavy-hex topology
+    // Each qubit connects to 2-3 neighbors in hexagonal pattern
+    for(int i = 0; i < n - 1; i++) {
+        edges.push_back({i, i + 1});
+        if(i % 3 == 0 && i + 3 < n) edges.push_back({i, i + 3});
+    }
+
+    // Add diagonal connections for heavy-hex
+    for(int i = 0; i < n - 4; i += 3) {
+        if(i + 4 < n) edges.push_back({i, i + 4});
+    }
+}
+
+static void build_ring_topology(int n, vector<pair<int, int>>& edges) {
+    // Rigetti ring with local connections
+    for(int i = 0; i < n; i++) {
+        edges.push_back({i, (i + 1) % n});
+        if(i < n - 2) edges.push_back({i, i + 2});
+    }
+}
+
+static void build_all_to_all(int n, vector<pair<int, int>>& edges) {
+    // IonQ full connectivity
+    for(int i = 0; i < n; i++) {
+        for(int j = i + 1; j < n; j++) {
+            edges.push_back({i, j});
+        }
+    }
+}
+
+bool parse_qpu_type(const string& name, QPUType& type) {
+    if(name == "ibm") type = QPUType::IBM_FALCON;
+    else if(name == "rigetti") type = QPUType::RIGETTI_ASPEN;
+    else if(name == "ionq") type = QPUType::IONQ_ARIA;
+    else return false;
+    return true;
+}
+
+int qpu_qubit_count(QPUType type) {
+    switch(type) {
+        case QPUType::IBM_FALCON: return 27;
+        case QPUType::RIGETTI_ASPEN: return 40;
+        case QPUType::IONQ_ARIA: return 25;
+    }
+    return 0;
+}
+
+string qpu_topology_name(QPUType type) {
+    switch(type) {
+        case QPUType::IBM_FALCON: return "IBM Falcon (Heavy-Hex)";
+        case QPUType::RIGETTI_ASPEN: return "Rigetti Aspen (Ring)";
+        case QPUType::IONQ_ARIA: return "IonQ Aria (All-to-All)";
+    }
+    return "Unknown";
+}
+
+string qpu_hardware_name(QPUType type) {
+    switch(type) {
+        case QPUType::IBM_FALCON: return "ibm_falcon";
+        case QPUType::RIGETTI_ASPEN: return "rigetti_aspen";
+        case QPUType::IONQ_ARIA: return "ionq_aria";
+    }
+    return "unknown";
+}
+
+vector<pair<int, int>> qpu_coupling_map(QPUType type) {
+    vector<pair<int, int>> edges;
+    int n = qpu_qubit_count(type);
+    switch(type) {
+        case QPUType::IBM_FALCON: build_heavy_hex(n, edges); break;
+        case QPUType::RIGETTI_ASPEN: build_ring_topology(n, edges); break;
+        case QPUType::IONQ_ARIA: build_all_to_all(n, edges); break;
+    }
+    return edges;
+}
@@ -0,0 +1,32 @@
+/*
+ * QPU Topologies - Coupling maps of the supported processors
+ * Single definition used by the transpiler and the hardware database.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+// QPU topology definitions
+enum class QPUType {
+    IBM_FALCON,      // 27-qubit heavy-hex topology
+    RIGETTI_ASPEN,   // 40-qubit ring topology
+    IONQ_ARIA        // 25-qubit all-to-all connectivity
+};
+
+// Accepts the CLI names "ibm", "rigetti" and "ionq"
+bool parse_qpu_type(const string& name, QPUType& type);
+
+int qpu_qubit_count(QPUType type);
+
+string qpu_topology_name(QPUType type);
+
+// Key of the processor in QuantumHardwareDatabase ("ibm_falcon", ...)
+string qpu_hardware_name(QPUType type);
+
+// Undirected edges
+vector<pair<int, int>> qpu_coupling_map(QPUType type);
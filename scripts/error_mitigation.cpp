@@ -1,225 +1,49 @@
-"""
-Quantum Error Mitigation Module
-Implements realistic error mitigation strategies based on qubit count and noise levels
-"""
+/*
+ * Error Mitigation - Command line entry point
+ * Prints the mitigation report and a simplified configuration; given a counts
+ * JSON object, also prints the readout-mitigated counts. With --benchmark,
+ * first measures every level on the shipped algorithms under the device's
+ * noise and prints the report with the measured table instead
+ * (see error_mitigation.h for ErrorMitigator itself, mitigation_benchmark.h
+ * for the Monte-Carlo benchmark)
+ */
 
 #include <iostream>
-#include <vector>
-#include <cmath>
-#include <random>
-#include <map>
-#include <string>
-#include <algorithm>
-#include <nlohmann/json.hpp>
+#include "error_mitigation.h"
+#include "mitigation_benchmark.h"
+#include "core/arena.h"
 
-using json = nlohmann::json;
 using namespace std;
 
-// Error mitigation strategies
-enum class MitigationLevel {
-    NONE,
-    LOW,
-    MEDIUM,
-    HIGH
-};
+// --benchmark <algorithms_dir> <qubits> <level> [shots] [hardware]
+static int run_benchmark(int argc, char* argv[]) {
+    try {
+        MitigationBenchmarkOptions options;
+        if(argc > 5) options.shots = options.calibration_shots = stoul(argv[5]);
+        QuantumHardwareDatabase db;
+        NoiseModel noise = NoiseModel::from_hardware(db.get_hardware(argc > 6 ? argv[6] : "ibm_falcon"));
+        vector<MitigationMeasurement> rows = MitigationBenchmark(noise, options).run(load_algorithm_circuits(argv[2]));
 
-struct QubitConfig {
-    int logical_qubits;
-    int physical_qubits;
-    double base_error_rate;
-    double measurement_error;
-    double gate_error;
-};
-
-class ErrorMitigator {
-private:
-    MitigationLevel level;
-    QubitConfig config;
-    random_device rd;
-    mt19937 gen;
-    
-    // Calculate physical qubit overhead based on mitigation level
-    int calculatePhysicalQubits(int logical_qubits) {
-        switch(level) {
-            case MitigationLevel::NONE:
-                return logical_qubits;
-            case MitigationLevel::LOW:
-                // Simple repetition code: 2x overhead
-                return logical_qubits * 2;
-            case MitigationLevel::MEDIUM:
-                // Steane code: 5x overhead
-                return logical_qubits * 5;
-            case MitigationLevel::HIGH:
-                // Surface code: ~10x overhead for logical error rate 10^-3
-                return logical_qubits * 10;
-            default:
-                return logical_qubits;
-        }
-    }
-    
-    // Calculate effective error rate after mitigation
-    double calculateEffectiveErrorRate(double base_rate) {
-        switch(level) {
-            case MitigationLevel::NONE:
-                return base_rate;
-            case MitigationLevel::LOW:
-                // Majority voting reduces error rate
-                return base_rate * base_rate;  // ~O(p^2)
-            case MitigationLevel::MEDIUM:
-                // Steane code: O(p^3)
-                return pow(base_rate, 3);
-            case MitigationLevel::HIGH:
-                // Surface code with higher threshold
-                return pow(base_rate, 5);
-            default:
-                return base_rate;
-        }
-    }
-    
-public:
-    ErrorMitigator(int logical_qubits, MitigationLevel lvl, double base_error = 0.001)
-        : level(lvl), gen(rd()) {
-        
-        config.logical_qubits = logical_qubits;
-        config.physical_qubits = calculatePhysicalQubits(logical_qubits);
-        config.base_error_rate = base_error;
-        config.gate_error = calculateEffectiveErrorRate(base_error);
-        config.measurement_error = calculateEffectiveErrorRate(base_error * 2);
-    }
-    
-    // Zero-noise extrapolation
-    vector<double> zeroNoiseExtrapolation(const vector<double>& noisy_results, 
-                                          const vector<double>& noise_factors) {
-        // Fit polynomial and extrapolate to zero noise
-        vector<double> extrapolated = noisy_results;
-        
-        if (level >= MitigationLevel::MEDIUM) {
-            // Apply Richardson extrapolation
-            for(size_t i = 0; i < noisy_results.size(); i++) {
-                double correction = 0.0;
-                for(size_t j = 0; j < noise_factors.size(); j++) {
-                    correction += (noisy_results[i] - noisy_results[j]) / 
-                                 (1.0 - noise_factors[j] / noise_factors[i]);
-                }
-                extrapolated[i] += correction * 0.1;  // Damped correction
-            }
-        }
-        
-        return extrapolated;
-    }
-    
-    // Probabilistic error cancellation
-    map<string, double> probabilisticErrorCancellation(
-        const map<string, double>& raw_counts, int total_shots) {
-        
-        map<string, double> mitigated_counts = raw_counts;
-        
-        if (level >= MitigationLevel::LOW) {
-            // Build calibration matrix (simplified)
-            double fidelity = 1.0 - config.measurement_error;
-            
-            for (auto& [bitstring, count] : mitigated_counts) {
-                // Apply inverse calibration
-                double correction_factor = 1.0 / fidelity;
-                mitigated_counts[bitstring] = count * correction_factor;
-            }
-            
-            // Renormalize
-            double total = 0.0;
-            for (const auto& [bs, count] : mitigated_counts) {
-                total += count;
-            }
-            for (auto& [bs, count] : mitigated_counts) {
-                count = (count / total) * total_shots;
-            }
-        }
-        
-        return mitigated_counts;
-    }
-    
-    // Dynamical decoupling sequence insertion
-    int insertDecouplingSequences(int circuit_depth) {
-        if (level < MitigationLevel::MEDIUM) {
-            return 0;
-        }
-        
-        // Insert XY-4 or CPMG sequences between gates
-        int num_sequences = circuit_depth / 5;  // Every 5 gate layers
-        return num_sequences;
-    }
-    
-    // Calculate expected fidelity improvement
-    double calculateFidelityImprovement(int circuit_depth, int num_gates) {
-        double base_fidelity = pow(1.0 - config.base_error_rate, num_gates);
-        double mitigated_fidelity = pow(1.0 - config.gate_error, num_gates);
-        
-        // Account for measurement errors
-        base_fidelity *= (1.0 - config.measurement_error * 2);
-        mitigated_fidelity *= (1.0 - config.measurement_error);
-        
-        return mitigated_fidelity / base_fidelity;
-    }
-    
-    // Generate mitigation report
-    json generateReport() {
-        json report;
-        
-        report["mitigation_level"] = [this]() {
-            switch(level) {
-                case MitigationLevel::NONE: return "none";
-                case MitigationLevel::LOW: return "low";
-                case MitigationLevel::MEDIUM: return "medium";
-                case MitigationLevel::HIGH: return "high";
-                default: return "unknown";
-            }
-        }();
-        
-        report["config"] = {
-            {"logical_qubits", config.logical_qubits},
-            {"physical_qubits", config.physical_qubits},
-            {"overhead_factor", (double)config.physical_qubits / config.logical_qubits},
-            {"base_error_rate", config.base_error_rate},
-            {"effective_gate_error", config.gate_error},
-            {"effective_measurement_error", config.measurement_error}
-        };
-        
-        report["techniques"] = json::array();
-        if (level >= MitigationLevel::LOW) {
-            report["techniques"].push_back("Readout error mitigation");
-            report["techniques"].push_back("Probabilistic error cancellation");
-        }
-        if (level >= MitigationLevel::MEDIUM) {
-            report["techniques"].push_back("Zero-noise extrapolation");
-            report["techniques"].push_back("Dynamical decoupling");
-        }
-        if (level >= MitigationLevel::HIGH) {
-            report["techniques"].push_back("Surface code error correction");
-            report["techniques"].push_back("Syndrome extraction");
-        }
-        
-        return report;
+        ErrorMitigator mitigator(stoi(argv[3]), parse_mitigation_level(argv[4]));
+        mitigator.setMeasurements(rows);
+        cout << mitigator.generateReport() << endl;
+    } catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
     }
-};
-
-// Error Mitigation - Simplified configuration generator
-
-double calculate_overhead(const std::string& level) {
-    if(level == "low") return 2.0;
-    if(level == "medium") return 5.0;
-    if(level == "high") return 10.0;
-    return 1.0;
-}
-
-double calculate_error_rate(const std::string& level, double base) {
-    if(level == "low") return base * base;
-    if(level == "medium") return std::pow(base, 3);
-    if(level == "high") return std::pow(base, 5);
-    return base;
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
+    if(argc > 1 && string(argv[1]) == "--benchmark") {
+        if(argc < 5) {
+            cerr << "Usage: " << argv[0] << " --benchmark <algorithms_dir> <qubits> <level> [shots] [hardware]" << endl;
+            return 1;
+        }
+        return run_benchmark(argc, argv);
+    }
     if(argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " <qubits> <level>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <qubits> <level> [counts_json]" << std::endl;
         return 1;
     }
     
@@ -227,23 +51,31 @@ int main(int argc, char* argv[]) {
     std::string level_str = argv[2];
     double base_error = 0.001;
     
-    MitigationLevel level = MitigationLevel::NONE;
-    if (level_str == "low") level = MitigationLevel::LOW;
-    else if (level_str == "medium") level = MitigationLevel::MEDIUM;
-    else if (level_str == "high") level = MitigationLevel::HIGH;
+    MitigationLevel level = parse_mitigation_level(level_str);
     
     ErrorMitigator mitigator(qubits, level);
-    json report = mitigator.generateReport();
-    
-    cout << report.dump(2) << endl;
+    cout << mitigator.generateReport() << endl;
     
     // Simplified configuration output
     cout << "{"
           << "\"mitigation_level\":\"" << level_str << "\","
           << "\"logical_qubits\":" << qubits << ","
-          << "\"physical_qubits\":" << (int)(qubits * calculate_overhead(level_str)) << ","
-          << "\"effective_error\":" << calculate_error_rate(level_str, base_error)
+          << "\"physical_qubits\":" << qubits * mitigation_qubit_overhead(level) << ","
+          << "\"effective_error\":" << mitigated_error_rate(level, base_error)
           << "}" << endl;
+
+    if(argc > 3) {
+        try {
+            RequestArena arena;
+            CountTable counts = CountTable::from_json(argv[3], -1, arena.resource());
+            string out;
+            mitigator.mitigateReadout(counts).write_json(out);
+            cout << out << endl;
+        } catch(const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
     
     return 0;
 }
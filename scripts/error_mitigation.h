@@ -0,0 +1,218 @@
+/*
+ * Quantum Error Mitigation Module
+ * Implements realistic error mitigation strategies based on qubit count and noise levels
+ */
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <sstream>
+
+#include "core/mitigation_model.h"
+#include "shot_results.h"
+
+using namespace std;
+
+struct QubitConfig {
+    int logical_qubits;
+    int physical_qubits;
+    double base_error_rate;
+    double measurement_error;
+    double gate_error;
+};
+
+class ErrorMitigator {
+private:
+    MitigationLevel level;
+    QubitConfig config;
+    vector<double> readout_flip;  // Reused per call
+    vector<MitigationMeasurement> measurements;  // From a MitigationBenchmark run, if attached
+    
+    const MitigationMeasurement* measured() const {
+        for (const auto& row : measurements) {
+            if (row.level == level) return &row;
+        }
+        return nullptr;
+    }
+    
+    // Calculate physical qubit overhead based on mitigation level
+    int calculatePhysicalQubits(int logical_qubits) {
+        return logical_qubits * mitigation_qubit_overhead(level);
+    }
+    
+    // Calculate effective error rate after mitigation
+    double calculateEffectiveErrorRate(double base_rate) {
+        return mitigated_error_rate(level, base_rate);
+    }
+    
+public:
+    ErrorMitigator(int logical_qubits, MitigationLevel lvl, double base_error = 0.001)
+        : level(lvl) {
+        
+        config.logical_qubits = logical_qubits;
+        config.physical_qubits = calculatePhysicalQubits(logical_qubits);
+        config.base_error_rate = base_error;
+        config.gate_error = calculateEffectiveErrorRate(base_error);
+        config.measurement_error = calculateEffectiveErrorRate(base_error * 2);
+    }
+    
+    // Zero-noise extrapolation
+    vector<double> zeroNoiseExtrapolation(const vector<double>& noisy_results, 
+                                          const vector<double>& noise_factors) {
+        PLANCK_TIME_STAGE(MITIGATE);
+        // Fit polynomial and extrapolate to zero noise
+        vector<double> extrapolated = noisy_results;
+        
+        if (level >= MitigationLevel::MEDIUM) {
+            // Apply Richardson extrapolation
+            for(size_t i = 0; i < noisy_results.size(); i++) {
+                double correction = 0.0;
+                for(size_t j = 0; j < noise_factors.size(); j++) {
+                    correction += (noisy_results[i] - noisy_results[j]) / 
+                                 (1.0 - noise_factors[j] / noise_factors[i]);
+                }
+                extrapolated[i] += correction * 0.1;  // Damped correction
+            }
+        }
+        
+        return extrapolated;
+    }
+    
+    // Probabilistic error cancellation
+    map<string, double> probabilisticErrorCancellation(
+        const map<string, double>& raw_counts, int total_shots) {
+        PLANCK_TIME_STAGE(MITIGATE);
+        map<string, double> mitigated_counts = raw_counts;
+        
+        if (level >= MitigationLevel::LOW) {
+            // Build calibration matrix (simplified)
+            double fidelity = 1.0 - config.measurement_error;
+            
+            for (auto& [bitstring, count] : mitigated_counts) {
+                // Apply inverse calibration
+                double correction_factor = 1.0 / fidelity;
+                mitigated_counts[bitstring] = count * correction_factor;
+            }
+            
+            // Renormalize
+            double total = 0.0;
+            for (const auto& [bs, count] : mitigated_counts) {
+                total += count;
+            }
+            for (auto& [bs, count] : mitigated_counts) {
+                count = (count / total) * total_shots;
+            }
+        }
+        
+        return mitigated_counts;
+    }
+
+    // Same as above on the packed count view. Results are allocated from the
+    // input's memory resource, so a job built on a RequestArena stays in it.
+    CountTable probabilisticErrorCancellation(const CountTable& raw_counts, int total_shots) {
+        PLANCK_TIME_STAGE(MITIGATE);
+        if (level < MitigationLevel::LOW) return CountTable(raw_counts, raw_counts.resource());
+
+        double total = raw_counts.total();
+        CountTable mitigated_counts(raw_counts.get_num_qubits(), raw_counts.size(), raw_counts.resource());
+        raw_counts.for_each([&](uint64_t outcome, double count) {
+            mitigated_counts.add(outcome, count / total * total_shots);
+        });
+        return mitigated_counts;
+    }
+
+    // Readout error mitigation: inverts a symmetric per-qubit confusion
+    // matrix with the configured measurement error
+    CountTable mitigateReadout(const CountTable& raw_counts) {
+        if (level < MitigationLevel::LOW) return CountTable(raw_counts, raw_counts.resource());
+
+        readout_flip.assign(raw_counts.get_num_qubits(), config.measurement_error);
+        return mitigate_readout(raw_counts, readout_flip, readout_flip);
+    }
+    
+    // Dynamical decoupling sequence insertion
+    int insertDecouplingSequences(int circuit_depth) {
+        if (level < MitigationLevel::MEDIUM) {
+            return 0;
+        }
+        
+        // Insert XY-4 or CPMG sequences between gates
+        int num_sequences = circuit_depth / 5;  // Every 5 gate layers
+        return num_sequences;
+    }
+    
+    // Replaces the closed-form estimates with measured rows
+    void setMeasurements(const vector<MitigationMeasurement>& rows) {
+        measurements = rows;
+    }
+    
+    // Calculate expected fidelity improvement: the measured gain when a
+    // benchmark is attached, otherwise the closed-form estimate
+    double calculateFidelityImprovement(int circuit_depth, int num_gates) {
+        if (const MitigationMeasurement* row = measured()) return row->fidelity_gain;
+        double base_fidelity = pow(1.0 - config.base_error_rate, num_gates);
+        double mitigated_fidelity = pow(1.0 - config.gate_error, num_gates);
+        
+        // Account for measurement errors
+        base_fidelity *= (1.0 - config.measurement_error * 2);
+        mitigated_fidelity *= (1.0 - config.measurement_error);
+        
+        return mitigated_fidelity / base_fidelity;
+    }
+    
+    // Generate mitigation report (pretty-printed JSON)
+    string generateReport() {
+        vector<string> techniques;
+        if (level >= MitigationLevel::LOW) {
+            techniques.push_back("Readout error mitigation");
+            techniques.push_back("Probabilistic error cancellation");
+        }
+        if (level >= MitigationLevel::MEDIUM) {
+            techniques.push_back("Zero-noise extrapolation");
+            techniques.push_back("Dynamical decoupling");
+        }
+        if (level >= MitigationLevel::HIGH) {
+            techniques.push_back("Surface code error correction");
+            techniques.push_back("Syndrome extraction");
+        }
+        
+        ostringstream report;
+        report << "{\n";
+        if (!measurements.empty()) {
+            report << "  \"benchmark\": [";
+            for (size_t i = 0; i < measurements.size(); i++) {
+                const MitigationMeasurement& row = measurements[i];
+                report << (i > 0 ? "," : "") << "\n    {\"fidelity_gain\": " << row.fidelity_gain
+                       << ", \"level\": \"" << mitigation_level_name(row.level) << "\""
+                       << ", \"mitigated_fidelity\": " << row.mitigated_fidelity
+                       << ", \"raw_fidelity\": " << row.raw_fidelity
+                       << ", \"shot_overhead\": " << row.shot_overhead << "}";
+            }
+            report << "\n  ],\n";
+        }
+        report << "  \"config\": {\n"
+               << "    \"base_error_rate\": " << config.base_error_rate << ",\n"
+               << "    \"effective_gate_error\": " << config.gate_error << ",\n"
+               << "    \"effective_measurement_error\": " << config.measurement_error << ",\n"
+               << "    \"logical_qubits\": " << config.logical_qubits << ",\n";
+        if (const MitigationMeasurement* row = measured()) {
+            report << "    \"measured_fidelity_gain\": " << row->fidelity_gain << ",\n"
+                   << "    \"measured_shot_overhead\": " << row->shot_overhead << ",\n";
+        }
+        report << "    \"overhead_factor\": " << (double)config.physical_qubits / config.logical_qubits << ",\n"
+               << "    \"physical_qubits\": " << config.physical_qubits << "\n"
+               << "  },\n"
+               << "  \"mitigation_level\": \"" << mitigation_level_name(level) << "\",\n"
+               << "  \"techniques\": [";
+        for (size_t i = 0; i < techniques.size(); i++) {
+            report << (i > 0 ? "," : "") << "\n    \"" << techniques[i] << "\"";
+        }
+        report << (techniques.empty() ? "]" : "\n  ]") << "\n}";
+        return report.str();
+    }
+};
@@ -0,0 +1,234 @@
+/*
+ * JSON Scanner - Allocation-free reader for flat JSON records
+ * Scans one object per call (e.g. one NDJSON line) and hands each top-level
+ * key/value to a callback as string_views into the input buffer.
+ * Strings are scanned eight bytes at a time (SWAR) for quotes and escapes;
+ * numbers go through from_chars. Nested objects/arrays are skipped, not parsed.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace std;
+
+enum class JsonType {
+    STRING,
+    NUMBER,
+    BOOL,
+    NULL_VALUE,
+    OBJECT,
+    ARRAY
+};
+
+struct JsonValue {
+    JsonType type;
+    string_view text;   // Raw text; strings exclude quotes and are not unescaped
+    double number;
+    bool boolean;
+};
+
+class JsonScanner {
+private:
+    const char* p;
+    const char* end;
+
+    static constexpr uint64_t ONES = 0x0101010101010101ULL;
+    static constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+
+    // Non-zero iff some byte of word equals c
+    static uint64_t has_byte(uint64_t word, unsigned char c) {
+        uint64_t x = word ^ (ONES * c);
+        return (x - ONES) & ~x & HIGHS;
+    }
+
+    [[noreturn]] void fail(const char* what) const {
+        throw runtime_error(string("JSON parse error: ") + what);
+    }
+
+    void skip_ws() {
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    }
+
+    void expect(char c) {
+        skip_ws();
+        if(p >= end || *p != c) fail("unexpected character");
+        p++;
+    }
+
+    // p points just past the opening quote; returns the raw contents
+    string_view scan_string() {
+        const char* start = p;
+        while(true) {
+            // Skip eight bytes at a time while none is a quote or backslash
+            while(end - p >= 8) {
+                uint64_t word;
+                memcpy(&word, p, 8);
+                if(has_byte(word, '"') | has_byte(word, '\\')) break;
+                p += 8;
+            }
+            while(p < end && *p != '"' && *p != '\\') p++;
+            if(p >= end) fail("unterminated string");
+            if(*p == '"') break;
+            p += 2;  // Skip the escaped character
+        }
+        string_view text(start, p - start);
+        p++;
+        return text;
+    }
+
+    // Skips a nested object or array, respecting strings
+    string_view skip_nested() {
+        const char* start = p;
+        int depth = 0;
+        while(p < end) {
+            char c = *p++;
+            if(c == '"') {
+                scan_string();
+            } else if(c == '{' || c == '[') {
+                depth++;
+            } else if(c == '}' || c == ']') {
+                if(--depth == 0) return string_view(start, p - start);
+            }
+        }
+        fail("unterminated container");
+    }
+
+    JsonValue scan_value() {
+        skip_ws();
+        if(p >= end) fail("missing value");
+
+        JsonValue value{JsonType::NULL_VALUE, {}, 0.0, false};
+        char c = *p;
+        if(c == '"') {
+            p++;
+            value.type = JsonType::STRING;
+            value.text = scan_string();
+        } else if(c == '{' || c == '[') {
+            value.type = c == '{' ? JsonType::OBJECT : JsonType::ARRAY;
+            value.text = skip_nested();
+        } else if(c == 't' && end - p >= 4 && memcmp(p, "true", 4) == 0) {
+            value.type = JsonType::BOOL;
+            value.boolean = true;
+            value.text = string_view(p, 4);
+            p += 4;
+        } else if(c == 'f' && end - p >= 5 && memcmp(p, "false", 5) == 0) {
+            value.type = JsonType::BOOL;
+            value.text = string_view(p, 5);
+            p += 5;
+        } else if(c == 'n' && end - p >= 4 && memcmp(p, "null", 4) == 0) {
+            value.text = string_view(p, 4);
+            p += 4;
+        } else {
+            auto result = from_chars(p, end, value.number);
+            if(result.ec != errc()) fail("invalid number");
+            value.type = JsonType::NUMBER;
+            value.text = string_view(p, result.ptr - p);
+            p = result.ptr;
+        }
+        return value;
+    }
+
+public:
+    JsonScanner(string_view input) : p(input.data()), end(input.data() + input.size()) {}
+
+    // Calls on_field(key, value) for every top-level member of one object
+    template<typename F>
+    void scan_object(F&& on_field) {
+        expect('{');
+        skip_ws();
+        if(p < end && *p == '}') {
+            p++;
+            return;
+        }
+        while(true) {
+            expect('"');
+            string_view key = scan_string();
+            expect(':');
+            on_field(key, scan_value());
+            skip_ws();
+            if(p >= end) fail("unterminated object");
+            if(*p == ',') {
+                p++;
+                continue;
+            }
+            if(*p == '}') {
+                p++;
+                return;
+            }
+            fail("expected ',' or '}'");
+        }
+    }
+};
+
+// Decodes the escapes in a raw JSON string (as returned in JsonValue::text)
+inline void json_unescape(string_view text, string& out) {
+    out.clear();
+    out.reserve(text.size());
+    for(size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if(c != '\\' || i + 1 >= text.size()) {
+            out += c;
+            continue;
+        }
+        char e = text[++i];
+        switch(e) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                // Only the basic multilingual plane; encoded as UTF-8
+                if(i + 4 >= text.size()) throw runtime_error("JSON parse error: bad \\u escape");
+                unsigned code = stoul(string(text.substr(i + 1, 4)), nullptr, 16);
+                i += 4;
+                if(code < 0x80) {
+                    out += (char)code;
+                } else if(code < 0x800) {
+                    out += (char)(0xC0 | (code >> 6));
+                    out += (char)(0x80 | (code & 0x3F));
+                } else {
+                    out += (char)(0xE0 | (code >> 12));
+                    out += (char)(0x80 | ((code >> 6) & 0x3F));
+                    out += (char)(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default: out += e; break;  // \" \\ \/
+        }
+    }
+}
+
+// Encodes text for the inside of a JSON string: quotes, backslashes and
+// control characters
+inline string json_escape(string_view text) {
+    string out;
+    out.reserve(text.size());
+    for(char c : text) {
+        switch(c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if((unsigned char)c < 0x20) {
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+                    out += code;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,387 @@
+/*
+ * Mitigation Benchmark - Monte-Carlo measurement of each MitigationLevel
+ * Samples noisy executions of circuits on the local statevector simulator
+ * (a random Pauli after each gate with the device's gate error, symmetric
+ * readout flips; rates from a HardwareSpec) and applies the techniques each
+ * level can run against that model:
+ *
+ *     NONE    raw counts
+ *     LOW     readout mitigation with rates calibrated on |0..0> and |1..1>
+ *     MEDIUM  LOW + linear zero-noise extrapolation over noise scales {1, 3}
+ *     HIGH    LOW + quadratic extrapolation over scales {1, 3, 5}
+ *
+ * Noise scaling multiplies the gate error rates, standing in for unitary
+ * folding on hardware. Dynamical decoupling and the error-correcting codes
+ * have no counterpart in a gate-noise model and are not credited. Fidelity
+ * is the Hellinger fidelity of the measured qubits' distribution to the
+ * noiseless one; shot overhead counts every executed shot (calibration and
+ * scaled runs) per raw shot.
+ *
+ * Shots are split into fixed-size chunks, each drawing from its own
+ * RngStream keyed by (seed, run, chunk), and chunks are spread over all
+ * cores, so results depend on the seed but not on the thread count.
+ */
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+#include "core/mitigation_model.h"
+#include "core/rng.h"
+#include "quantum_hardware_benchmarks.h"
+#include "shot_results.h"
+#include "statevector.h"
+#include "qasm_reader.h"
+
+using namespace std;
+
+struct NoiseModel {
+    double single_qubit_error = 0.0;  // Pauli error probability per 1q gate
+    double two_qubit_error = 0.0;     // Per additional qubit of a multi-qubit gate
+    double readout_error = 0.0;       // Bit flip probability per measured qubit
+
+    static NoiseModel from_hardware(const HardwareSpec& hw) {
+        return {1.0 - hw.single_qubit_fidelity, 1.0 - hw.two_qubit_fidelity, 1.0 - hw.readout_fidelity};
+    }
+};
+
+struct BenchmarkCircuit {
+    string name;
+    vector<Gate> gates;
+    int num_qubits = 0;
+};
+
+inline BenchmarkCircuit benchmark_circuit_from_qasm(const string& name, const string& source) {
+    BenchmarkCircuit circuit;
+    circuit.name = name;
+    QasmReader reader;
+    reader.parse(source, [&](const QasmOp& op) {
+        if(op.name == "barrier") return;
+        Gate gate(op.name, op.qubits);
+        for(size_t i = 0; i < op.params.size(); i++) gate.parameters.emplace("p" + to_string(i), op.params[i]);
+        circuit.gates.push_back(move(gate));
+    });
+    circuit.num_qubits = reader.get_num_qubits();
+    return circuit;
+}
+
+// The shipped scripts/algorithms circuits that run on the simulator
+inline vector<BenchmarkCircuit> load_algorithm_circuits(const string& directory) {
+    vector<BenchmarkCircuit> circuits;
+    for(const char* name : {"bell_state", "grover_search", "qaoa_maxcut", "shor_period_finding", "vqe_ansatz"}) {
+        ifstream file(directory + "/" + name + ".qasm");
+        if(!file) throw runtime_error("Cannot read " + directory + "/" + name + ".qasm");
+        stringstream source;
+        source << file.rdbuf();
+        circuits.push_back(benchmark_circuit_from_qasm(name, source.str()));
+    }
+    return circuits;
+}
+
+// Trajectory sampler for one circuit. Shots without a sampled gate error,
+// the common case, draw from the cached noiseless distribution; the others
+// resume from the last cached noiseless state before their first error.
+class NoisySampler {
+private:
+    vector<Gate> gates;
+    vector<double> error_rate;         // Per gate at noise scale 1
+    vector<int> measured;              // Qubits read out; outcome bit i is measured[i]
+    NoiseModel noise;
+    int num_qubits;
+    vector<double> ideal;              // Over the measured qubits
+    vector<double> ideal_cumulative;
+    size_t stride;                     // Gates between cached states
+    vector<StatevectorSimulator> checkpoints;
+
+    static constexpr size_t CHECKPOINT_BYTES = size_t(64) << 20;
+
+    vector<double> measured_distribution(const StatevectorSimulator& sim) const {
+        const vector<Complex>& amplitudes = sim.get_amplitudes();
+        vector<double> p(size_t(1) << measured.size(), 0.0);
+        for(size_t x = 0; x < amplitudes.size(); x++) {
+            size_t key = 0;
+            for(size_t i = 0; i < measured.size(); i++) key |= ((x >> measured[i]) & 1) << i;
+            p[key] += norm(amplitudes[x]);
+        }
+        return p;
+    }
+
+    static void accumulate(vector<double>& p) {
+        for(size_t i = 1; i < p.size(); i++) p[i] += p[i - 1];
+    }
+
+    static uint64_t draw(const vector<double>& cumulative, double u) {
+        u *= cumulative.back();
+        size_t i = upper_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+        return min(i, cumulative.size() - 1);
+    }
+
+    // Uniformly random non-identity Pauli on the gate's qubits
+    static void apply_pauli(StatevectorSimulator& sim, const Gate& gate, RngStream& rng) {
+        static const Matrix2 paulis[4] = {identity2(),
+                                          {0.0, 1.0, 1.0, 0.0},
+                                          {0.0, Complex(0, -1), Complex(0, 1), 0.0},
+                                          {1.0, 0.0, 0.0, -1.0}};
+        uint64_t choices = (1ULL << (2 * gate.qubits.size())) - 1;
+        uint64_t pick = 1 + rng.below(choices);
+        for(size_t i = 0; i < gate.qubits.size(); i++, pick >>= 2) {
+            if(pick & 3) sim.apply(paulis[pick & 3], gate.qubits[i]);
+        }
+    }
+
+public:
+    NoisySampler(const vector<Gate>& circuit, int qubits, const NoiseModel& model)
+        : noise(model), num_qubits(qubits) {
+        for(const Gate& gate : circuit) {
+            if(gate.type == "measure") measured.insert(measured.end(), gate.qubits.begin(), gate.qubits.end());
+            else gates.push_back(gate);
+        }
+        sort(measured.begin(), measured.end());
+        measured.erase(unique(measured.begin(), measured.end()), measured.end());
+        if(measured.empty()) for(int q = 0; q < num_qubits; q++) measured.push_back(q);
+        if(measured.size() > 64) throw runtime_error("Benchmark circuits measure at most 64 qubits");
+
+        for(const Gate& gate : gates) {
+            size_t k = gate.qubits.size();
+            error_rate.push_back(k <= 1 ? noise.single_qubit_error : noise.two_qubit_error * (k - 1));
+        }
+
+        size_t state_bytes = (sizeof(Complex) << num_qubits);
+        size_t max_checkpoints = max<size_t>(1, CHECKPOINT_BYTES / state_bytes);
+        stride = max<size_t>(1, (gates.size() + max_checkpoints - 1) / max_checkpoints);
+        StatevectorSimulator sim(num_qubits);
+        for(size_t i = 0; i < gates.size(); i++) {
+            if(i % stride == 0) checkpoints.push_back(sim);
+            sim.apply(gates[i]);
+        }
+        ideal = measured_distribution(sim);
+        ideal_cumulative = ideal;
+        accumulate(ideal_cumulative);
+    }
+
+    // One shot at the given noise scale; outcome bit i is measured qubit i
+    uint64_t sample(RngStream& rng, double scale) const {
+        vector<size_t> errors;  // Stays unallocated for error-free shots
+        for(size_t i = 0; i < gates.size(); i++) {
+            if(rng.uniform() < error_rate[i] * scale) errors.push_back(i);
+        }
+
+        uint64_t outcome;
+        if(errors.empty()) outcome = draw(ideal_cumulative, rng.uniform());
+        else {
+            size_t start = errors[0] / stride;
+            StatevectorSimulator sim = checkpoints[start];
+            size_t next = 0;
+            for(size_t i = start * stride; i < gates.size(); i++) {
+                sim.apply(gates[i]);
+                if(next < errors.size() && errors[next] == i) {
+                    apply_pauli(sim, gates[i], rng);
+                    next++;
+                }
+            }
+            vector<double> p = measured_distribution(sim);
+            accumulate(p);
+            outcome = draw(p, rng.uniform());
+        }
+        for(size_t i = 0; i < measured.size(); i++) {
+            if(rng.uniform() < noise.readout_error) outcome ^= 1ULL << i;
+        }
+        return outcome;
+    }
+
+    int get_num_measured() const { return measured.size(); }
+    const vector<double>& get_ideal() const { return ideal; }
+};
+
+// Weights w_k with sum_k w_k f(s_k) = f(0) for f polynomial of degree
+// scales.size() - 1
+inline vector<double> richardson_weights(const vector<double>& scales) {
+    vector<double> weights(scales.size(), 1.0);
+    for(size_t k = 0; k < scales.size(); k++) {
+        for(size_t j = 0; j < scales.size(); j++) {
+            if(j != k) weights[k] *= scales[j] / (scales[j] - scales[k]);
+        }
+    }
+    return weights;
+}
+
+// Hellinger fidelity (sum_x sqrt(p_x q_x))^2 of a quasi-distribution, with
+// negative entries clipped and the rest renormalised, to an ideal one
+inline double hellinger_fidelity(const CountTable& counts, const vector<double>& ideal) {
+    double positive = 0.0, overlap = 0.0;
+    counts.for_each([&](uint64_t, double count) { if(count > 0) positive += count; });
+    if(positive <= 0) return 0.0;
+    counts.for_each([&](uint64_t key, double count) {
+        if(count > 0 && key < ideal.size()) overlap += sqrt(count / positive * ideal[key]);
+    });
+    return overlap * overlap;
+}
+
+struct MitigationBenchmarkOptions {
+    size_t shots = 2000;              // Per circuit and noise scale
+    size_t calibration_shots = 2000;  // Per calibration state
+    size_t chunk = 250;               // Shots per RNG stream
+    unsigned threads = 0;             // 0 = hardware concurrency
+    uint64_t seed = 1;
+};
+
+class MitigationBenchmark {
+private:
+    NoiseModel noise;
+    MitigationBenchmarkOptions options;
+
+    static constexpr double SCALES[3] = {1.0, 3.0, 5.0};
+
+    struct Run {
+        const NoisySampler* sampler;
+        double scale;
+        size_t shots;
+        CountTable counts;
+    };
+
+    // Samples every run, chunk by chunk, on all cores
+    void sample(vector<Run>& runs) const {
+        vector<pair<size_t, size_t>> jobs;  // (run, chunk)
+        for(size_t r = 0; r < runs.size(); r++) {
+            for(size_t c = 0; c * options.chunk < runs[r].shots; c++) jobs.push_back({r, c});
+        }
+        vector<CountTable> chunks(jobs.size());
+
+        atomic<size_t> next(0);
+        atomic<bool> failed(false);
+        exception_ptr error;
+        auto work = [&]() {
+            for(size_t j = next++; j < jobs.size() && !failed; j = next++) {
+                try {
+                    const Run& run = runs[jobs[j].first];
+                    RngStream rng(options.seed, (uint64_t)jobs[j].first << 32 | jobs[j].second);
+                    size_t begin = jobs[j].second * options.chunk;
+                    size_t end = min(run.shots, begin + options.chunk);
+                    CountTable counts(run.sampler->get_num_measured());
+                    for(size_t s = begin; s < end; s++) counts.add(run.sampler->sample(rng, run.scale), 1.0);
+                    chunks[j] = move(counts);
+                } catch(...) {
+                    if(!failed.exchange(true)) error = current_exception();
+                }
+            }
+        };
+        unsigned count = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+        count = min<size_t>(count, max<size_t>(1, jobs.size()));
+        vector<thread> workers;
+        for(unsigned t = 1; t < count; t++) workers.emplace_back(work);
+        work();
+        for(thread& worker : workers) worker.join();
+        if(error) rethrow_exception(error);
+
+        for(size_t j = 0; j < jobs.size(); j++) {
+            Run& run = runs[jobs[j].first];
+            chunks[j].for_each([&](uint64_t key, double n) { run.counts.add(key, n); });
+        }
+    }
+
+    static CountTable extrapolate(const vector<CountTable>& tables, const vector<double>& scales) {
+        vector<double> weights = richardson_weights(scales);
+        CountTable result(tables[0].get_num_qubits());
+        for(size_t k = 0; k < scales.size(); k++) {
+            double total = tables[k].total();
+            tables[k].for_each([&](uint64_t key, double count) { result.add(key, weights[k] * count / total); });
+        }
+        return result;
+    }
+
+public:
+    MitigationBenchmark(const NoiseModel& model, MitigationBenchmarkOptions opts = MitigationBenchmarkOptions())
+        : noise(model), options(opts) {
+        if(options.chunk == 0) options.chunk = 1;
+    }
+
+    // One row per level, fidelities averaged over circuits. circuit_rows, if
+    // given, receives the per-circuit fidelities in level order.
+    vector<MitigationMeasurement> run(const vector<BenchmarkCircuit>& circuits,
+                                      vector<array<double, 4>>* circuit_rows = nullptr) const {
+        if(circuits.empty()) throw runtime_error("Mitigation benchmark needs at least one circuit");
+        vector<NoisySampler> samplers;
+        samplers.reserve(circuits.size() * 3);
+        for(const BenchmarkCircuit& circuit : circuits) {
+            samplers.emplace_back(circuit.gates, circuit.num_qubits, noise);
+            int measured = samplers.back().get_num_measured();
+            // Calibration states on the measured qubits only
+            vector<Gate> zeros, ones;
+            for(int q = 0; q < measured; q++) {
+                zeros.push_back(Gate("measure", {q}));
+                ones.push_back(Gate("x", {q}));
+                ones.push_back(Gate("measure", {q}));
+            }
+            samplers.emplace_back(zeros, measured, noise);
+            samplers.emplace_back(ones, measured, noise);
+        }
+
+        // Per circuit: scales 1, 3, 5 then the two calibration states
+        vector<Run> runs;
+        for(size_t c = 0; c < circuits.size(); c++) {
+            int measured = samplers[3 * c].get_num_measured();
+            for(double scale : SCALES) runs.push_back({&samplers[3 * c], scale, options.shots, CountTable(measured)});
+            for(int state = 1; state <= 2; state++) {
+                runs.push_back({&samplers[3 * c + state], 1.0, options.calibration_shots, CountTable(measured)});
+            }
+        }
+        sample(runs);
+
+        array<double, 4> raw_sum{}, mitigated_sum{};
+        if(circuit_rows) circuit_rows->clear();
+        for(size_t c = 0; c < circuits.size(); c++) {
+            const Run* r = &runs[5 * c];
+            int measured = samplers[3 * c].get_num_measured();
+            vector<double> p01(measured, 0.0), p10(measured, 0.0);
+            r[3].counts.for_each([&](uint64_t key, double n) {
+                for(int q = 0; q < measured; q++) if((key >> q) & 1) p01[q] += n;
+            });
+            r[4].counts.for_each([&](uint64_t key, double n) {
+                for(int q = 0; q < measured; q++) if(!((key >> q) & 1)) p10[q] += n;
+            });
+            for(int q = 0; q < measured; q++) {
+                p01[q] /= r[3].counts.total();
+                p10[q] /= r[4].counts.total();
+            }
+
+            vector<CountTable> corrected;
+            for(int s = 0; s < 3; s++) corrected.push_back(mitigate_readout(r[s].counts, p01, p10));
+            CountTable linear = extrapolate({corrected[0], corrected[1]}, {SCALES[0], SCALES[1]});
+            CountTable quadratic = extrapolate(corrected, {SCALES[0], SCALES[1], SCALES[2]});
+
+            const vector<double>& ideal = samplers[3 * c].get_ideal();
+            double raw = hellinger_fidelity(r[0].counts, ideal);
+            array<double, 4> fidelity = {raw, hellinger_fidelity(corrected[0], ideal),
+                                         hellinger_fidelity(linear, ideal), hellinger_fidelity(quadratic, ideal)};
+            for(int l = 0; l < 4; l++) {
+                raw_sum[l] += raw;
+                mitigated_sum[l] += fidelity[l];
+            }
+            if(circuit_rows) circuit_rows->push_back(fidelity);
+        }
+
+        vector<MitigationMeasurement> rows;
+        double calibration = 2.0 * options.calibration_shots / options.shots;
+        double scale_runs[4] = {1, 1, 2, 3};
+        for(int l = 0; l < 4; l++) {
+            MitigationMeasurement row;
+            row.level = (MitigationLevel)l;
+            row.raw_fidelity = raw_sum[l] / circuits.size();
+            row.mitigated_fidelity = mitigated_sum[l] / circuits.size();
+            row.fidelity_gain = row.raw_fidelity > 0 ? row.mitigated_fidelity / row.raw_fidelity : 0.0;
+            row.shot_overhead = scale_runs[l] + (l > 0 ? calibration : 0.0);
+            rows.push_back(row);
+        }
+        return rows;
+    }
+};
@@ -1,157 +1,142 @@
 /*
- * ML Feature Vectorizer - High-performance C++ implementation
- * Converts quantum circuit parameters into normalized feature vectors
- * for reinforcement learning and similarity search
+ * ML Feature Vectorizer - Command line entry point
+ * Vectorizes a single circuit description passed as JSON, or a stream of
+ * NDJSON records in batch mode. Given the circuit's QASM (--qasm, or a "qasm"
+ * field with --extended), it emits the extended version 2 layout.
+ * (see ml_feature_vectorizer.h for the vectorizer itself)
+ *
+ * Batch output formats:
+ *   json    one JSON array per input line (null for malformed records)
+ *   binary  "PFVM", uint32 columns, then float32 rows (row-major); the row
+ *           count is (size - 8) / (4 * columns), so output can be streamed
  */
 
 #include <iostream>
-#include <vector>
-#include <string>
-#include <cmath>
-#include <algorithm>
+#include <cstdio>
+#include <charconv>
+#include <fstream>
 #include <sstream>
-#include <map>
+#include "ml_feature_vectorizer.h"
 
 using namespace std;
 
-struct CircuitFeatures {
-    int qubits;
-    int depth;
-    int gates;
-    string algorithm;
-    int data_size;
-    double complexity_score;
-    double target_latency;
-    string backend_preference;
-};
-
-class FeatureVectorizer {
-private:
-    // Normalization constants (based on typical ranges)
-    const double MAX_QUBITS = 100.0;
-    const double MAX_DEPTH = 1000.0;
-    const double MAX_GATES = 10000.0;
-    const double MAX_DATA_SIZE = 1000000.0;
-    const double MAX_LATENCY = 10000.0;
-    
-    map<string, double> algorithm_encoding = {
-        {"bell", 0.1},
-        {"grover", 0.3},
-        {"shor", 0.5},
-        {"vqe", 0.7},
-        {"qaoa", 0.9}
-    };
-    
-    map<string, double> backend_encoding = {
-        {"classical", 0.0},
-        {"hpc", 0.5},
-        {"quantum", 1.0}
-    };
-
-public:
-    vector<double> vectorize(const CircuitFeatures& features) {
-        vector<double> vec(12, 0.0);
-        
-        // Feature 0-2: Circuit structure (normalized)
-        vec[0] = min(1.0, features.qubits / MAX_QUBITS);
-        vec[1] = min(1.0, features.depth / MAX_DEPTH);
-        vec[2] = min(1.0, features.gates / MAX_GATES);
-        
-        // Feature 3: Algorithm type (categorical encoding)
-        vec[3] = algorithm_encoding.count(features.algorithm) ? 
-                 algorithm_encoding[features.algorithm] : 0.5;
-        
-        // Feature 4-5: Data characteristics
-        vec[4] = min(1.0, features.data_size / MAX_DATA_SIZE);
-        vec[5] = min(1.0, features.complexity_score);
-        
-        // Feature 6: Target latency (normalized, log scale)
-        vec[6] = features.target_latency > 0 ? 
-                 min(1.0, log(features.target_latency + 1) / log(MAX_LATENCY)) : 0.5;
-        
-        // Feature 7: Backend preference
-        vec[7] = backend_encoding.count(features.backend_preference) ?
-                 backend_encoding[features.backend_preference] : 0.5;
-        
-        // Feature 8-11: Derived features
-        vec[8] = vec[2] / (vec[1] + 1e-6);  // Gate density
-        vec[9] = vec[0] * vec[1];            // Circuit complexity
-        vec[10] = vec[3] * vec[5];           // Algorithm-data match
-        vec[11] = vec[6] * vec[7];           // Latency-backend compatibility
-        
-        return vec;
-    }
-    
-    double cosine_similarity(const vector<double>& v1, const vector<double>& v2) {
-        if(v1.size() != v2.size()) return 0.0;
-        
-        double dot = 0.0, mag1 = 0.0, mag2 = 0.0;
-        for(size_t i = 0; i < v1.size(); i++) {
-            dot += v1[i] * v2[i];
-            mag1 += v1[i] * v1[i];
-            mag2 += v2[i] * v2[i];
+const size_t BATCH_CHUNK_BYTES = 4 << 20;
+
+void write_json_rows(const vector<double>& matrix, size_t dim, string& out) {
+    char number[32];
+    for(size_t row = 0; row < matrix.size() / dim; row++) {
+        const double* vec = &matrix[row * dim];
+        if(isnan(vec[0])) {
+            out += "null\n";
+            continue;
         }
-        
-        double denom = sqrt(mag1) * sqrt(mag2);
-        return denom > 1e-9 ? dot / denom : 0.0;
-    }
-};
-
-// Parse command line JSON-like input
-CircuitFeatures parse_features(const string& input) {
-    CircuitFeatures features;
-    features.qubits = 2;
-    features.depth = 10;
-    features.gates = 20;
-    features.algorithm = "bell";
-    features.data_size = 100;
-    features.complexity_score = 0.5;
-    features.target_latency = 1000.0;
-    features.backend_preference = "classical";
-    
-    // Simple parsing (in production, use JSON library)
-    size_t pos = 0;
-    if((pos = input.find("\"qubits\":")) != string::npos) {
-        features.qubits = stoi(input.substr(pos + 9));
-    }
-    if((pos = input.find("\"depth\":")) != string::npos) {
-        features.depth = stoi(input.substr(pos + 8));
-    }
-    if((pos = input.find("\"gates\":")) != string::npos) {
-        features.gates = stoi(input.substr(pos + 8));
-    }
-    if((pos = input.find("\"data_size\":")) != string::npos) {
-        features.data_size = stoi(input.substr(pos + 12));
+        out += '[';
+        for(size_t i = 0; i < dim; i++) {
+            if(i > 0) out += ',';
+            auto result = to_chars(number, number + sizeof(number), vec[i]);
+            out.append(number, result.ptr - number);
+        }
+        out += "]\n";
     }
-    if((pos = input.find("\"complexity_score\":")) != string::npos) {
-        features.complexity_score = stod(input.substr(pos + 19));
+}
+
+void write_binary_rows(const vector<double>& matrix, string& out) {
+    size_t offset = out.size();
+    out.resize(offset + matrix.size() * sizeof(float));
+    float* dest = (float*)&out[offset];
+    for(size_t i = 0; i < matrix.size(); i++) dest[i] = (float)matrix[i];
+}
+
+// Streams stdin in large chunks; only complete lines are vectorized, the
+// trailing partial line carries over to the next chunk
+int run_batch(bool binary, bool extended) {
+    size_t dim = extended ? EXTENDED_FEATURE_DIM : FEATURE_DIM;
+    FeatureVectorizer vectorizer;
+    vector<char> buffer(BATCH_CHUNK_BYTES);
+    size_t carried = 0, lines_before = 0, total_rows = 0;
+    vector<double> matrix;
+    vector<size_t> bad_lines;
+    string out;
+
+    if(binary) {
+        uint32_t columns = dim;
+        fwrite("PFVM", 1, 4, stdout);
+        fwrite(&columns, sizeof(columns), 1, stdout);
     }
-    if((pos = input.find("\"target_latency\":")) != string::npos) {
-        features.target_latency = stod(input.substr(pos + 17));
+
+    while(true) {
+        if(carried == buffer.size()) buffer.resize(buffer.size() * 2);  // Very long line
+        size_t n = fread(buffer.data() + carried, 1, buffer.size() - carried, stdin);
+        size_t filled = carried + n;
+        bool eof = n == 0;
+
+        size_t usable = filled;
+        if(!eof) {
+            const char* last_newline = (const char*)memrchr(buffer.data(), '\n', filled);
+            usable = last_newline ? last_newline - buffer.data() + 1 : 0;
+        }
+
+        matrix.clear();
+        bad_lines.clear();
+        total_rows += vectorize_ndjson(vectorizer, string_view(buffer.data(), usable), matrix, &bad_lines, extended);
+        for(size_t line : bad_lines) cerr << "Malformed record on line " << lines_before + line << endl;
+        lines_before += count(buffer.data(), buffer.data() + usable, '\n');
+
+        out.clear();
+        if(binary) write_binary_rows(matrix, out);
+        else write_json_rows(matrix, dim, out);
+        fwrite(out.data(), 1, out.size(), stdout);
+
+        carried = filled - usable;
+        memmove(buffer.data(), buffer.data() + usable, carried);
+        if(eof) break;
     }
-    
-    return features;
+
+    fflush(stdout);
+    cerr << "Vectorized " << total_rows << " records" << endl;
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
     if(argc < 2) {
-        cerr << "Usage: " << argv[0] << " <features_json>" << endl;
+        cerr << "Usage: " << argv[0] << " <features_json> [--qasm <circuit.qasm>]" << endl;
+        cerr << "       " << argv[0] << " --batch [--format json|binary] [--extended] < records.ndjson" << endl;
         return 1;
     }
-    
+
     string input = argv[1];
-    CircuitFeatures features = parse_features(input);
-    
+    if(input == "--batch") {
+        bool binary = false, extended = false;
+        for(int i = 2; i < argc; i++) {
+            string arg = argv[i];
+            if(arg == "--format" && i + 1 < argc) binary = string(argv[++i]) == "binary";
+            else if(arg == "--extended") extended = true;
+        }
+        return run_batch(binary, extended);
+    }
+
     FeatureVectorizer vectorizer;
-    vector<double> vec = vectorizer.vectorize(features);
-    
-    // Output as JSON array
-    cout << "[";
-    for(size_t i = 0; i < vec.size(); i++) {
-        cout << vec[i];
-        if(i < vec.size() - 1) cout << ",";
+    try {
+        CircuitFeatures features = parse_features(input);
+        if(argc > 3 && string(argv[2]) == "--qasm") {
+            ifstream file(argv[3]);
+            if(!file) throw runtime_error(string("Cannot open circuit: ") + argv[3]);
+            stringstream source;
+            source << file.rdbuf();
+
+            vector<double> vec(EXTENDED_FEATURE_DIM);
+            vectorizer.vectorize_extended_into(features, extract_structure(source.str()), vec.data());
+            cout << "{\"version\":" << EXTENDED_FEATURE_VERSION
+                 << ",\"features\":" << vector_to_json(vec) << "}" << endl;
+            return 0;
+        }
+
+        // Output as JSON array
+        cout << vector_to_json(vectorizer.vectorize(features)) << endl;
+    } catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
     }
-    cout << "]" << endl;
-    
+
     return 0;
 }
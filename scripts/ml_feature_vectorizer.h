@@ -0,0 +1,255 @@
+/*
+ * ML Feature Vectorizer - High-performance C++ implementation
+ * Converts quantum circuit parameters into normalized feature vectors
+ * for reinforcement learning and similarity search
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string_view>
+#include <cstring>
+
+#include "json_scanner.h"
+#include "circuit_structure.h"
+#include "core/similarity.h"
+#include "core/metrics.h"
+
+using namespace std;
+
+// Feature vector layouts. Version 1 is the caller-supplied description;
+// version 2 appends structure read from the circuit itself.
+const int FEATURE_VERSION = 1;
+const size_t FEATURE_DIM = 12;
+const int EXTENDED_FEATURE_VERSION = 2;
+const size_t EXTENDED_FEATURE_DIM = FEATURE_DIM + 7 + GATE_CLASS_COUNT;
+
+struct CircuitFeatures {
+    int qubits;
+    int depth;
+    int gates;
+    string algorithm;
+    int data_size;
+    double complexity_score;
+    double target_latency;
+    string backend_preference;
+    string qasm;  // Optional circuit source for the extended layout
+};
+
+class FeatureVectorizer {
+private:
+    // Normalization constants (based on typical ranges)
+    const double MAX_QUBITS = 100.0;
+    const double MAX_DEPTH = 1000.0;
+    const double MAX_GATES = 10000.0;
+    const double MAX_DATA_SIZE = 1000000.0;
+    const double MAX_LATENCY = 10000.0;
+    
+    map<string, double> algorithm_encoding = {
+        {"bell", 0.1},
+        {"grover", 0.3},
+        {"shor", 0.5},
+        {"vqe", 0.7},
+        {"qaoa", 0.9}
+    };
+    
+    map<string, double> backend_encoding = {
+        {"classical", 0.0},
+        {"hpc", 0.5},
+        {"quantum", 1.0}
+    };
+
+public:
+    // const so a single instance can be shared by concurrent request handlers
+    vector<double> vectorize(const CircuitFeatures& features) const {
+        PLANCK_TIME_STAGE(VECTORIZE);
+        vector<double> vec(FEATURE_DIM, 0.0);
+        vectorize_into(features, vec.data());
+        return vec;
+    }
+    
+    // Writes FEATURE_DIM values into vec (e.g. one row of a batch matrix)
+    void vectorize_into(const CircuitFeatures& features, double* vec) const {
+        // Feature 0-2: Circuit structure (normalized)
+        vec[0] = min(1.0, features.qubits / MAX_QUBITS);
+        vec[1] = min(1.0, features.depth / MAX_DEPTH);
+        vec[2] = min(1.0, features.gates / MAX_GATES);
+        
+        // Feature 3: Algorithm type (categorical encoding)
+        auto algorithm = algorithm_encoding.find(features.algorithm);
+        vec[3] = algorithm != algorithm_encoding.end() ? algorithm->second : 0.5;
+        
+        // Feature 4-5: Data characteristics
+        vec[4] = min(1.0, features.data_size / MAX_DATA_SIZE);
+        vec[5] = min(1.0, features.complexity_score);
+        
+        // Feature 6: Target latency (normalized, log scale)
+        vec[6] = features.target_latency > 0 ? 
+                 min(1.0, log(features.target_latency + 1) / log(MAX_LATENCY)) : 0.5;
+        
+        // Feature 7: Backend preference
+        auto backend = backend_encoding.find(features.backend_preference);
+        vec[7] = backend != backend_encoding.end() ? backend->second : 0.5;
+        
+        // Feature 8-11: Derived features
+        vec[8] = vec[2] / (vec[1] + 1e-6);  // Gate density
+        vec[9] = vec[0] * vec[1];            // Circuit complexity
+        vec[10] = vec[3] * vec[5];           // Algorithm-data match
+        vec[11] = vec[6] * vec[7];           // Latency-backend compatibility
+    }
+    
+    // Writes EXTENDED_FEATURE_DIM values. Qubits, depth and gate count are
+    // taken from the circuit structure rather than the caller's estimates.
+    void vectorize_extended_into(const CircuitFeatures& features, const CircuitStructure& structure,
+                                 double* vec) const {
+        CircuitFeatures measured = features;
+        if(structure.qubits > 0) {
+            measured.qubits = structure.qubits;
+            measured.depth = structure.critical_path_depth;
+            measured.gates = structure.gates;
+        }
+        vectorize_into(measured, vec);
+        
+        double gates = max(1, structure.gates);
+        double pairs = structure.qubits > 1 ? structure.qubits * (structure.qubits - 1) / 2.0 : 1.0;
+        double max_neighbors = max(1, structure.qubits - 1);
+        
+        // Feature 12-14: Two-qubit load and how much of the critical path it makes up
+        vec[12] = structure.two_qubit_gates / gates;
+        vec[13] = structure.critical_path_depth > 0 ?
+                  (double)structure.entangling_depth / structure.critical_path_depth : 0.0;
+        vec[14] = min(1.0, log(structure.critical_path_depth + 1.0) / log(MAX_DEPTH + 1.0));
+        
+        // Feature 15-18: Interaction graph (density, degrees, connectivity)
+        vec[15] = structure.interaction_edges / pairs;
+        vec[16] = structure.max_degree / max_neighbors;
+        vec[17] = structure.mean_degree / max_neighbors;
+        vec[18] = structure.connected_components > 0 ? 1.0 / structure.connected_components : 0.0;
+        
+        // Feature 19+: Gate-type histogram (fractions of all gates)
+        for(int c = 0; c < GATE_CLASS_COUNT; c++) {
+            vec[19 + c] = structure.gate_histogram[c] / gates;
+        }
+    }
+    
+    double cosine_similarity(const vector<double>& v1, const vector<double>& v2) const {
+        return ::cosine_similarity(v1, v2);
+    }
+};
+
+inline void reset_features(CircuitFeatures& features) {
+    features.qubits = 2;
+    features.depth = 10;
+    features.gates = 20;
+    features.algorithm = "bell";
+    features.data_size = 100;
+    features.complexity_score = 0.5;
+    features.target_latency = 1000.0;
+    features.backend_preference = "classical";
+    features.qasm.clear();
+}
+
+// Backend preference implied by the UI's error mitigation level
+inline const char* backend_for_mitigation(string_view level) {
+    return level == "high" ? "quantum" : level == "medium" ? "hpc" : "classical";
+}
+
+// Parse one JSON feature record into features (reusing its string storage).
+// Accepts the snake_case keys used by the CLIs and the camelCase keys sent by
+// lib/ml (gateCount, dataSize, ...); errorMitigation maps to a backend
+// preference the same way the TypeScript vectorizer does.
+inline void parse_features(string_view input, CircuitFeatures& features) {
+    reset_features(features);
+    bool has_backend_preference = false;
+    
+    JsonScanner scanner(input);
+    scanner.scan_object([&](string_view key, const JsonValue& value) {
+        if(value.type == JsonType::NUMBER) {
+            if(key == "qubits") features.qubits = (int)value.number;
+            else if(key == "depth") features.depth = (int)value.number;
+            else if(key == "gates" || key == "gateCount") features.gates = (int)value.number;
+            else if(key == "data_size" || key == "dataSize") features.data_size = (int)value.number;
+            else if(key == "complexity_score" || key == "dataComplexity") features.complexity_score = value.number;
+            else if(key == "target_latency" || key == "targetLatency") features.target_latency = value.number;
+        } else if(value.type == JsonType::STRING) {
+            if(key == "algorithm") {
+                features.algorithm.assign(value.text.data(), value.text.size());
+            } else if(key == "backend_preference" || key == "backendPreference") {
+                features.backend_preference.assign(value.text.data(), value.text.size());
+                has_backend_preference = true;
+            } else if(key == "qasm") {
+                json_unescape(value.text, features.qasm);
+            } else if(key == "errorMitigation" && !has_backend_preference) {
+                features.backend_preference = backend_for_mitigation(value.text);
+            }
+        }
+    });
+}
+
+inline CircuitFeatures parse_features(const string& input) {
+    CircuitFeatures features;
+    parse_features(string_view(input), features);
+    return features;
+}
+
+// Vectorize a stream of NDJSON feature records into a contiguous row-major
+// matrix (FEATURE_DIM doubles per record, or EXTENDED_FEATURE_DIM when
+// extended; records without a "qasm" field get zero structure features).
+// Malformed records produce a row of NaN so rows stay aligned with input
+// lines; their line numbers (1-based, relative to this buffer) are returned
+// in bad_lines.
+inline size_t vectorize_ndjson(const FeatureVectorizer& vectorizer, string_view input,
+                               vector<double>& matrix, vector<size_t>* bad_lines = nullptr,
+                               bool extended = false) {
+    PLANCK_TIME_STAGE(VECTORIZE);
+    size_t dim = extended ? EXTENDED_FEATURE_DIM : FEATURE_DIM;
+    CircuitFeatures features;
+    size_t rows = 0, line_number = 0;
+    const char* p = input.data();
+    const char* end = p + input.size();
+    
+    while(p < end) {
+        const char* newline = (const char*)memchr(p, '\n', end - p);
+        const char* line_end = newline ? newline : end;
+        string_view line(p, line_end - p);
+        p = newline ? newline + 1 : end;
+        line_number++;
+        
+        if(line.find_first_not_of(" \t\r") == string_view::npos) continue;
+        
+        size_t offset = matrix.size();
+        matrix.resize(offset + dim);
+        try {
+            parse_features(line, features);
+            if(extended) {
+                CircuitStructure structure;
+                if(!features.qasm.empty()) structure = extract_structure(features.qasm);
+                vectorizer.vectorize_extended_into(features, structure, &matrix[offset]);
+            } else {
+                vectorizer.vectorize_into(features, &matrix[offset]);
+            }
+        } catch(const exception&) {
+            fill(matrix.begin() + offset, matrix.end(), NAN);
+            if(bad_lines) bad_lines->push_back(line_number);
+        }
+        rows++;
+    }
+    return rows;
+}
+
+// Serialize a feature vector as a JSON array
+inline string vector_to_json(const vector<double>& vec) {
+    ostringstream out;
+    out << "[";
+    for(size_t i = 0; i < vec.size(); i++) {
+        out << vec[i];
+        if(i < vec.size() - 1) out << ",";
+    }
+    out << "]";
+    return out.str();
+}
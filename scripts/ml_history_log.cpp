@@ -0,0 +1,167 @@
+/*
+ * Execution History Log Tool
+ * Imports, inspects and compacts binary history logs
+ * (see ml_history_log.h for the file format)
+ *
+ * Text records are tab-separated:
+ *   <feature_vector>  <shots>  <backend>  <fidelity>  <runtime_ms>  <reward>
+ */
+
+#include <iostream>
+#include <chrono>
+#include "ml_history_log.h"
+
+using namespace std;
+
+int cmd_stats(const string& path) {
+    HistoryLogReader reader(path);
+    size_t blocks = 0, records = 0;
+    map<uint16_t, size_t> per_backend;
+    size_t end = reader.for_each_block([&](const LogBlock& block) {
+        blocks++;
+        records += block.count;
+        for(uint32_t i = 0; i < block.count; i++) per_backend[block.backend_id[i]]++;
+    });
+
+    cout << "{\"records\":" << records
+         << ",\"data_blocks\":" << blocks
+         << ",\"feature_dim\":" << reader.get_feature_dim()
+         << ",\"valid_bytes\":" << end
+         << ",\"backends\":{";
+    bool first = true;
+    for(const auto& [id, count] : per_backend) {
+        if(!first) cout << ",";
+        cout << "\"" << reader.backend_names()[id] << "\":" << count;
+        first = false;
+    }
+    cout << "}}" << endl;
+    return 0;
+}
+
+int cmd_dump(const string& path) {
+    HistoryLogReader reader(path);
+    reader.for_each_block([&](const LogBlock& block) {
+        for(uint32_t i = 0; i < block.count; i++) {
+            cout << "[";
+            for(size_t f = 0; f < block.feature_dim; f++) {
+                if(f > 0) cout << ",";
+                cout << block.feature_column(f)[i];
+            }
+            cout << "]\t" << block.shots[i]
+                 << "\t" << reader.backend_names()[block.backend_id[i]]
+                 << "\t" << block.fidelity[i]
+                 << "\t" << block.runtime_ms[i]
+                 << "\t" << block.reward[i] << "\n";
+        }
+    });
+    return 0;
+}
+
+int cmd_import(const string& path, int feature_dim) {
+    HistoryLogWriter writer(path, feature_dim);
+    string line;
+    size_t imported = 0;
+    while(getline(cin, line)) {
+        if(line.empty()) continue;
+        vector<string> fields;
+        size_t start = 0, tab;
+        while((tab = line.find('\t', start)) != string::npos) {
+            fields.push_back(line.substr(start, tab - start));
+            start = tab + 1;
+        }
+        fields.push_back(line.substr(start));
+        if(fields.size() < 6) {
+            cerr << "Skipping malformed record: " << line << endl;
+            continue;
+        }
+
+        vector<double> features = parse_feature_vector(fields[0]);
+        writer.append(features.data(), features.size(), stoi(fields[1]), fields[2],
+                      stod(fields[3]), stod(fields[4]), stod(fields[5]));
+        imported++;
+    }
+    writer.flush();
+    cerr << "Imported " << imported << " records" << endl;
+    return 0;
+}
+
+// Rewrites one or more logs into a fresh log with full-size blocks, a
+// single dictionary and no torn tails
+int cmd_compact(const string& out_path, const vector<string>& inputs) {
+    if(access(out_path.c_str(), F_OK) == 0) {
+        cerr << "Refusing to overwrite existing log: " << out_path << endl;
+        return 1;
+    }
+
+    uint16_t feature_dim;
+    {
+        HistoryLogReader first(inputs[0]);
+        feature_dim = first.get_feature_dim();
+    }
+
+    HistoryLogWriter writer(out_path, feature_dim);
+    vector<double> row(feature_dim);
+    size_t records = 0;
+    for(const auto& input : inputs) {
+        HistoryLogReader reader(input);
+        if(reader.get_feature_dim() != feature_dim) {
+            cerr << "Feature dimension mismatch in " << input << endl;
+            return 1;
+        }
+        reader.for_each_block([&](const LogBlock& block) {
+            for(uint32_t i = 0; i < block.count; i++) {
+                for(size_t f = 0; f < feature_dim; f++) row[f] = block.feature_column(f)[i];
+                writer.append(row.data(), feature_dim, block.shots[i],
+                              reader.backend_names()[block.backend_id[i]],
+                              block.fidelity[i], block.runtime_ms[i], block.reward[i]);
+            }
+            records += block.count;
+        });
+    }
+    writer.flush();
+    cerr << "Compacted " << records << " records into " << out_path << endl;
+    return 0;
+}
+
+// Replays the log through a fresh engine to measure ingestion throughput
+int cmd_replay(const string& path) {
+    auto start = chrono::steady_clock::now();
+    HistoryLogReader reader(path);
+    ReinforcementEngine engine;
+    size_t fed = reader.feed(engine);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "{\"records\":" << fed
+         << ",\"arms\":" << engine.arm_count()
+         << ",\"seconds\":" << seconds
+         << ",\"records_per_second\":" << (seconds > 0 ? fed / seconds : 0.0) << "}" << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 3) {
+        cerr << "Usage: " << argv[0] << " stats <log>" << endl;
+        cerr << "       " << argv[0] << " dump <log>" << endl;
+        cerr << "       " << argv[0] << " import <log> [feature_dim] < records.tsv" << endl;
+        cerr << "       " << argv[0] << " compact <out_log> <in_log>..." << endl;
+        cerr << "       " << argv[0] << " replay <log>" << endl;
+        return 1;
+    }
+
+    string command = argv[1];
+    try {
+        if(command == "stats") return cmd_stats(argv[2]);
+        if(command == "dump") return cmd_dump(argv[2]);
+        if(command == "import") return cmd_import(argv[2], argc > 3 ? stoi(argv[3]) : 12);
+        if(command == "replay") return cmd_replay(argv[2]);
+        if(command == "compact" && argc >= 4) {
+            return cmd_compact(argv[2], vector<string>(argv + 3, argv + argc));
+        }
+    } catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    cerr << "Unknown command: " << command << endl;
+    return 1;
+}
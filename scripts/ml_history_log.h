@@ -0,0 +1,361 @@
+/*
+ * Execution History Log - Compact append-only binary store
+ * Persists HistoricalExecution records for the reinforcement engine and
+ * streams them back through an mmap'd reader without per-record allocation
+ *
+ * File layout (native little-endian):
+ *   LogHeader                      magic "PHLG", version, feature_dim
+ *   { BlockHeader, payload }*      appended blocks, payload padded to 8 bytes
+ *
+ * DICT blocks intern backend names: { uint16 id, uint16 len, char[len] }*
+ * DATA blocks hold up to BLOCK_RECORDS records in column layout:
+ *   float features[feature_dim][count]   one column per feature
+ *   float fidelity[count], runtime_ms[count], reward[count]
+ *   uint32 shots[count]
+ *   uint16 backend_id[count]
+ *
+ * A torn block at the end of the file (crash during append) is ignored by
+ * the reader and truncated by the next writer.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <functional>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ml_reinforcement_engine.h"
+
+using namespace std;
+
+const char HISTORY_LOG_MAGIC[4] = {'P', 'H', 'L', 'G'};
+const uint16_t HISTORY_LOG_VERSION = 1;
+const uint32_t BLOCK_RECORDS = 4096;
+
+enum class BlockKind : uint32_t {
+    DICT = 1,
+    DATA = 2
+};
+
+struct LogHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t feature_dim;
+    uint64_t reserved;
+};
+
+struct BlockHeader {
+    uint32_t kind;
+    uint32_t count;
+    uint64_t payload_bytes;
+};
+
+inline size_t pad8(size_t bytes) {
+    return (bytes + 7) & ~size_t(7);
+}
+
+inline size_t data_payload_bytes(uint32_t count, uint16_t feature_dim) {
+    return pad8(size_t(count) * (sizeof(float) * (feature_dim + 3) + sizeof(uint32_t) + sizeof(uint16_t)));
+}
+
+// Column pointers into one DATA block (valid while the reader is alive)
+struct LogBlock {
+    uint32_t count;
+    uint16_t feature_dim;
+    const float* features;   // features[f * count + i]
+    const float* fidelity;
+    const float* runtime_ms;
+    const float* reward;
+    const uint32_t* shots;
+    const uint16_t* backend_id;
+
+    const float* feature_column(size_t f) const { return features + f * count; }
+};
+
+class HistoryLogReader {
+private:
+    int fd;
+    const uint8_t* data;
+    size_t size;
+    uint16_t feature_dim;
+    vector<string> backends;
+
+    // Interns one DICT block; false if an entry runs past the payload
+    bool read_dict(const uint8_t* payload, size_t payload_bytes, uint32_t count) {
+        size_t pos = 0;
+        for(uint32_t i = 0; i < count; i++) {
+            if(payload_bytes - pos < 4) return false;
+            uint16_t id, len;
+            memcpy(&id, payload + pos, 2);
+            memcpy(&len, payload + pos + 2, 2);
+            if(payload_bytes - pos - 4 < len) return false;
+            if(backends.size() <= id) backends.resize(id + 1);
+            backends[id].assign((const char*)payload + pos + 4, len);
+            pos += 4 + len;
+        }
+        return true;
+    }
+
+public:
+    HistoryLogReader(const string& path) : fd(-1), data(nullptr), size(0), feature_dim(0) {
+        fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0) throw runtime_error("Cannot open history log: " + path);
+
+        struct stat st;
+        fstat(fd, &st);
+        size = st.st_size;
+        if(size < sizeof(LogHeader)) {
+            close(fd);
+            throw runtime_error("Not a history log: " + path);
+        }
+
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapped == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Cannot mmap history log: " + path);
+        }
+        data = (const uint8_t*)mapped;
+        madvise(mapped, size, MADV_SEQUENTIAL);
+
+        const LogHeader* header = (const LogHeader*)data;
+        if(memcmp(header->magic, HISTORY_LOG_MAGIC, 4) != 0 || header->version != HISTORY_LOG_VERSION) {
+            munmap(mapped, size);
+            close(fd);
+            throw runtime_error("Unsupported history log format: " + path);
+        }
+        feature_dim = header->feature_dim;
+    }
+
+    ~HistoryLogReader() {
+        if(data) munmap((void*)data, size);
+        if(fd >= 0) close(fd);
+    }
+
+    HistoryLogReader(const HistoryLogReader&) = delete;
+    HistoryLogReader& operator=(const HistoryLogReader&) = delete;
+
+    uint16_t get_feature_dim() const { return feature_dim; }
+    const vector<string>& backend_names() const { return backends; }
+
+    // Walks every complete block; DICT blocks are interned before the DATA
+    // blocks that reference them. A torn tail, a DICT entry past its block
+    // or a backend id without a DICT entry ends the walk at that block, so
+    // visitors may index backend_names() with any backend_id they see.
+    // Returns the byte offset after the last good block (where a writer may
+    // safely append).
+    size_t for_each_block(const function<void(const LogBlock&)>& visit) {
+        backends.clear();
+        size_t offset = sizeof(LogHeader);
+
+        while(offset + sizeof(BlockHeader) <= size) {
+            const BlockHeader* block = (const BlockHeader*)(data + offset);
+            size_t payload_start = offset + sizeof(BlockHeader);
+            if(block->payload_bytes > size - payload_start) break;  // Torn tail
+            const uint8_t* payload = data + payload_start;
+
+            if(block->kind == (uint32_t)BlockKind::DICT) {
+                if(!read_dict(payload, block->payload_bytes, block->count)) break;
+            } else if(block->kind == (uint32_t)BlockKind::DATA) {
+                if(block->payload_bytes != data_payload_bytes(block->count, feature_dim)) break;
+                LogBlock view;
+                view.count = block->count;
+                view.feature_dim = feature_dim;
+                const float* floats = (const float*)payload;
+                view.features = floats;
+                view.fidelity = floats + size_t(feature_dim) * block->count;
+                view.runtime_ms = view.fidelity + block->count;
+                view.reward = view.runtime_ms + block->count;
+                view.shots = (const uint32_t*)(view.reward + block->count);
+                view.backend_id = (const uint16_t*)(view.shots + block->count);
+                uint16_t max_id = 0;
+                for(uint32_t i = 0; i < view.count; i++) max_id = max(max_id, view.backend_id[i]);
+                if(view.count > 0 && max_id >= backends.size()) break;
+                visit(view);
+            } else {
+                break;
+            }
+            offset = payload_start + block->payload_bytes;
+        }
+        return offset;
+    }
+
+    // Streams every record into the engine; one scratch row, no per-record allocation
+    size_t feed(ReinforcementEngine& engine) {
+        vector<double> row(feature_dim);
+        size_t fed = 0;
+        for_each_block([&](const LogBlock& block) {
+            for(uint32_t i = 0; i < block.count; i++) {
+                for(size_t f = 0; f < feature_dim; f++) row[f] = block.features[f * block.count + i];
+                engine.observe(row.data(), feature_dim, block.shots[i],
+                               backends[block.backend_id[i]], block.reward[i]);
+            }
+            fed += block.count;
+        });
+        return fed;
+    }
+
+    size_t record_count() {
+        size_t total = 0;
+        for_each_block([&](const LogBlock& block) { total += block.count; });
+        return total;
+    }
+};
+
+class HistoryLogWriter {
+private:
+    int fd;
+    uint16_t feature_dim;
+    map<string, uint16_t> backend_ids;
+    vector<pair<uint16_t, string>> pending_backends;
+
+    // Column buffers for the block being built
+    uint32_t buffered;
+    vector<float> features, fidelity, runtime_ms, reward;
+    vector<uint32_t> shots;
+    vector<uint16_t> backend_id;
+    vector<uint8_t> out;
+
+    void write_all(const uint8_t* bytes, size_t len) {
+        while(len > 0) {
+            ssize_t n = write(fd, bytes, len);
+            if(n <= 0) throw runtime_error("History log write failed");
+            bytes += n;
+            len -= n;
+        }
+    }
+
+    template<typename T>
+    void append_column(const T* values, size_t count) {
+        const uint8_t* bytes = (const uint8_t*)values;
+        out.insert(out.end(), bytes, bytes + count * sizeof(T));
+    }
+
+    void append_block_header(BlockKind kind, uint32_t count, size_t payload_bytes) {
+        BlockHeader header{(uint32_t)kind, count, payload_bytes};
+        append_column(&header, 1);
+    }
+
+public:
+    // Opens (or creates) a log for appending. An existing log must have the
+    // same feature_dim; its dictionary is reloaded and any torn tail dropped.
+    HistoryLogWriter(const string& path, uint16_t dim) : fd(-1), feature_dim(dim), buffered(0) {
+        size_t append_offset = 0;
+        bool exists = access(path.c_str(), F_OK) == 0;
+        if(exists) {
+            HistoryLogReader reader(path);
+            if(reader.get_feature_dim() != dim) {
+                throw runtime_error("History log feature_dim mismatch: " + path);
+            }
+            append_offset = reader.for_each_block([](const LogBlock&) {});
+            const auto& names = reader.backend_names();
+            for(size_t id = 0; id < names.size(); id++) backend_ids[names[id]] = id;
+        }
+
+        fd = open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+        if(fd < 0) throw runtime_error("Cannot open history log for writing: " + path);
+
+        if(exists) {
+            if(ftruncate(fd, append_offset) != 0) throw runtime_error("Cannot truncate history log: " + path);
+            lseek(fd, append_offset, SEEK_SET);
+        } else {
+            LogHeader header{};
+            memcpy(header.magic, HISTORY_LOG_MAGIC, 4);
+            header.version = HISTORY_LOG_VERSION;
+            header.feature_dim = feature_dim;
+            write_all((const uint8_t*)&header, sizeof(header));
+        }
+
+        features.resize(size_t(feature_dim) * BLOCK_RECORDS);
+        fidelity.resize(BLOCK_RECORDS);
+        runtime_ms.resize(BLOCK_RECORDS);
+        reward.resize(BLOCK_RECORDS);
+        shots.resize(BLOCK_RECORDS);
+        backend_id.resize(BLOCK_RECORDS);
+    }
+
+    ~HistoryLogWriter() {
+        try { flush(); } catch(...) {}
+        if(fd >= 0) close(fd);
+    }
+
+    HistoryLogWriter(const HistoryLogWriter&) = delete;
+    HistoryLogWriter& operator=(const HistoryLogWriter&) = delete;
+
+    // DICT entries store the name length in 16 bits
+    uint16_t intern_backend(const string& name) {
+        auto it = backend_ids.find(name);
+        if(it != backend_ids.end()) return it->second;
+        if(name.size() > 0xFFFF) throw runtime_error("Backend name longer than 65535 bytes");
+        if(backend_ids.size() >= 0xFFFF) throw runtime_error("Too many distinct backends");
+        uint16_t id = backend_ids.size();
+        backend_ids[name] = id;
+        pending_backends.push_back({id, name});
+        return id;
+    }
+
+    void append(const double* feature_row, size_t dim, int shots_used, const string& backend,
+                double fidelity_achieved, double runtime, double reward_score) {
+        uint16_t id = intern_backend(backend);  // May throw; nothing is buffered yet
+        // Columns are strided by BLOCK_RECORDS while buffering and packed on flush
+        for(size_t f = 0; f < feature_dim; f++) {
+            features[f * BLOCK_RECORDS + buffered] = f < dim ? feature_row[f] : 0.0f;
+        }
+        fidelity[buffered] = fidelity_achieved;
+        runtime_ms[buffered] = runtime;
+        reward[buffered] = reward_score;
+        shots[buffered] = shots_used;
+        backend_id[buffered] = id;
+        if(++buffered == BLOCK_RECORDS) flush();
+    }
+
+    void append(const HistoricalExecution& exec) {
+        append(exec.features.data(), exec.features.size(), exec.shots_used, exec.backend_used,
+               exec.fidelity_achieved, exec.runtime_ms, exec.reward_score);
+    }
+
+    // Writes buffered records as one DICT (if needed) + one DATA block
+    void flush() {
+        if(buffered == 0 && pending_backends.empty()) return;
+        out.clear();
+
+        if(!pending_backends.empty()) {
+            size_t dict_bytes = 0;
+            for(const auto& entry : pending_backends) dict_bytes += 4 + entry.second.size();
+            append_block_header(BlockKind::DICT, pending_backends.size(), pad8(dict_bytes));
+            for(const auto& entry : pending_backends) {
+                uint16_t id = entry.first, len = entry.second.size();
+                append_column(&id, 1);
+                append_column(&len, 1);
+                append_column(entry.second.data(), len);
+            }
+            out.resize(out.size() + pad8(dict_bytes) - dict_bytes, 0);
+            pending_backends.clear();
+        }
+
+        if(buffered > 0) {
+            size_t payload = data_payload_bytes(buffered, feature_dim);
+            size_t start = out.size();
+            append_block_header(BlockKind::DATA, buffered, payload);
+            for(size_t f = 0; f < feature_dim; f++) append_column(&features[f * BLOCK_RECORDS], buffered);
+            append_column(fidelity.data(), buffered);
+            append_column(runtime_ms.data(), buffered);
+            append_column(reward.data(), buffered);
+            append_column(shots.data(), buffered);
+            append_column(backend_id.data(), buffered);
+            out.resize(start + sizeof(BlockHeader) + payload, 0);
+            buffered = 0;
+        }
+
+        // One write per flush; a crash mid-write leaves a torn tail the reader skips
+        write_all(out.data(), out.size());
+    }
+};
@@ -0,0 +1,84 @@
+/*
+ * Performance Predictor - Command line entry point
+ * Trains per-backend runtime/fidelity models from a history log and
+ * queries them (see ml_performance_predictor.h)
+ */
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include "ml_performance_predictor.h"
+
+using namespace std;
+
+int cmd_train(const string& log_path, const string& model_path, int epochs) {
+    HistoryLogReader reader(log_path);
+    PerformancePredictor predictor;
+
+    auto start = chrono::steady_clock::now();
+    size_t rows = predictor.train_from_log(reader, epochs);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    predictor.save(model_path);
+
+    cerr << "Trained " << predictor.backends().size() << " backend models on " << rows
+         << " records in " << seconds << "s" << endl;
+    return 0;
+}
+
+int cmd_predict(const string& model_path, const string& features_json, int shots, double target_latency) {
+    PerformancePredictor predictor;
+    predictor.load(model_path);
+    vector<double> features = parse_feature_vector(features_json);
+
+    // Time the whole per-backend sweep to report inference cost
+    const int REPEAT = 1000;
+    PerformancePrediction chosen_pred{0, 0};
+    string chosen;
+    auto start = chrono::steady_clock::now();
+    for(int i = 0; i < REPEAT; i++) {
+        chosen = predictor.select_backend(features, shots, target_latency, &chosen_pred);
+    }
+    double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / REPEAT;
+
+    ostringstream out;
+    out << "{\"predictions\":{";
+    bool first = true;
+    for(const auto& backend : predictor.backends()) {
+        PerformancePrediction pred{0, 0};
+        predictor.predict(backend, features.data(), features.size(), shots, pred);
+        if(!first) out << ",";
+        out << "\"" << backend << "\":{\"runtime_ms\":" << pred.runtime_ms
+            << ",\"fidelity\":" << pred.fidelity << "}";
+        first = false;
+    }
+    out << "},\"selected_backend\":\"" << chosen << "\""
+        << ",\"meets_target_latency\":" << (target_latency <= 0 || chosen_pred.runtime_ms <= target_latency ? "true" : "false")
+        << ",\"selection_us\":" << micros << "}";
+    cout << out.str() << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 4) {
+        cerr << "Usage: " << argv[0] << " train <history_log> <model> [epochs]" << endl;
+        cerr << "       " << argv[0] << " predict <model> <features_json> [shots] [target_latency_ms]" << endl;
+        return 1;
+    }
+
+    string command = argv[1];
+    try {
+        if(command == "train") {
+            return cmd_train(argv[2], argv[3], argc > 4 ? stoi(argv[4]) : 10);
+        }
+        if(command == "predict") {
+            return cmd_predict(argv[2], argv[3], argc > 4 ? stoi(argv[4]) : 1000,
+                               argc > 5 ? stod(argv[5]) : 0.0);
+        }
+    } catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    cerr << "Unknown command: " << command << endl;
+    return 1;
+}
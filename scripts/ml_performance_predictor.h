@@ -0,0 +1,388 @@
+/*
+ * Performance Predictor - Learned runtime/fidelity model per backend
+ * Small MLPs trained offline from the execution history log predict what a
+ * circuit will cost on each backend before it is submitted, so backend
+ * choice can respect target_latency up front.
+ *
+ * Inputs are the feature vector plus log(shots); outputs are log(1 + runtime_ms)
+ * and fidelity. Weights are stored input-major so the inner inference loop
+ * runs across output neurons without a reduction and vectorizes cleanly.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <cmath>
+#include <random>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+#include "ml_history_log.h"
+
+using namespace std;
+
+struct PerformancePrediction {
+    double runtime_ms;
+    double fidelity;
+};
+
+// Fully connected layer, W stored as [in][out]
+struct DenseLayer {
+    int in = 0, out = 0;
+    vector<float> W, b;
+
+    void init(int inputs, int outputs, mt19937& gen) {
+        in = inputs;
+        out = outputs;
+        W.resize(size_t(in) * out);
+        b.assign(out, 0.0f);
+        normal_distribution<float> dist(0.0f, sqrt(2.0f / in));  // He init for ReLU
+        for(auto& w : W) w = dist(gen);
+    }
+
+    // y = act(x W + b)
+    void forward(const float* x, float* y, bool relu) const {
+        for(int o = 0; o < out; o++) y[o] = b[o];
+        for(int i = 0; i < in; i++) {
+            const float xi = x[i];
+            const float* row = &W[size_t(i) * out];
+            for(int o = 0; o < out; o++) y[o] += row[o] * xi;
+        }
+        if(relu) {
+            for(int o = 0; o < out; o++) y[o] = max(0.0f, y[o]);
+        }
+    }
+};
+
+class MlpRegressor {
+public:
+    static const int HIDDEN = 32;
+    static const int OUTPUTS = 2;
+
+private:
+    int input_dim = 0;
+    vector<float> input_mean, input_scale;
+    float target_mean[OUTPUTS] = {0, 0};
+    float target_scale[OUTPUTS] = {1, 1};
+    DenseLayer l1, l2, l3;
+
+    // Adam moments, one set per parameter vector
+    struct AdamState {
+        vector<float> m, v;
+    };
+    vector<AdamState> adam;
+    long adam_step = 0;
+
+    static void adam_update(vector<float>& params, const vector<float>& grad, AdamState& state,
+                            float lr, long step) {
+        const float beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+        float correction1 = 1.0f - pow(beta1, (float)step);
+        float correction2 = 1.0f - pow(beta2, (float)step);
+        for(size_t i = 0; i < params.size(); i++) {
+            state.m[i] = beta1 * state.m[i] + (1 - beta1) * grad[i];
+            state.v[i] = beta2 * state.v[i] + (1 - beta2) * grad[i] * grad[i];
+            params[i] -= lr * (state.m[i] / correction1) / (sqrt(state.v[i] / correction2) + eps);
+        }
+    }
+
+public:
+    int get_input_dim() const { return input_dim; }
+
+    // Raw (unnormalized) input row: features..., log(shots)
+    static void build_input(const double* features, size_t dim, int shots, int input_dim, float* x) {
+        for(int i = 0; i < input_dim - 1; i++) x[i] = i < (int)dim ? features[i] : 0.0f;
+        x[input_dim - 1] = log((double)max(1, shots));
+    }
+
+    // Trains on rows of X (n x input_dim) and Y (n x OUTPUTS, already transformed)
+    void train(const vector<float>& X, const vector<float>& Y, int dim, int epochs, float lr, uint32_t seed) {
+        if(dim <= 0 || dim > 256) throw runtime_error("Unsupported predictor input dimension");
+        input_dim = dim;
+        size_t n = Y.size() / OUTPUTS;
+        if(n == 0) throw runtime_error("No training rows");
+
+        // Standardize inputs and targets
+        input_mean.assign(dim, 0.0f);
+        input_scale.assign(dim, 1.0f);
+        for(int f = 0; f < dim; f++) {
+            double sum = 0, sq = 0;
+            for(size_t r = 0; r < n; r++) {
+                double v = X[r * dim + f];
+                sum += v;
+                sq += v * v;
+            }
+            double mean = sum / n, var = max(0.0, sq / n - mean * mean);
+            input_mean[f] = mean;
+            input_scale[f] = var > 1e-12 ? 1.0 / sqrt(var) : 1.0;
+        }
+        for(int t = 0; t < OUTPUTS; t++) {
+            double sum = 0, sq = 0;
+            for(size_t r = 0; r < n; r++) {
+                double v = Y[r * OUTPUTS + t];
+                sum += v;
+                sq += v * v;
+            }
+            double mean = sum / n, var = max(0.0, sq / n - mean * mean);
+            target_mean[t] = mean;
+            target_scale[t] = var > 1e-12 ? sqrt(var) : 1.0;
+        }
+
+        mt19937 gen(seed);
+        l1.init(dim, HIDDEN, gen);
+        l2.init(HIDDEN, HIDDEN, gen);
+        l3.init(HIDDEN, OUTPUTS, gen);
+        vector<vector<float>*> params = {&l1.W, &l1.b, &l2.W, &l2.b, &l3.W, &l3.b};
+        adam.assign(params.size(), AdamState());
+        for(size_t p = 0; p < params.size(); p++) {
+            adam[p].m.assign(params[p]->size(), 0.0f);
+            adam[p].v.assign(params[p]->size(), 0.0f);
+        }
+        adam_step = 0;
+
+        vector<vector<float>> grads(params.size());
+        for(size_t p = 0; p < params.size(); p++) grads[p].resize(params[p]->size());
+
+        const size_t BATCH = 256;
+        vector<size_t> order(n);
+        for(size_t i = 0; i < n; i++) order[i] = i;
+        vector<float> x(dim), h1(HIDDEN), h2(HIDDEN), out(OUTPUTS);
+        vector<float> d_out(OUTPUTS), d_h2(HIDDEN), d_h1(HIDDEN);
+
+        for(int epoch = 0; epoch < epochs; epoch++) {
+            shuffle(order.begin(), order.end(), gen);
+            for(size_t start = 0; start < n; start += BATCH) {
+                size_t end = min(n, start + BATCH);
+                for(auto& g : grads) fill(g.begin(), g.end(), 0.0f);
+
+                for(size_t k = start; k < end; k++) {
+                    size_t r = order[k];
+                    for(int f = 0; f < dim; f++) x[f] = (X[r * dim + f] - input_mean[f]) * input_scale[f];
+                    l1.forward(x.data(), h1.data(), true);
+                    l2.forward(h1.data(), h2.data(), true);
+                    l3.forward(h2.data(), out.data(), false);
+
+                    for(int t = 0; t < OUTPUTS; t++) {
+                        float target = (Y[r * OUTPUTS + t] - target_mean[t]) / target_scale[t];
+                        d_out[t] = out[t] - target;  // d(0.5 * err^2)
+                    }
+                    backward(l3, h2.data(), d_out.data(), d_h2.data(), grads[4], grads[5], &h2);
+                    backward(l2, h1.data(), d_h2.data(), d_h1.data(), grads[2], grads[3], &h1);
+                    backward(l1, x.data(), d_h1.data(), nullptr, grads[0], grads[1], nullptr);
+                }
+
+                float scale = 1.0f / (end - start);
+                adam_step++;
+                for(size_t p = 0; p < params.size(); p++) {
+                    for(auto& g : grads[p]) g *= scale;
+                    adam_update(*params[p], grads[p], adam[p], lr, adam_step);
+                }
+            }
+        }
+        adam.clear();
+    }
+
+    // Accumulates layer gradients; d_x is masked by the ReLU of x_act when given
+    static void backward(const DenseLayer& layer, const float* x, const float* d_y, float* d_x,
+                         vector<float>& dW, vector<float>& db, const vector<float>* x_act) {
+        for(int o = 0; o < layer.out; o++) db[o] += d_y[o];
+        for(int i = 0; i < layer.in; i++) {
+            const float* row = &layer.W[size_t(i) * layer.out];
+            float* grad_row = &dW[size_t(i) * layer.out];
+            float sum = 0.0f;
+            for(int o = 0; o < layer.out; o++) {
+                grad_row[o] += x[i] * d_y[o];
+                sum += row[o] * d_y[o];
+            }
+            if(d_x) d_x[i] = (x_act && (*x_act)[i] <= 0.0f) ? 0.0f : sum;
+        }
+    }
+
+    // x is a raw input row (see build_input); scratch-free, safe to call concurrently
+    PerformancePrediction predict_raw(const float* raw) const {
+        float x[256], h1[HIDDEN], h2[HIDDEN], out[OUTPUTS];
+        int dim = min(input_dim, 256);
+        for(int f = 0; f < dim; f++) x[f] = (raw[f] - input_mean[f]) * input_scale[f];
+        l1.forward(x, h1, true);
+        l2.forward(h1, h2, true);
+        l3.forward(h2, out, false);
+
+        double log_runtime = out[0] * target_scale[0] + target_mean[0];
+        double fidelity = out[1] * target_scale[1] + target_mean[1];
+        return {max(0.0, expm1(log_runtime)), min(1.0, max(0.0, fidelity))};
+    }
+
+    void save(ostream& out) const {
+        uint32_t dim = input_dim;
+        out.write((const char*)&dim, sizeof(dim));
+        out.write((const char*)input_mean.data(), dim * sizeof(float));
+        out.write((const char*)input_scale.data(), dim * sizeof(float));
+        out.write((const char*)target_mean, sizeof(target_mean));
+        out.write((const char*)target_scale, sizeof(target_scale));
+        for(const DenseLayer* layer : {&l1, &l2, &l3}) {
+            out.write((const char*)layer->W.data(), layer->W.size() * sizeof(float));
+            out.write((const char*)layer->b.data(), layer->b.size() * sizeof(float));
+        }
+    }
+
+    void load(istream& in) {
+        uint32_t dim;
+        in.read((char*)&dim, sizeof(dim));
+        if(!in || dim == 0 || dim > 256) throw runtime_error("Corrupt predictor model");
+        input_dim = dim;
+        input_mean.resize(dim);
+        input_scale.resize(dim);
+        in.read((char*)input_mean.data(), dim * sizeof(float));
+        in.read((char*)input_scale.data(), dim * sizeof(float));
+        in.read((char*)target_mean, sizeof(target_mean));
+        in.read((char*)target_scale, sizeof(target_scale));
+
+        mt19937 unused(0);
+        l1.init(dim, HIDDEN, unused);
+        l2.init(HIDDEN, HIDDEN, unused);
+        l3.init(HIDDEN, OUTPUTS, unused);
+        for(DenseLayer* layer : {&l1, &l2, &l3}) {
+            in.read((char*)layer->W.data(), layer->W.size() * sizeof(float));
+            in.read((char*)layer->b.data(), layer->b.size() * sizeof(float));
+        }
+        if(!in) throw runtime_error("Truncated predictor model");
+    }
+};
+
+class PerformancePredictor {
+private:
+    map<string, MlpRegressor> models;
+
+    static constexpr char MAGIC[4] = {'P', 'P', 'R', 'D'};
+    static const uint32_t VERSION = 1;
+
+public:
+    // Trains one model per backend from a history log. At most max_rows
+    // records per backend are kept (reservoir sampled), so arbitrarily long
+    // logs train in bounded memory.
+    size_t train_from_log(HistoryLogReader& reader, int epochs = 10, size_t max_rows = 1000000,
+                          uint32_t seed = 42) {
+        int dim = reader.get_feature_dim() + 1;
+        struct Rows {
+            vector<float> X, Y;
+            size_t seen = 0;
+        };
+        map<uint16_t, Rows> per_backend;
+        mt19937_64 gen(seed);
+        vector<float> x(dim);
+        vector<double> features(reader.get_feature_dim());
+
+        reader.for_each_block([&](const LogBlock& block) {
+            for(uint32_t i = 0; i < block.count; i++) {
+                Rows& rows = per_backend[block.backend_id[i]];
+                size_t slot = rows.seen++;
+                if(slot >= max_rows) {
+                    slot = uniform_int_distribution<size_t>(0, slot)(gen);
+                    if(slot >= max_rows) continue;
+                } else {
+                    rows.X.resize(rows.X.size() + dim);
+                    rows.Y.resize(rows.Y.size() + MlpRegressor::OUTPUTS);
+                }
+                for(size_t f = 0; f < features.size(); f++) features[f] = block.feature_column(f)[i];
+                MlpRegressor::build_input(features.data(), features.size(), block.shots[i], dim,
+                                          &rows.X[slot * dim]);
+                rows.Y[slot * 2] = log1p(max(0.0f, block.runtime_ms[i]));
+                rows.Y[slot * 2 + 1] = block.fidelity[i];
+            }
+        });
+
+        size_t trained_rows = 0;
+        for(auto& [id, rows] : per_backend) {
+            MlpRegressor model;
+            model.train(rows.X, rows.Y, dim, epochs, 1e-3f, seed + id);
+            models[reader.backend_names()[id]] = move(model);
+            trained_rows += rows.Y.size() / 2;
+        }
+        return trained_rows;
+    }
+
+    bool empty() const { return models.empty(); }
+
+    vector<string> backends() const {
+        vector<string> names;
+        for(const auto& entry : models) names.push_back(entry.first);
+        return names;
+    }
+
+    bool predict(const string& backend, const double* features, size_t dim, int shots,
+                 PerformancePrediction& prediction) const {
+        auto it = models.find(backend);
+        if(it == models.end()) return false;
+        float x[256];
+        int input_dim = min(it->second.get_input_dim(), 256);
+        MlpRegressor::build_input(features, dim, shots, input_dim, x);
+        prediction = it->second.predict_raw(x);
+        return true;
+    }
+
+    // Backend with the best predicted fidelity among those predicted to finish
+    // within target_latency; the fastest backend if none does
+    string select_backend(const vector<double>& features, int shots, double target_latency,
+                          PerformancePrediction* chosen = nullptr) const {
+        string best, fastest;
+        PerformancePrediction best_pred{0, -1}, fastest_pred{1e300, 0};
+        for(const auto& [backend, model] : models) {
+            PerformancePrediction pred{0, 0};
+            predict(backend, features.data(), features.size(), shots, pred);
+            if(pred.runtime_ms < fastest_pred.runtime_ms) {
+                fastest = backend;
+                fastest_pred = pred;
+            }
+            bool meets_latency = target_latency <= 0 || pred.runtime_ms <= target_latency;
+            if(meets_latency && pred.fidelity > best_pred.fidelity) {
+                best = backend;
+                best_pred = pred;
+            }
+        }
+        if(best.empty()) {
+            best = fastest;
+            best_pred = fastest_pred;
+        }
+        if(chosen) *chosen = best_pred;
+        return best;
+    }
+
+    void save(const string& path) const {
+        ofstream out(path, ios::binary);
+        if(!out) throw runtime_error("Cannot write predictor model: " + path);
+        out.write(MAGIC, 4);
+        uint32_t version = VERSION, count = models.size();
+        out.write((const char*)&version, sizeof(version));
+        out.write((const char*)&count, sizeof(count));
+        for(const auto& [backend, model] : models) {
+            uint16_t len = backend.size();
+            out.write((const char*)&len, sizeof(len));
+            out.write(backend.data(), len);
+            model.save(out);
+        }
+    }
+
+    void load(const string& path) {
+        ifstream in(path, ios::binary);
+        if(!in) throw runtime_error("Cannot open predictor model: " + path);
+        char magic[4];
+        uint32_t version, count;
+        in.read(magic, 4);
+        in.read((char*)&version, sizeof(version));
+        in.read((char*)&count, sizeof(count));
+        if(!in || memcmp(magic, MAGIC, 4) != 0 || version != VERSION) {
+            throw runtime_error("Unsupported predictor model: " + path);
+        }
+        models.clear();
+        for(uint32_t i = 0; i < count; i++) {
+            uint16_t len;
+            in.read((char*)&len, sizeof(len));
+            string backend(len, '\0');
+            in.read(&backend[0], len);
+            models[backend].load(in);
+        }
+    }
+};
@@ -0,0 +1,124 @@
+/*
+ * Policy Replay Tool - Off-policy evaluation over a history log
+ * (see ml_policy_replay.h for the estimators)
+ *
+ * Policies:
+ *   linucb                            the served bandit, trained on --train
+ *   similarity[:eps,min_sim,top_k]    epsilon-greedy similarity voting
+ *   fixed:<shots>:<backend>           one configuration for every job
+ *
+ * Without --train the learned policies are fitted on the evaluation log
+ * itself, which flatters them; pass an earlier log to avoid that.
+ */
+
+#include <iostream>
+#include <memory>
+#include "ml_policy_replay.h"
+
+using namespace std;
+
+static void write_estimate(const PolicyEstimate& estimate) {
+    cout << "{\"name\":\"" << estimate.name << "\""
+         << ",\"records\":" << estimate.records
+         << ",\"match_rate\":" << estimate.match_rate
+         << ",\"unsupported_mass\":" << estimate.unsupported_mass
+         << ",\"effective_sample_size\":" << estimate.effective_sample_size;
+    for(int k = 0; k < REPLAY_OUTCOMES; k++) {
+        const OutcomeEstimate& outcome = estimate.outcomes[k];
+        cout << ",\"" << REPLAY_OUTCOME_NAMES[k] << "\":{\"ips\":" << outcome.ips
+             << ",\"snips\":" << outcome.snips << ",\"dr\":" << outcome.dr << "}";
+    }
+    cout << ",\"seconds\":" << estimate.seconds
+         << ",\"records_per_second\":" << estimate.records_per_second << "}";
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 3) {
+        cerr << "Usage: " << argv[0] << " <history_log> <policy>... [--train <log>] [--reference <records>]"
+             << " [--threads <n>] [--max-weight <w>] [--default-shots <n>] [--default-backend <name>]" << endl;
+        return 1;
+    }
+
+    string log_path = argv[1], train_path;
+    vector<string> specs;
+    ReplayOptions options;
+    size_t reference_size = 2000;
+    int default_shots = 1000;
+    string default_backend = "quantum";
+    for(int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(arg == "--train" && has_value) train_path = argv[++i];
+        else if(arg == "--reference" && has_value) reference_size = stoul(argv[++i]);
+        else if(arg == "--threads" && has_value) options.threads = stoul(argv[++i]);
+        else if(arg == "--max-weight" && has_value) options.max_weight = stod(argv[++i]);
+        else if(arg == "--default-shots" && has_value) default_shots = stoi(argv[++i]);
+        else if(arg == "--default-backend" && has_value) default_backend = argv[++i];
+        else specs.push_back(arg);
+    }
+
+    try {
+        HistoryLogReader log(log_path);
+        unique_ptr<HistoryLogReader> train_log;
+        if(!train_path.empty()) train_log = make_unique<HistoryLogReader>(train_path);
+        HistoryLogReader& train = train_log ? *train_log : log;
+
+        // Trained lazily so policies that do not need them cost nothing
+        ReinforcementEngine engine;
+        bool engine_trained = false;
+        vector<HistoricalExecution> reference;
+        bool reference_loaded = false;
+
+        vector<ReplayPolicy> policies;
+        for(const string& spec : specs) {
+            if(spec == "linucb") {
+                if(!engine_trained) train.feed(engine);
+                engine_trained = true;
+                policies.push_back(linucb_policy(engine, default_shots, default_backend));
+            } else if(spec.rfind("similarity", 0) == 0) {
+                SimilarityVotingParams params;
+                if(spec.size() > 11 && spec[10] == ':') {
+                    string values = spec.substr(11);
+                    for(char& c : values) if(c == ',') c = ' ';
+                    istringstream in(values);
+                    in >> params.epsilon >> params.min_similarity >> params.top_k;
+                    if(in.fail()) throw runtime_error("Bad similarity policy: " + spec);
+                }
+                if(!reference_loaded) reference = load_reference_history(train, reference_size);
+                reference_loaded = true;
+                policies.push_back(similarity_policy(engine, reference, params, default_shots, default_backend));
+            } else if(spec.rfind("fixed:", 0) == 0) {
+                size_t colon = spec.find(':', 6);
+                if(colon == string::npos) throw runtime_error("Bad fixed policy: " + spec);
+                policies.push_back(fixed_policy(stoi(spec.substr(6, colon - 6)), spec.substr(colon + 1)));
+            } else {
+                throw runtime_error("Unknown policy: " + spec);
+            }
+        }
+
+        auto start = chrono::steady_clock::now();
+        PolicyReplay replay(log, options);
+        double fit_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        vector<PolicyEstimate> estimates = replay.evaluate(policies);
+
+        cout << "{\"records\":" << replay.record_count()
+             << ",\"arms\":" << replay.arm_count()
+             << ",\"fit_seconds\":" << fit_seconds
+             << ",\"trained_on_evaluation_log\":" << (train_log ? "false" : "true")
+             << ",\"logged\":{";
+        for(int k = 0; k < REPLAY_OUTCOMES; k++) {
+            if(k > 0) cout << ",";
+            cout << "\"" << REPLAY_OUTCOME_NAMES[k] << "\":" << replay.logged_mean_of(k);
+        }
+        cout << "},\"policies\":[";
+        for(size_t p = 0; p < estimates.size(); p++) {
+            if(p > 0) cout << ",";
+            write_estimate(estimates[p]);
+        }
+        cout << "]}" << endl;
+    } catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,411 @@
+/*
+ * Policy Replay - Counterfactual evaluation of recommendation policies
+ * Streams a history log (see ml_history_log.h) through candidate policies
+ * and estimates what each would have achieved on the logged jobs, without
+ * serving it any traffic. Actions are (backend, snapped shots) arms as in
+ * the bandit; a policy returns a distribution over them per context.
+ *
+ *     IPS    mean of w * y,  w = pi(a|x) / mu(a) clipped at max_weight
+ *     SNIPS  IPS divided by the mean weight
+ *     DR     sum_a pi(a|x) q(x, a) + w * (y - q(x, a_logged))
+ *
+ * for y = reward, runtime_ms and fidelity. The log carries no propensities,
+ * so mu(a) is the logged share of each arm. q is a ridge regression of the
+ * outcomes on [features, 1], one per arm plus a pooled one for arms the log
+ * never took, fitted on the same log in a first pass. DR is unbiased when
+ * either mu or q is right and has far less variance than IPS when the
+ * policy rarely agrees with what was logged, so it is the number to tune on.
+ *
+ * Both passes spread log blocks over all cores with per-worker sums, so a
+ * million records take seconds per policy; similarity voting costs O(reference
+ * size) per record, which is why it votes over a bounded reference history.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "ml_history_log.h"
+
+using namespace std;
+
+struct PolicyAction {
+    string backend;
+    int shots;
+    double probability;
+};
+
+struct ReplayPolicy {
+    string name;
+    // Fills actions with the policy's distribution for one feature vector
+    function<void(const vector<double>& features, vector<PolicyAction>& actions)> act;
+};
+
+struct ReplayOptions {
+    double max_weight = 50.0;  // Importance weight clip
+    double ridge = 1.0;        // L2 penalty of the outcome models
+    unsigned threads = 0;      // 0 = hardware concurrency
+};
+
+// Outcomes in a fixed order: reward, runtime_ms, fidelity
+const int REPLAY_OUTCOMES = 3;
+const char* const REPLAY_OUTCOME_NAMES[REPLAY_OUTCOMES] = {"reward", "runtime_ms", "fidelity"};
+
+struct OutcomeEstimate {
+    double ips = 0.0;
+    double snips = 0.0;
+    double dr = 0.0;
+};
+
+struct PolicyEstimate {
+    string name;
+    size_t records = 0;
+    double match_rate = 0.0;          // Mean pi(logged arm | x)
+    double unsupported_mass = 0.0;    // Mean probability on arms never logged
+    double effective_sample_size = 0.0;
+    array<OutcomeEstimate, REPLAY_OUTCOMES> outcomes;
+    double seconds = 0.0;             // Replay time summed over workers
+    double records_per_second = 0.0;
+};
+
+// Ridge regression of every outcome on x = [features, 1]
+class OutcomeModel {
+private:
+    size_t d;
+    vector<double> xtx, xty, theta;
+
+public:
+    size_t count = 0;
+
+    explicit OutcomeModel(size_t dim = 0) : d(dim), xtx(dim * dim, 0.0), xty(REPLAY_OUTCOMES * dim, 0.0) {}
+
+    void add(const double* x, const double* y) {
+        for(size_t i = 0; i < d; i++) {
+            for(size_t j = 0; j <= i; j++) xtx[i * d + j] += x[i] * x[j];
+            for(int k = 0; k < REPLAY_OUTCOMES; k++) xty[k * d + i] += x[i] * y[k];
+        }
+        count++;
+    }
+
+    void merge(const OutcomeModel& other) {
+        for(size_t i = 0; i < xtx.size(); i++) xtx[i] += other.xtx[i];
+        for(size_t i = 0; i < xty.size(); i++) xty[i] += other.xty[i];
+        count += other.count;
+    }
+
+    // Cholesky solve of (X^T X + ridge I) theta = X^T y; the bias is not penalised
+    void fit(double ridge) {
+        vector<double> l(d * d, 0.0);
+        for(size_t i = 0; i < d; i++) {
+            for(size_t j = 0; j <= i; j++) {
+                double sum = xtx[i * d + j] + (i == j && i + 1 < d ? ridge : 0.0);
+                for(size_t k = 0; k < j; k++) sum -= l[i * d + k] * l[j * d + k];
+                if(i == j) l[i * d + i] = sqrt(max(sum, 1e-9));
+                else l[i * d + j] = sum / l[j * d + j];
+            }
+        }
+        theta.assign(REPLAY_OUTCOMES * d, 0.0);
+        for(int k = 0; k < REPLAY_OUTCOMES; k++) {
+            double* t = &theta[k * d];
+            for(size_t i = 0; i < d; i++) {
+                double sum = xty[k * d + i];
+                for(size_t j = 0; j < i; j++) sum -= l[i * d + j] * t[j];
+                t[i] = sum / l[i * d + i];
+            }
+            for(size_t i = d; i-- > 0;) {
+                double sum = t[i];
+                for(size_t j = i + 1; j < d; j++) sum -= l[j * d + i] * t[j];
+                t[i] = sum / l[i * d + i];
+            }
+        }
+    }
+
+    void predict(const double* x, double* y) const {
+        for(int k = 0; k < REPLAY_OUTCOMES; k++) {
+            double sum = 0.0;
+            for(size_t i = 0; i < d; i++) sum += theta[k * d + i] * x[i];
+            y[k] = sum;
+        }
+    }
+};
+
+class PolicyReplay {
+private:
+    HistoryLogReader& log;
+    ReplayOptions options;
+    size_t feature_dim;
+
+    vector<LogBlock> blocks;
+    vector<size_t> block_start;           // Index of each block's first record
+    vector<int> record_arm;               // Arm of every logged record
+    map<pair<string, int>, int> arm_ids;  // (backend, snapped shots) -> arm
+    vector<double> arm_share;             // mu(a)
+    vector<OutcomeModel> models;          // One per arm, pooled model last
+    size_t records = 0;
+    double logged_mean[REPLAY_OUTCOMES] = {0.0, 0.0, 0.0};
+
+    // Runs work(block, worker) over every block on the pool
+    void for_each_block_parallel(unsigned workers, const function<void(size_t, unsigned)>& work) const {
+        atomic<size_t> next(0);
+        atomic<bool> failed(false);
+        exception_ptr error;
+        auto run = [&](unsigned worker) {
+            for(size_t b = next++; b < blocks.size() && !failed; b = next++) {
+                try {
+                    work(b, worker);
+                } catch(...) {
+                    if(!failed.exchange(true)) error = current_exception();
+                }
+            }
+        };
+        vector<thread> pool;
+        for(unsigned t = 1; t < workers; t++) pool.emplace_back(run, t);
+        run(0);
+        for(thread& worker : pool) worker.join();
+        if(error) rethrow_exception(error);
+    }
+
+    unsigned worker_count() const {
+        unsigned count = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+        return min<size_t>(count, max<size_t>(1, blocks.size()));
+    }
+
+    // x = [features, 1] and the outcomes of record i of a block
+    void load_record(const LogBlock& block, uint32_t i, double* x, double* y) const {
+        for(size_t f = 0; f < feature_dim; f++) x[f] = block.features[f * block.count + i];
+        x[feature_dim] = 1.0;
+        y[0] = block.reward[i];
+        y[1] = block.runtime_ms[i];
+        y[2] = block.fidelity[i];
+    }
+
+    // Index pass: collects blocks and arms; fit pass: outcome models per worker, merged
+    void build() {
+        log.for_each_block([&](const LogBlock& block) {
+            blocks.push_back(block);
+            block_start.push_back(records);
+            records += block.count;
+        });
+        const vector<string>& backends = log.backend_names();
+
+        vector<size_t> counts;
+        record_arm.resize(records);
+        for(size_t b = 0; b < blocks.size(); b++) {
+            const LogBlock& block = blocks[b];
+            for(uint32_t i = 0; i < block.count; i++) {
+                auto key = make_pair(backends[block.backend_id[i]], ReinforcementEngine::snap_shots(block.shots[i]));
+                auto it = arm_ids.find(key);
+                if(it == arm_ids.end()) {
+                    it = arm_ids.emplace(key, counts.size()).first;
+                    counts.push_back(0);
+                }
+                counts[it->second]++;
+                record_arm[block_start[b] + i] = it->second;
+            }
+        }
+        for(size_t count : counts) arm_share.push_back(double(count) / records);
+
+        size_t arms = counts.size();
+        unsigned workers = worker_count();
+        vector<vector<OutcomeModel>> partial(workers, vector<OutcomeModel>(arms + 1, OutcomeModel(feature_dim + 1)));
+        vector<array<double, REPLAY_OUTCOMES>> sums(workers, {0.0, 0.0, 0.0});
+        for_each_block_parallel(workers, [&](size_t b, unsigned worker) {
+            const LogBlock& block = blocks[b];
+            vector<double> x(feature_dim + 1);
+            double y[REPLAY_OUTCOMES];
+            for(uint32_t i = 0; i < block.count; i++) {
+                load_record(block, i, x.data(), y);
+                partial[worker][record_arm[block_start[b] + i]].add(x.data(), y);
+                partial[worker][arms].add(x.data(), y);
+                for(int k = 0; k < REPLAY_OUTCOMES; k++) sums[worker][k] += y[k];
+            }
+        });
+
+        models = move(partial[0]);
+        for(unsigned w = 1; w < workers; w++) {
+            for(size_t a = 0; a <= arms; a++) models[a].merge(partial[w][a]);
+        }
+        for(OutcomeModel& model : models) model.fit(options.ridge);
+        for(int k = 0; k < REPLAY_OUTCOMES; k++) {
+            for(unsigned w = 0; w < workers; w++) logged_mean[k] += sums[w][k];
+            logged_mean[k] /= max<size_t>(1, records);
+        }
+    }
+
+    // Per-worker accumulators for one policy
+    struct Sums {
+        double match = 0.0, unsupported = 0.0, weight = 0.0, weight_sq = 0.0, seconds = 0.0;
+        double weighted[REPLAY_OUTCOMES] = {0.0, 0.0, 0.0};
+        double dr[REPLAY_OUTCOMES] = {0.0, 0.0, 0.0};
+    };
+
+    void replay_block(const ReplayPolicy& policy, const LogBlock& block, size_t first, Sums& sums) const {
+        vector<double> features(feature_dim), x(feature_dim + 1);
+        vector<PolicyAction> actions;
+        double y[REPLAY_OUTCOMES], q[REPLAY_OUTCOMES], q_logged[REPLAY_OUTCOMES];
+
+        for(uint32_t i = 0; i < block.count; i++) {
+            load_record(block, i, x.data(), y);
+            copy(x.begin(), x.begin() + feature_dim, features.begin());
+            int logged = record_arm[first + i];
+
+            actions.clear();
+            policy.act(features, actions);
+
+            double pi_logged = 0.0, direct[REPLAY_OUTCOMES] = {0.0, 0.0, 0.0};
+            for(const PolicyAction& action : actions) {
+                auto it = arm_ids.find(make_pair(action.backend, ReinforcementEngine::snap_shots(action.shots)));
+                int arm = it == arm_ids.end() ? -1 : it->second;
+                if(arm < 0) sums.unsupported += action.probability;
+                if(arm == logged) pi_logged += action.probability;
+                models[arm < 0 ? models.size() - 1 : arm].predict(x.data(), q);
+                for(int k = 0; k < REPLAY_OUTCOMES; k++) direct[k] += action.probability * q[k];
+            }
+
+            double w = min(options.max_weight, pi_logged / arm_share[logged]);
+            models[logged].predict(x.data(), q_logged);
+            for(int k = 0; k < REPLAY_OUTCOMES; k++) {
+                sums.weighted[k] += w * y[k];
+                sums.dr[k] += direct[k] + w * (y[k] - q_logged[k]);
+            }
+            sums.match += pi_logged;
+            sums.weight += w;
+            sums.weight_sq += w * w;
+        }
+    }
+
+public:
+    // Indexes the log and fits the outcome models (two parallel passes)
+    PolicyReplay(HistoryLogReader& history, ReplayOptions replay_options = ReplayOptions())
+        : log(history), options(replay_options), feature_dim(history.get_feature_dim()) {
+        build();
+    }
+
+    size_t record_count() const { return records; }
+    size_t arm_count() const { return arm_share.size(); }
+    double logged_mean_of(int outcome) const { return logged_mean[outcome]; }
+
+    // Logged share of each arm, keyed by (backend, snapped shots)
+    map<pair<string, int>, double> logging_distribution() const {
+        map<pair<string, int>, double> shares;
+        for(const auto& [key, arm] : arm_ids) shares[key] = arm_share[arm];
+        return shares;
+    }
+
+    // Replays every record through each policy; policies run one after the
+    // other so each gets all cores and its own throughput figure
+    vector<PolicyEstimate> evaluate(const vector<ReplayPolicy>& policies) const {
+        vector<PolicyEstimate> estimates;
+        unsigned workers = worker_count();
+        for(const ReplayPolicy& policy : policies) {
+            vector<Sums> partial(workers);
+            auto start = chrono::steady_clock::now();
+            for_each_block_parallel(workers, [&](size_t b, unsigned worker) {
+                auto block_start_time = chrono::steady_clock::now();
+                replay_block(policy, blocks[b], block_start[b], partial[worker]);
+                partial[worker].seconds += chrono::duration<double>(chrono::steady_clock::now() - block_start_time).count();
+            });
+            double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            Sums total;
+            for(const Sums& sums : partial) {
+                total.match += sums.match;
+                total.unsupported += sums.unsupported;
+                total.weight += sums.weight;
+                total.weight_sq += sums.weight_sq;
+                total.seconds += sums.seconds;
+                for(int k = 0; k < REPLAY_OUTCOMES; k++) {
+                    total.weighted[k] += sums.weighted[k];
+                    total.dr[k] += sums.dr[k];
+                }
+            }
+
+            PolicyEstimate estimate;
+            estimate.name = policy.name;
+            estimate.records = records;
+            double n = max<size_t>(1, records);
+            estimate.match_rate = total.match / n;
+            estimate.unsupported_mass = total.unsupported / n;
+            estimate.effective_sample_size = total.weight_sq > 0 ? total.weight * total.weight / total.weight_sq : 0.0;
+            for(int k = 0; k < REPLAY_OUTCOMES; k++) {
+                estimate.outcomes[k].ips = total.weighted[k] / n;
+                estimate.outcomes[k].snips = total.weight > 0 ? total.weighted[k] / total.weight : 0.0;
+                estimate.outcomes[k].dr = total.dr[k] / n;
+            }
+            estimate.seconds = total.seconds;
+            estimate.records_per_second = wall > 0 ? records / wall : 0.0;
+            estimates.push_back(estimate);
+        }
+        return estimates;
+    }
+};
+
+// Always the same configuration
+inline ReplayPolicy fixed_policy(int shots, const string& backend) {
+    return {"fixed:" + to_string(shots) + ":" + backend,
+            [shots, backend](const vector<double>&, vector<PolicyAction>& actions) {
+                actions.push_back({backend, shots, 1.0});
+            }};
+}
+
+// LinUCB as served by the recommendation server (deterministic)
+inline ReplayPolicy linucb_policy(const ReinforcementEngine& engine, int default_shots, const string& default_backend) {
+    return {"linucb",
+            [&engine, default_shots, default_backend](const vector<double>& features, vector<PolicyAction>& actions) {
+                Recommendation rec = engine.recommend(features, default_shots, default_backend);
+                actions.push_back({rec.recommended_backend, rec.recommended_shots, 1.0});
+            }};
+}
+
+// Epsilon-greedy similarity voting over a reference history, with the
+// exploration step spread over its nine equally likely choices
+inline ReplayPolicy similarity_policy(const ReinforcementEngine& engine, const vector<HistoricalExecution>& reference,
+                                      const SimilarityVotingParams& params, int default_shots, const string& default_backend) {
+    ostringstream name;
+    name << "similarity:" << params.epsilon << "," << params.min_similarity << "," << params.top_k;
+    vector<pair<int, string>> explore = ReinforcementEngine::exploration_actions(default_shots);
+    return {name.str(),
+            [&engine, &reference, params, default_shots, default_backend, explore](
+                const vector<double>& features, vector<PolicyAction>& actions) {
+                Recommendation rec;
+                if(!engine.similarity_vote(features, reference, params, default_shots, default_backend, rec)) {
+                    actions.push_back({rec.recommended_backend, rec.recommended_shots, 1.0});
+                    return;
+                }
+                actions.push_back({rec.recommended_backend, rec.recommended_shots, 1.0 - params.epsilon});
+                for(const auto& [shots, backend] : explore) {
+                    actions.push_back({backend, shots, params.epsilon / explore.size()});
+                }
+            }};
+}
+
+// First limit records of a log, as similarity voting's reference history
+inline vector<HistoricalExecution> load_reference_history(HistoryLogReader& reader, size_t limit) {
+    vector<HistoricalExecution> history;
+    size_t dim = reader.get_feature_dim();
+    reader.for_each_block([&](const LogBlock& block) {
+        for(uint32_t i = 0; i < block.count && history.size() < limit; i++) {
+            HistoricalExecution exec;
+            exec.features.resize(dim);
+            for(size_t f = 0; f < dim; f++) exec.features[f] = block.features[f * block.count + i];
+            exec.shots_used = block.shots[i];
+            exec.backend_used = reader.backend_names()[block.backend_id[i]];
+            exec.fidelity_achieved = block.fidelity[i];
+            exec.runtime_ms = block.runtime_ms[i];
+            exec.reward_score = block.reward[i];
+            history.push_back(move(exec));
+        }
+    });
+    return history;
+}
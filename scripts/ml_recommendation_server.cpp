@@ -0,0 +1,479 @@
+/*
+ * ML Recommendation Server - Long-running vectorizer + RL engine daemon
+ * Keeps the bandit statistics learned from execution history resident and
+ * serves requests concurrently from a thread pool, instead of spawning one
+ * CLI process per request.
+ *
+ * Line protocol (one request per line, tab-separated fields):
+ *   <id>  vectorize  <features_json>
+ *   <id>  recommend  <features_json|vector>  <default_shots>  <default_backend>
+ *   <id>  record     <features_json|vector>  <shots>  <backend>  <fidelity>  <runtime_ms>  <target_latency>
+ *   <id>  predict    <features_json|vector>  <shots>  <target_latency>
+ *   <id>  stats
+ *   <id>  metrics    [json|prometheus]
+ *   <id>  ping
+ *
+ * Every request is answered with "<id>\t<json>". Requests may be pipelined:
+ * clients can send many lines without waiting, and responses are written as
+ * soon as they complete, so they can arrive out of order. Requests are not
+ * ordered relative to each other; wait for a record response before relying
+ * on it in a later recommend. Prometheus metrics come back as one JSON
+ * string ({"prometheus":"..."}) so every response stays on one line.
+ * With --history, recorded executions reach the log in column blocks at
+ * most --flush-ms (default 1000) after they are recorded, and on EOF,
+ * SIGINT or SIGTERM.
+ *
+ * ml_server_client.py drives a pipelined batch over both transports and
+ * checks the responses.
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <atomic>
+#include <csignal>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "ml_feature_vectorizer.h"
+#include "ml_reinforcement_engine.h"
+#include "ml_history_log.h"
+#include "ml_performance_predictor.h"
+#include "core/metrics.h"
+
+using namespace std;
+
+class ThreadPool {
+private:
+    vector<thread> workers;
+    queue<function<void()>> tasks;
+    mutex queue_mutex;
+    condition_variable cv;
+    bool stopping;
+
+public:
+    ThreadPool(size_t num_threads) : stopping(false) {
+        for(size_t i = 0; i < num_threads; i++) {
+            workers.emplace_back([this]() {
+                while(true) {
+                    function<void()> task;
+                    {
+                        unique_lock<mutex> lock(queue_mutex);
+                        cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                        if(stopping && tasks.empty()) return;
+                        task = move(tasks.front());
+                        tasks.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    // Drains queued tasks before joining
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for(auto& worker : workers) worker.join();
+    }
+
+    void submit(function<void()> task) {
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            tasks.push(move(task));
+        }
+        cv.notify_one();
+    }
+
+    size_t size() const { return workers.size(); }
+};
+
+// Split a request line on tabs
+vector<string> split_fields(const string& line) {
+    vector<string> fields;
+    size_t start = 0;
+    while(true) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == string::npos ? string::npos : tab - start));
+        if(tab == string::npos) break;
+        start = tab + 1;
+    }
+    return fields;
+}
+
+string json_error(const string& message) {
+    return "{\"error\":\"" + json_escape(message) + "\"}";
+}
+
+class RecommendationService {
+private:
+    FeatureVectorizer vectorizer;
+    ReinforcementEngine engine;
+    PerformancePredictor predictor;
+    mutable shared_mutex engine_mutex;
+    atomic<long> requests_served{0};
+
+    // Records are buffered in the writer and written as one DATA block when
+    // it fills or every flush_interval, so neither a syscall nor a one-row
+    // block happens per record. log_mutex is never taken with engine_mutex.
+    unique_ptr<HistoryLogWriter> history_log;
+    mutex log_mutex;
+    condition_variable flusher_wake;
+    thread log_flusher;
+    bool stopping = false;
+    chrono::milliseconds flush_interval{1000};
+
+    void flusher_loop() {
+        unique_lock<mutex> lock(log_mutex);
+        while(!stopping) {
+            flusher_wake.wait_for(lock, flush_interval, [this]() { return stopping; });
+            try {
+                history_log->flush();
+            } catch(const exception& e) {
+                cerr << "Error: " << e.what() << endl;
+            }
+        }
+    }
+
+    // Accepts either a raw feature vector or a circuit description
+    vector<double> resolve_features(const string& payload) const {
+        size_t first = payload.find_first_not_of(" \t");
+        if(first != string::npos && payload[first] == '[') {
+            return parse_feature_vector(payload);
+        }
+        return vectorizer.vectorize(parse_features(payload));
+    }
+
+    // Latency target carried in a circuit description, 0 for raw vectors
+    static double target_latency_of(const string& payload) {
+        size_t first = payload.find_first_not_of(" \t");
+        if(first != string::npos && payload[first] == '[') return 0.0;
+        return parse_features(payload).target_latency;
+    }
+
+public:
+    // fields: <features> <shots> <backend> <fidelity> <runtime_ms> <target_latency>
+    HistoricalExecution parse_record(const vector<string>& fields, size_t offset) const {
+        if(fields.size() < offset + 6) {
+            throw runtime_error("record expects 6 fields");
+        }
+        HistoricalExecution exec;
+        exec.features = resolve_features(fields[offset]);
+        exec.shots_used = stoi(fields[offset + 1]);
+        exec.backend_used = fields[offset + 2];
+        exec.fidelity_achieved = stod(fields[offset + 3]);
+        exec.runtime_ms = stod(fields[offset + 4]);
+        double target_latency = stod(fields[offset + 5]);
+        exec.reward_score = engine.calculate_reward(
+            exec.fidelity_achieved, exec.runtime_ms, target_latency);
+        return exec;
+    }
+
+    ~RecommendationService() {
+        if(log_flusher.joinable()) {
+            {
+                lock_guard<mutex> lock(log_mutex);
+                stopping = true;
+            }
+            flusher_wake.notify_one();
+            log_flusher.join();
+        }
+        // history_log flushes what is left when it is destroyed
+    }
+
+    // Recorded executions are appended to the log so a restart resumes
+    // (logged first, so a record the log rejects is not learned either)
+    void add_execution(const HistoricalExecution& exec) {
+        if(history_log) {
+            lock_guard<mutex> lock(log_mutex);
+            history_log->append(exec);
+        }
+        unique_lock<shared_mutex> lock(engine_mutex);
+        engine.observe(exec);
+    }
+
+    void flush_history() {
+        if(!history_log) return;
+        lock_guard<mutex> lock(log_mutex);
+        history_log->flush();
+    }
+
+    void load_model(const string& path) {
+        predictor.load(path);
+    }
+
+    // Replays a binary history log (see ml_history_log.h), then keeps it
+    // open for appending, flushed every interval
+    size_t load_history(const string& path, chrono::milliseconds interval) {
+        size_t loaded = 0;
+        uint16_t feature_dim = 12;
+        if(access(path.c_str(), F_OK) == 0) {
+            HistoryLogReader reader(path);
+            loaded = reader.feed(engine);
+            feature_dim = reader.get_feature_dim();
+        }
+        history_log = make_unique<HistoryLogWriter>(path, feature_dim);
+        flush_interval = interval;
+        log_flusher = thread([this]() { flusher_loop(); });
+        return loaded;
+    }
+
+    string handle(const vector<string>& fields) {
+        requests_served++;
+        const string& command = fields.size() > 1 ? fields[1] : "";
+
+        if(command == "ping") {
+            return "{\"ok\":true}";
+        }
+        if(command == "vectorize") {
+            if(fields.size() < 3) return json_error("vectorize expects <features_json>");
+            return vector_to_json(vectorizer.vectorize(parse_features(fields[2])));
+        }
+        if(command == "recommend") {
+            if(fields.size() < 5) {
+                return json_error("recommend expects <features> <default_shots> <default_backend>");
+            }
+            vector<double> features = resolve_features(fields[2]);
+            int default_shots = stoi(fields[3]);
+
+            // Skip backends the predictor expects to miss the latency target
+            set<string> too_slow;
+            double target_latency = target_latency_of(fields[2]);
+            if(!predictor.empty() && target_latency > 0) {
+                for(const auto& backend : predictor.backends()) {
+                    PerformancePrediction pred{0, 0};
+                    predictor.predict(backend, features.data(), features.size(), default_shots, pred);
+                    if(pred.runtime_ms > target_latency) too_slow.insert(backend);
+                }
+            }
+
+            shared_lock<shared_mutex> lock(engine_mutex);
+            Recommendation rec = engine.recommend(features, default_shots, fields[4], &too_slow);
+            return recommendation_to_json(rec);
+        }
+        if(command == "predict") {
+            if(fields.size() < 5) return json_error("predict expects <features> <shots> <target_latency>");
+            if(predictor.empty()) return json_error("No predictor model loaded (--model)");
+            vector<double> features = resolve_features(fields[2]);
+            int shots = stoi(fields[3]);
+            PerformancePrediction pred{0, 0};
+            string backend = predictor.select_backend(features, shots, stod(fields[4]), &pred);
+            ostringstream out;
+            out << "{\"backend\":\"" << json_escape(backend) << "\",\"runtime_ms\":" << pred.runtime_ms
+                << ",\"fidelity\":" << pred.fidelity << "}";
+            return out.str();
+        }
+        if(command == "record") {
+            HistoricalExecution exec = parse_record(fields, 2);
+            double reward = exec.reward_score;
+            add_execution(exec);
+            ostringstream out;
+            out << "{\"recorded\":true,\"reward\":" << reward << "}";
+            return out.str();
+        }
+        if(command == "stats") {
+            shared_lock<shared_mutex> lock(engine_mutex);
+            ostringstream out;
+            out << "{\"observations\":" << engine.observation_count()
+                << ",\"arms\":" << engine.arm_count()
+                << ",\"requests_served\":" << requests_served.load() << "}";
+            return out.str();
+        }
+        if(command == "metrics") {
+            string format = fields.size() > 2 ? fields[2] : "json";
+            if(format == "json") return metrics_json();
+            if(format != "prometheus") return json_error("metrics expects json or prometheus");
+            return "{\"prometheus\":\"" + json_escape(metrics_prometheus()) + "\"}";
+        }
+        return json_error("Unknown command: " + command);
+    }
+};
+
+// Serializes responses from concurrent workers onto one output stream
+class ResponseWriter {
+private:
+    int fd;
+    bool owns_fd;
+    mutex write_mutex;
+
+public:
+    ResponseWriter(int output_fd, bool owns) : fd(output_fd), owns_fd(owns) {}
+    ~ResponseWriter() { if(owns_fd) close(fd); }
+
+    void write_line(const string& line) {
+        lock_guard<mutex> lock(write_mutex);
+        size_t written = 0;
+        while(written < line.size()) {
+            ssize_t n = send_or_write(line.data() + written, line.size() - written);
+            if(n <= 0) return;  // Peer went away
+            written += n;
+        }
+    }
+
+private:
+    ssize_t send_or_write(const char* data, size_t len) {
+        if(owns_fd) return send(fd, data, len, MSG_NOSIGNAL);
+        return write(fd, data, len);
+    }
+};
+
+void dispatch(RecommendationService& service, ThreadPool& pool,
+              shared_ptr<ResponseWriter> writer, string line) {
+    pool.submit([&service, writer, line = move(line)]() {
+        vector<string> fields = split_fields(line);
+        string response;
+        try {
+            response = service.handle(fields);
+        } catch(const exception& e) {
+            response = json_error(e.what());
+        }
+        writer->write_line(fields[0] + "\t" + response + "\n");
+    });
+}
+
+// Reads newline-delimited requests from fd and hands each to the pool
+void serve_stream(int fd, RecommendationService& service, ThreadPool& pool,
+                  shared_ptr<ResponseWriter> writer) {
+    string buffer;
+    char chunk[65536];
+    while(true) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if(n <= 0) break;
+        buffer.append(chunk, n);
+
+        size_t start = 0, newline;
+        while((newline = buffer.find('\n', start)) != string::npos) {
+            string line = buffer.substr(start, newline - start);
+            if(!line.empty() && line.back() == '\r') line.pop_back();
+            if(!line.empty()) dispatch(service, pool, writer, move(line));
+            start = newline + 1;
+        }
+        buffer.erase(0, start);
+    }
+    if(!buffer.empty()) dispatch(service, pool, writer, move(buffer));
+}
+
+int serve_socket(const string& path, RecommendationService& service, ThreadPool& pool) {
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listen_fd < 0) {
+        cerr << "socket: " << strerror(errno) << endl;
+        return 1;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Socket path too long: " << path << endl;
+        return 1;
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+
+    if(::bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 64) < 0) {
+        cerr << "bind/listen " << path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    cerr << "Listening on " << path << " with " << pool.size() << " workers" << endl;
+
+    while(true) {
+        int client_fd = accept(listen_fd, nullptr, nullptr);
+        if(client_fd < 0) {
+            if(errno == EINTR) continue;
+            break;
+        }
+        // One reader thread per connection; the writer closes the fd once
+        // the last in-flight response for this client has been sent
+        thread([client_fd, &service, &pool]() {
+            auto writer = make_shared<ResponseWriter>(client_fd, true);
+            serve_stream(client_fd, service, pool, writer);
+        }).detach();
+    }
+
+    close(listen_fd);
+    unlink(path.c_str());
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    string socket_path;
+    string history_path;
+    string model_path;
+    size_t num_threads = max(1u, thread::hardware_concurrency());
+    int flush_ms = 1000;
+
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(arg == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if(arg == "--history" && i + 1 < argc) {
+            history_path = argv[++i];
+        } else if(arg == "--model" && i + 1 < argc) {
+            model_path = argv[++i];
+        } else if(arg == "--threads" && i + 1 < argc) {
+            num_threads = max(1, stoi(argv[++i]));
+        } else if(arg == "--flush-ms" && i + 1 < argc) {
+            flush_ms = max(1, stoi(argv[++i]));
+        } else {
+            cerr << "Usage: " << argv[0]
+                 << " [--socket <path>] [--history <log>] [--model <file>] [--threads <n>] [--flush-ms <ms>]" << endl;
+            cerr << "Serves stdin/stdout when --socket is not given" << endl;
+            return 1;
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    // SIGINT/SIGTERM are blocked before any thread starts, so every thread
+    // inherits the mask and only the waiter below takes them
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+    RecommendationService service;
+    try {
+        if(!history_path.empty()) {
+            size_t loaded = service.load_history(history_path, chrono::milliseconds(flush_ms));
+            cerr << "Loaded " << loaded << " historical executions" << endl;
+        }
+        if(!model_path.empty()) service.load_model(model_path);
+    } catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    // Buffered records reach the log before the process goes away
+    thread([&service, stop_signals]() {
+        int signal_number;
+        sigwait(&stop_signals, &signal_number);
+        service.flush_history();
+        _exit(0);
+    }).detach();
+
+    if(!socket_path.empty()) {
+        ThreadPool pool(num_threads);
+        return serve_socket(socket_path, service, pool);
+    }
+
+    auto writer = make_shared<ResponseWriter>(STDOUT_FILENO, false);
+    {
+        ThreadPool pool(num_threads);
+        serve_stream(STDIN_FILENO, service, pool, writer);
+    }
+    return 0;
+}
@@ -0,0 +1,409 @@
+/*
+ * Reinforcement Learning Engine - Network Effect Optimizer
+ * Uses historical execution data to optimize shots and backend selection
+ * Implements a LinUCB contextual bandit (Upper Confidence Bound) over
+ * backend x shots arms, plus epsilon-greedy similarity voting over raw history
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <map>
+#include <set>
+
+#include "json_scanner.h"
+#include "core/similarity.h"
+#include "core/metrics.h"
+#include "core/rng.h"
+
+using namespace std;
+
+struct HistoricalExecution {
+    vector<double> features;
+    int shots_used;
+    string backend_used;
+    double fidelity_achieved;
+    double runtime_ms;
+    double reward_score;
+};
+
+struct Recommendation {
+    int recommended_shots;
+    string recommended_backend;
+    double confidence;
+    string reasoning;
+};
+
+// Knobs of similarity voting (recommend() over raw history)
+struct SimilarityVotingParams {
+    double epsilon = 0.15;        // Exploration rate
+    double min_similarity = 0.5;  // Executions below this cosine similarity do not vote
+    int top_k = 10;               // Most similar executions that vote
+};
+
+// LinUCB sufficient statistics for one (backend, shots) arm.
+// A = I + sum(x x^T) is kept as its inverse so updates stay O(d^2).
+struct BanditArm {
+    string backend;
+    int shots;
+    vector<double> A_inv;  // d x d, row-major
+    vector<double> b;      // sum(reward * x)
+    long pulls;
+};
+
+class ReinforcementEngine {
+private:
+    // Exploration draws from a fresh RngStream per call (stream id = call
+    // number), so recommend() needs no lock and replays under a fixed seed
+    uint64_t seed;
+    mutable atomic<uint64_t> exploration_calls{0};
+    
+    SimilarityVotingParams voting;
+    const double ALPHA = 0.3;     // Learning rate
+    const double GAMMA = 0.9;     // Discount factor
+    const double UCB_C = 1.5;     // UCB exploration constant
+    const double REWARD_SCALE = 100.0;  // Bandit learns reward / REWARD_SCALE
+    
+    // Shot counts are bucketed so arms generalize across nearby budgets
+    static inline const vector<int> SHOT_LEVELS = {100, 250, 500, 1000, 2000, 5000, 10000};
+    
+    vector<BanditArm> arms;
+    map<pair<string, int>, size_t> arm_index;
+    size_t context_dim = 0;   // Feature dimension + bias term
+    long total_observations = 0;
+    vector<double> scratch_x, scratch_Ax;
+    
+    // Context = features padded/truncated to context_dim - 1, plus a bias of 1
+    void build_context(const double* features, size_t dim, vector<double>& x) const {
+        x.assign(context_dim, 0.0);
+        size_t n = min(dim, context_dim - 1);
+        for(size_t i = 0; i < n; i++) x[i] = features[i];
+        x[context_dim - 1] = 1.0;
+    }
+    
+    BanditArm& arm_for(const string& backend, int shots) {
+        auto key = make_pair(backend, shots);
+        auto it = arm_index.find(key);
+        if(it != arm_index.end()) return arms[it->second];
+        
+        BanditArm arm;
+        arm.backend = backend;
+        arm.shots = shots;
+        arm.A_inv.assign(context_dim * context_dim, 0.0);
+        for(size_t i = 0; i < context_dim; i++) arm.A_inv[i * context_dim + i] = 1.0;
+        arm.b.assign(context_dim, 0.0);
+        arm.pulls = 0;
+        arm_index[key] = arms.size();
+        arms.push_back(move(arm));
+        return arms.back();
+    }
+    
+    // Upper confidence bound and its exploration width for one arm
+    pair<double, double> score_arm(const BanditArm& arm, const vector<double>& x) const {
+        size_t d = context_dim;
+        double mean = 0.0, variance = 0.0;
+        for(size_t i = 0; i < d; i++) {
+            double theta_i = 0.0, ax_i = 0.0;
+            const double* row = &arm.A_inv[i * d];
+            for(size_t j = 0; j < d; j++) {
+                theta_i += row[j] * arm.b[j];
+                ax_i += row[j] * x[j];
+            }
+            mean += theta_i * x[i];
+            variance += x[i] * ax_i;
+        }
+        double width = UCB_C * sqrt(max(0.0, variance));
+        return {mean + width, width};
+    }
+
+public:
+    explicit ReinforcementEngine(uint64_t rng_seed = rng_default_seed()) : seed(rng_seed) {}
+    
+    // Restarts the exploration streams, e.g. before replaying a request log
+    void reseed(uint64_t rng_seed) {
+        seed = rng_seed;
+        exploration_calls = 0;
+    }
+    
+    double calculate_reward(double fidelity, double runtime_ms, double target_latency) const {
+        // Multi-objective reward: maximize fidelity, minimize runtime deviation
+        double fidelity_reward = fidelity * 100.0;  // 0-100 scale
+        
+        double latency_penalty = 0.0;
+        if(target_latency > 0) {
+            double latency_ratio = abs(runtime_ms - target_latency) / target_latency;
+            latency_penalty = min(50.0, latency_ratio * 25.0);
+        }
+        
+        double efficiency_bonus = max(0.0, 10.0 - log(runtime_ms + 1));
+        
+        return fidelity_reward - latency_penalty + efficiency_bonus;
+    }
+    
+    double cosine_similarity(const vector<double>& v1, const vector<double>& v2) const {
+        return ::cosine_similarity(v1, v2);
+    }
+    
+    // Fold one completed execution into its arm's statistics in O(d^2)
+    // using a Sherman-Morrison update of A^-1
+    void observe(const double* features, size_t dim, int shots, const string& backend, double reward) {
+        if(context_dim == 0) context_dim = dim + 1;
+        
+        BanditArm& arm = arm_for(backend, snap_shots(shots));
+        size_t d = context_dim;
+        build_context(features, dim, scratch_x);
+        scratch_Ax.assign(d, 0.0);
+        
+        double denom = 1.0;
+        for(size_t i = 0; i < d; i++) {
+            const double* row = &arm.A_inv[i * d];
+            double sum = 0.0;
+            for(size_t j = 0; j < d; j++) sum += row[j] * scratch_x[j];
+            scratch_Ax[i] = sum;
+            denom += scratch_x[i] * sum;
+        }
+        
+        // A_inv is symmetric, so x^T A_inv == (A_inv x)^T
+        for(size_t i = 0; i < d; i++) {
+            double scale = scratch_Ax[i] / denom;
+            double* row = &arm.A_inv[i * d];
+            for(size_t j = 0; j < d; j++) row[j] -= scale * scratch_Ax[j];
+        }
+        
+        double r = reward / REWARD_SCALE;
+        for(size_t i = 0; i < d; i++) arm.b[i] += r * scratch_x[i];
+        arm.pulls++;
+        total_observations++;
+    }
+    
+    void observe(const HistoricalExecution& exec) {
+        observe(exec.features.data(), exec.features.size(), exec.shots_used,
+                exec.backend_used, exec.reward_score);
+    }
+    
+    static int snap_shots(int shots) {
+        int best = SHOT_LEVELS[0];
+        for(int level : SHOT_LEVELS) {
+            if(abs(level - shots) < abs(best - shots)) best = level;
+        }
+        return best;
+    }
+    
+    long observation_count() const { return total_observations; }
+    size_t arm_count() const { return arms.size(); }
+    
+    // LinUCB: pick the arm with the highest upper confidence bound.
+    // Cost is O(arms * d^2) regardless of how much history has been observed.
+    // Arms on excluded_backends (e.g. predicted to miss the latency target)
+    // are skipped.
+    Recommendation recommend(
+        const vector<double>& current_features,
+        int default_shots,
+        const string& default_backend,
+        const set<string>* excluded_backends = nullptr
+    ) const {
+        PLANCK_TIME_STAGE(RECOMMEND);
+        if(total_observations == 0) {
+            return {default_shots, default_backend, 0.0, "No historical data, using defaults"};
+        }
+        
+        vector<double> x;
+        build_context(current_features.data(), current_features.size(), x);
+        
+        // The caller's default is always a candidate; if it has never been
+        // tried, its bound is the prior width and UCB will explore it
+        auto default_key = make_pair(default_backend, snap_shots(default_shots));
+        const BanditArm* best = nullptr;
+        double best_bound = -1e300, best_width = 0.0;
+        for(const auto& arm : arms) {
+            if(excluded_backends && excluded_backends->count(arm.backend)) continue;
+            auto [bound, width] = score_arm(arm, x);
+            if(bound > best_bound) {
+                best = &arm;
+                best_bound = bound;
+                best_width = width;
+            }
+        }
+        
+        double prior_width = 0.0;
+        for(double v : x) prior_width += v * v;
+        prior_width = UCB_C * sqrt(prior_width);
+        
+        Recommendation rec;
+        if(!best || (arm_index.count(default_key) == 0 && prior_width > best_bound)) {
+            rec.recommended_shots = default_key.second;
+            rec.recommended_backend = default_backend;
+            rec.confidence = 0.0;
+            rec.reasoning = "Exploring untried default configuration";
+            return rec;
+        }
+        
+        rec.recommended_shots = best->shots;
+        rec.recommended_backend = best->backend;
+        // Share of the prior uncertainty already explained by observations
+        rec.confidence = max(0.0, min(0.95, 1.0 - best_width / (prior_width + 1e-9)));
+        
+        ostringstream reason;
+        reason << "LinUCB over " << arms.size() << " arms from " << total_observations
+               << " executions (" << best->pulls << " on this arm, expected reward "
+               << (best_bound - best_width) * REWARD_SCALE << ")";
+        rec.reasoning = reason.str();
+        return rec;
+    }
+    
+    void set_voting(const SimilarityVotingParams& params) { voting = params; }
+    const SimilarityVotingParams& get_voting() const { return voting; }
+    
+    // The nine equally likely (shots, backend) choices of an exploration step
+    static vector<pair<int, string>> exploration_actions(int default_shots) {
+        vector<pair<int, string>> actions;
+        for(int step = -1; step <= 1; step++) {
+            int shots = max(100, min(10000, default_shots + step * (default_shots / 2)));
+            for(const char* backend : {"classical", "hpc", "quantum"}) actions.push_back({shots, backend});
+        }
+        return actions;
+    }
+    
+    // Greedy half of similarity voting: the top_k most similar executions
+    // vote for shots and backend, weighted by similarity and reward.
+    // Returns false (rec holds the defaults) when there is nothing to vote.
+    bool similarity_vote(
+        const vector<double>& current_features,
+        const vector<HistoricalExecution>& history,
+        const SimilarityVotingParams& params,
+        int default_shots,
+        const string& default_backend,
+        Recommendation& rec
+    ) const {
+        if(history.empty()) {
+            rec = {default_shots, default_backend, 0.0, "No historical data, using defaults"};
+            return false;
+        }
+        
+        // Find similar executions
+        vector<pair<double, int>> similarities;
+        for(size_t i = 0; i < history.size(); i++) {
+            double sim = cosine_similarity(current_features, history[i].features);
+            if(sim > params.min_similarity) {  // Only consider similar executions
+                similarities.push_back({sim, i});
+            }
+        }
+        
+        if(similarities.empty()) {
+            rec = {default_shots, default_backend, 0.1, "No similar executions found"};
+            return false;
+        }
+        
+        // Most similar first; only the voters need ordering
+        int top_k = min(params.top_k, (int)similarities.size());
+        partial_sort(similarities.begin(), similarities.begin() + top_k, similarities.end(),
+                     greater<pair<double, int>>());
+        
+        // Weighted voting for shots and backend
+        map<int, double> shots_votes;
+        map<string, double> backend_votes;
+        
+        double total_weight = 0.0;
+        
+        for(int i = 0; i < top_k; i++) {
+            double sim = similarities[i].first;
+            const auto& exec = history[similarities[i].second];
+            
+            // Weight by similarity and reward
+            double weight = sim * (1.0 + exec.reward_score / 100.0);
+            total_weight += weight;
+            
+            shots_votes[exec.shots_used] += weight;
+            backend_votes[exec.backend_used] += weight;
+        }
+        
+        // Exploitation: use best known configuration
+        int best_shots = default_shots;
+        double best_shots_weight = 0.0;
+        for(const auto& vote : shots_votes) {
+            if(vote.second > best_shots_weight) {
+                best_shots_weight = vote.second;
+                best_shots = vote.first;
+            }
+        }
+        
+        string best_backend = default_backend;
+        double best_backend_weight = 0.0;
+        for(const auto& vote : backend_votes) {
+            if(vote.second > best_backend_weight) {
+                best_backend_weight = vote.second;
+                best_backend = vote.first;
+            }
+        }
+        
+        rec.recommended_shots = best_shots;
+        rec.recommended_backend = best_backend;
+        rec.confidence = min(0.95, total_weight / (top_k * 2.0));
+        
+        ostringstream reason;
+        reason << "Based on " << top_k << " similar executions (avg similarity: " 
+               << (similarities[0].first * 100) << "%)";
+        rec.reasoning = reason.str();
+        return true;
+    }
+    
+    // Similarity voting over raw history with epsilon-greedy exploration
+    Recommendation recommend(
+        const vector<double>& current_features,
+        const vector<HistoricalExecution>& history,
+        int default_shots,
+        const string& default_backend
+    ) const {
+        PLANCK_TIME_STAGE(RECOMMEND);
+        Recommendation rec;
+        if(!similarity_vote(current_features, history, voting, default_shots, default_backend, rec)) return rec;
+        
+        // Epsilon-greedy exploration
+        RngStream rng(seed, exploration_calls++);
+        bool explore = rng.uniform() < voting.epsilon;
+        
+        if(explore) {
+            // Exploration: random variation
+            rec.recommended_shots = default_shots + ((int)rng.below(3) - 1) * (default_shots / 2);
+            rec.recommended_shots = max(100, min(10000, rec.recommended_shots));
+            
+            vector<string> backends = {"classical", "hpc", "quantum"};
+            rec.recommended_backend = backends[rng.below(backends.size())];
+            rec.confidence = 0.3;
+            rec.reasoning = "Exploring alternative configurations";
+        }
+        
+        return rec;
+    }
+};
+
+inline vector<double> parse_feature_vector(const string& input) {
+    vector<double> features;
+    // Simple parsing
+    size_t start = input.find("[");
+    size_t end = input.find("]");
+    if(start != string::npos && end != string::npos) {
+        string nums = input.substr(start + 1, end - start - 1);
+        stringstream ss(nums);
+        string token;
+        while(getline(ss, token, ',')) {
+            features.push_back(stod(token));
+        }
+    }
+    return features;
+}
+
+// Serialize a recommendation as the JSON object returned to callers
+inline string recommendation_to_json(const Recommendation& rec) {
+    ostringstream out;
+    out << "{\"shots\":" << rec.recommended_shots 
+        << ",\"backend\":\"" << json_escape(rec.recommended_backend) << "\""
+        << ",\"confidence\":" << rec.confidence
+        << ",\"reasoning\":\"" << json_escape(rec.reasoning) << "\"}";
+    return out.str();
+}
@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""
+ML Recommendation Server Client - Local check of the line protocol
+Starts ml_recommendation_server, sends a pipelined batch of vectorize,
+record, recommend, metrics, stats and ping requests over stdin and over
+--socket, then one stats request once the batch is answered. Checks that
+every request id is answered exactly once with valid JSON, that vectorize
+matches ml_feature_vectorizer for the same record, that recommend returns
+shots and a backend, and that stats counts every record. Backend names
+include quotes and backslashes so response escaping is exercised.
+
+Usage: ml_server_client.py <ml_recommendation_server> [requests] [threads] [ml_feature_vectorizer]
+(the vectorizer defaults to the one next to the server)
+"""
+
+import json
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+from typing import Dict, List, Tuple
+
+
+BACKENDS = ["quantum", "simulator", 'q"x', "back\\slash"]
+ALGORITHMS = ["grover", "qaoa", "vqe", "shor", "bell", "custom"]
+
+
+def features(i: int) -> str:
+    """Circuit description with the keys parse_features reads"""
+    return json.dumps({
+        "qubits": 2 + i % 10,
+        "gates": 10 + 7 * i % 200,
+        "depth": 3 + i % 40,
+        "algorithm": ALGORITHMS[i % len(ALGORITHMS)],
+        "target_latency": 1000 + 10 * (i % 50),
+    })
+
+
+def build_requests(count: int) -> List[Tuple[str, str]]:
+    """(id, line) pairs cycling through every command"""
+    requests = []
+    for i in range(count):
+        backend = BACKENDS[i % len(BACKENDS)]
+        kind = i % 7
+        if kind == 0:
+            fields = ["vectorize", features(i)]
+        elif kind in (1, 2):
+            fields = ["record", features(i), str(500 * (1 + i % 4)), backend,
+                      str(0.8 + 0.01 * (i % 20)), str(100 + i % 300), "1000"]
+        elif kind == 3:
+            fields = ["recommend", features(i), "1000", backend]
+        elif kind == 4:
+            fields = ["metrics", "json" if i % 2 else "prometheus"]
+        elif kind == 5:
+            fields = ["stats"]
+        else:
+            fields = ["ping"]
+        request_id = "req-%d" % i
+        requests.append((request_id, "\t".join([request_id] + fields) + "\n"))
+    return requests
+
+
+def expected_vectors(vectorizer: str, requests: List[Tuple[str, str]]) -> Dict[str, List[float]]:
+    """ml_feature_vectorizer --batch output for every vectorize request"""
+    ids, records = [], []
+    for request_id, line in requests:
+        fields = line.rstrip("\n").split("\t")
+        if fields[1] == "vectorize":
+            ids.append(request_id)
+            records.append(fields[2] + "\n")
+    result = subprocess.run([vectorizer, "--batch"], input="".join(records),
+                            capture_output=True, text=True, timeout=60, check=True)
+    return dict(zip(ids, (json.loads(row) for row in result.stdout.splitlines())))
+
+
+def check_content(transport: str, command: str, request_id: str, response, expected_vector) -> List[str]:
+    """Problems with the body of one successful response"""
+    where = "%s: %s %s" % (transport, command, request_id)
+    if command == "vectorize":
+        if not isinstance(response, list) or len(response) != len(expected_vector):
+            return ["%s: expected %d features, got %r" % (where, len(expected_vector), response)]
+        for got, want in zip(response, expected_vector):
+            if abs(got - want) > 1e-5 * max(1.0, abs(want)):
+                return ["%s: %r differs from ml_feature_vectorizer %r" % (where, response, expected_vector)]
+    elif command == "recommend":
+        shots, backend = response.get("shots"), response.get("backend")
+        if not isinstance(shots, int) or shots <= 0 or not isinstance(backend, str) or not backend:
+            return ["%s: no shots/backend in %r" % (where, response)]
+    elif command == "record":
+        if response.get("recorded") is not True:
+            return ["%s: not recorded: %r" % (where, response)]
+    elif command == "stats":
+        if not isinstance(response.get("observations"), int):
+            return ["%s: no observation count in %r" % (where, response)]
+    elif command == "ping":
+        if response.get("ok") is not True:
+            return ["%s: %r" % (where, response)]
+    return []
+
+
+def check_responses(transport: str, requests: List[Tuple[str, str]], output: str,
+                    vectors: Dict[str, List[float]]) -> List[str]:
+    """Problems found in the server's output, empty when it is correct"""
+    problems = []
+    commands = {request_id: line.split("\t")[1].rstrip("\n") for request_id, line in requests}
+    seen: Dict[str, int] = {}
+    for line in output.splitlines():
+        request_id, tab, body = line.partition("\t")
+        if not tab:
+            problems.append("%s: line without id: %r" % (transport, line[:80]))
+            continue
+        seen[request_id] = seen.get(request_id, 0) + 1
+        try:
+            response = json.loads(body)
+        except ValueError as e:
+            problems.append("%s: %s is not JSON (%s): %r" % (transport, request_id, e, body[:80]))
+            continue
+        if isinstance(response, dict) and "error" in response:
+            problems.append("%s: %s failed: %s" % (transport, request_id, response["error"]))
+        elif request_id in commands:
+            problems.extend(check_content(transport, commands[request_id], request_id, response,
+                                          vectors.get(request_id)))
+    for request_id in sorted(set(commands) - set(seen)):
+        problems.append("%s: no response for %s" % (transport, request_id))
+    for request_id, count in seen.items():
+        if request_id not in commands:
+            problems.append("%s: response for unknown id %s" % (transport, request_id))
+        elif count > 1:
+            problems.append("%s: %d responses for %s" % (transport, count, request_id))
+    return problems
+
+
+class Connection:
+    """Line-oriented pipe to one server, over its stdin/stdout or a socket"""
+
+    def __init__(self, server: str, threads: int, socket_path: str = ""):
+        self.sock = None
+        if not socket_path:
+            self.process = subprocess.Popen([server, "--threads", str(threads)], stdin=subprocess.PIPE,
+                                            stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+            self.reader = self.process.stdout
+            return
+        self.process = subprocess.Popen([server, "--socket", socket_path, "--threads", str(threads)],
+                                        stderr=subprocess.DEVNULL)
+        deadline = time.time() + 10
+        while not os.path.exists(socket_path):
+            if time.time() > deadline or self.process.poll() is not None:
+                self.close()
+                raise RuntimeError("server did not open " + socket_path)
+            time.sleep(0.05)
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(socket_path)
+        self.sock.settimeout(120)
+        self.reader = self.sock.makefile("rb")
+
+    def send(self, text: str):
+        if self.sock:
+            self.sock.sendall(text.encode())
+        else:
+            self.process.stdin.write(text.encode())
+            self.process.stdin.flush()
+
+    def read_lines(self, count: int) -> str:
+        lines = []
+        while len(lines) < count:
+            line = self.reader.readline()
+            if not line:
+                break
+            lines.append(line.decode())
+        return "".join(lines)
+
+    def close(self):
+        if self.sock:
+            self.sock.close()
+        elif self.process.stdin:
+            self.process.stdin.close()
+        self.process.terminate()
+        self.process.wait()
+
+
+def run_transport(transport: str, connection: Connection, requests: List[Tuple[str, str]],
+                  vectors: Dict[str, List[float]]) -> Tuple[List[str], int]:
+    """Pipelined batch, then a stats request that must count every record"""
+    connection.send("".join(line for _, line in requests))
+    output = connection.read_lines(len(requests))
+    problems = check_responses(transport, requests, output, vectors)
+
+    records = sum(1 for _, line in requests if line.split("\t")[1] == "record")
+    connection.send("final\tstats\n")
+    final = connection.read_lines(1)
+    request_id, _, body = final.rstrip("\n").partition("\t")
+    try:
+        observations = json.loads(body).get("observations") if request_id == "final" else None
+    except ValueError:
+        observations = None
+    if observations != records:
+        problems.append("%s: stats counted %r observations after %d records" % (transport, observations, records))
+    return problems, len(output.splitlines())
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: ml_server_client.py <ml_recommendation_server> [requests] [threads] [ml_feature_vectorizer]",
+              file=sys.stderr)
+        sys.exit(1)
+
+    server = sys.argv[1]
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 500
+    threads = int(sys.argv[3]) if len(sys.argv) > 3 else 4
+    vectorizer = sys.argv[4] if len(sys.argv) > 4 else os.path.join(os.path.dirname(server), "ml_feature_vectorizer")
+    requests = build_requests(count)
+    vectors = expected_vectors(vectorizer, requests)
+
+    problems = []
+    summary = {"requests": count, "threads": threads}
+    with tempfile.TemporaryDirectory() as workdir:
+        for transport in ("stdin", "socket"):
+            start = time.time()
+            socket_path = os.path.join(workdir, "server.sock") if transport == "socket" else ""
+            connection = Connection(server, threads, socket_path)
+            try:
+                found, responses = run_transport(transport, connection, requests, vectors)
+            finally:
+                connection.close()
+            problems.extend(found)
+            summary[transport] = {
+                "responses": responses,
+                "problems": len(found),
+                "seconds": round(time.time() - start, 3),
+            }
+
+    summary["ok"] = not problems
+    print(json.dumps(summary))
+    for problem in problems[:20]:
+        print(problem, file=sys.stderr)
+    sys.exit(0 if summary["ok"] else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,153 @@
+/*
+ * Parameter Binding Cache - Transpile a parametric circuit once, rebind after
+ * Routing depends only on which gates touch which qubits, never on angles, so
+ * variational iterations that resubmit the same structure can reuse the
+ * routed template and only copy the new parameter values into its slots.
+ * Templates are keyed by a structural hash of the circuit (gate types, qubits,
+ * parameter names) and the target topology's coupling map. When calibration
+ * changes the coupling map, reroute() patches the affected templates in
+ * place instead of dropping them.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+
+#include "quantum_transpiler.h"
+
+using namespace std;
+
+class ParameterBindingCache {
+private:
+    struct Template {
+        vector<Gate> logical;     // Structure only, for verifying hash hits
+        pmr::vector<Gate> gates;  // Routed circuit; parameters rewritten on each bind
+        vector<int> source;       // Per routed gate: logical gate index, -1 for SWAPs
+        int num_logical_qubits;
+        int swap_count;
+        uint64_t topology_hash;
+    };
+
+    unordered_map<uint64_t, Template> templates;
+    size_t max_templates;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    static void mix(uint64_t& hash, uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    }
+
+    static bool same_structure(const vector<Gate>& a, const vector<Gate>& b) {
+        if(a.size() != b.size()) return false;
+        for(size_t i = 0; i < a.size(); i++) {
+            if(a[i].type != b[i].type || a[i].qubits != b[i].qubits) return false;
+            if(a[i].parameters.size() != b[i].parameters.size()) return false;
+            auto pa = a[i].parameters.begin();
+            for(auto pb = b[i].parameters.begin(); pb != b[i].parameters.end(); ++pa, ++pb) {
+                if(pa->first != pb->first) return false;
+            }
+        }
+        return true;
+    }
+
+    // Same parameter names by construction, so values are copied in lockstep
+    // without touching the map structure
+    static void copy_values(const GateParameters& from, GateParameters& to) {
+        auto dest = to.begin();
+        for(auto src = from.begin(); src != from.end(); ++src, ++dest) dest->second = src->second;
+    }
+
+public:
+    ParameterBindingCache(size_t capacity = 256) : max_templates(capacity) {}
+
+    static uint64_t structural_hash(const vector<Gate>& gates, int num_logical_qubits, uint64_t topology_hash) {
+        uint64_t hash = 14695981039346656037ULL;
+        mix(hash, topology_hash);
+        mix(hash, num_logical_qubits);
+        for(const auto& gate : gates) {
+            for(char c : gate.type) mix(hash, (unsigned char)c);
+            mix(hash, gate.qubits.size());
+            for(int q : gate.qubits) mix(hash, q);
+            for(const auto& param : gate.parameters) {
+                for(char c : param.first) mix(hash, (unsigned char)c);
+                mix(hash, 0xFF);  // Separator between names
+            }
+        }
+        return hash;
+    }
+
+    // Returns the routed circuit with this call's parameter values. The first
+    // call for a structure runs the full transpiler; later calls only rebind.
+    // The reference stays valid until the next call for the same structure.
+    const pmr::vector<Gate>& transpile(QuantumTranspiler& transpiler, const QPUTopology& topology,
+                                  const vector<Gate>& logical_gates, int num_logical_qubits,
+                                  int* swap_count = nullptr) {
+        uint64_t key = structural_hash(logical_gates, num_logical_qubits, topology.structural_hash());
+        auto it = templates.find(key);
+        if(it != templates.end() && it->second.num_logical_qubits == num_logical_qubits &&
+           same_structure(it->second.logical, logical_gates)) {
+            hits++;
+            Template& entry = it->second;
+            for(size_t i = 0; i < entry.gates.size(); i++) {
+                if(entry.source[i] >= 0) copy_values(logical_gates[entry.source[i]].parameters, entry.gates[i].parameters);
+            }
+            if(swap_count) *swap_count = entry.swap_count;
+            return entry.gates;
+        }
+
+        misses++;
+        if(templates.size() >= max_templates && it == templates.end()) templates.clear();
+        Template entry;
+        entry.logical = logical_gates;
+        entry.gates = transpiler.transpile(logical_gates, num_logical_qubits);
+        const pmr::vector<int>& source = transpiler.get_source_gates();
+        entry.source.assign(source.begin(), source.end());
+        entry.num_logical_qubits = num_logical_qubits;
+        entry.swap_count = transpiler.get_swap_count();
+        entry.topology_hash = topology.structural_hash();
+        if(swap_count) *swap_count = entry.swap_count;
+        Template& stored = templates[key] = move(entry);
+        return stored.gates;
+    }
+
+    // Re-routes every template built for the topology with hash
+    // previous_topology_hash onto topology (after QPUTopology::apply_diff),
+    // using transpiler's incremental reroute; transpiler must target
+    // topology. Returns the number of templates patched.
+    size_t reroute(QuantumTranspiler& transpiler, const QPUTopology& topology, uint64_t previous_topology_hash) {
+        uint64_t topology_hash = topology.structural_hash();
+        if(topology_hash == previous_topology_hash) return 0;
+
+        vector<Template> patched;
+        for(auto it = templates.begin(); it != templates.end();) {
+            if(it->second.topology_hash != previous_topology_hash) {
+                ++it;
+                continue;
+            }
+            Template& entry = it->second;
+            transpiler.set_routing(entry.gates, entry.source);
+            entry.gates = transpiler.reroute(entry.logical, entry.num_logical_qubits);
+            const pmr::vector<int>& source = transpiler.get_source_gates();
+            entry.source.assign(source.begin(), source.end());
+            entry.swap_count = transpiler.get_swap_count();
+            entry.topology_hash = topology_hash;
+            patched.push_back(move(entry));
+            it = templates.erase(it);
+        }
+        for(Template& entry : patched) {
+            uint64_t key = structural_hash(entry.logical, entry.num_logical_qubits, topology_hash);
+            templates[key] = move(entry);
+        }
+        return patched.size();
+    }
+
+    size_t get_hits() const { return hits; }
+    size_t get_misses() const { return misses; }
+    size_t size() const { return templates.size(); }
+    void clear() { templates.clear(); }
+};
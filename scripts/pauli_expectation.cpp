@@ -0,0 +1,113 @@
+/*
+ * Pauli Expectation Engine - Command line entry point
+ *   group     <hamiltonian>                  measurement groups as JSON
+ *   circuits  <hamiltonian> <ansatz.qasm>    one measurement circuit per group (NDJSON)
+ *   evaluate  <hamiltonian> < counts.ndjson  energy from one counts object per group,
+ *                                            in the order printed by 'group'
+ * The hamiltonian file holds "coefficient label" lines, e.g. "-0.5 ZZII".
+ * (see pauli_expectation.h for the grouping and parity kernels)
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include "pauli_expectation.h"
+#include "json_scanner.h"
+
+using namespace std;
+
+string read_file(const string& path) {
+    ifstream file(path);
+    if(!file) throw runtime_error("Cannot open file: " + path);
+    stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 3) {
+        cerr << "Usage: " << argv[0] << " group <hamiltonian> [--strategy dsatur|largest-first]" << endl;
+        cerr << "       " << argv[0] << " circuits <hamiltonian> <ansatz.qasm>" << endl;
+        cerr << "       " << argv[0] << " evaluate <hamiltonian> < counts.ndjson" << endl;
+        return 1;
+    }
+
+    string command = argv[1];
+    try {
+        vector<PauliTerm> terms = parse_hamiltonian(read_file(argv[2]));
+        if(terms.empty()) throw runtime_error("Hamiltonian has no terms");
+        int num_qubits = terms[0].label.size();
+
+        ColoringStrategy strategy = ColoringStrategy::DSATUR;
+        for(int i = 3; i + 1 < argc; i++) {
+            if(string(argv[i]) == "--strategy" && string(argv[i + 1]) == "largest-first") {
+                strategy = ColoringStrategy::LARGEST_FIRST;
+            }
+        }
+        vector<PauliGroup> groups = group_qubit_wise(terms, strategy);
+
+        double offset = 0.0;
+        for(const auto& term : terms) if(term.is_identity()) offset += term.coefficient;
+
+        if(command == "group") {
+            cout << "{\"terms\":" << terms.size() << ",\"groups\":[";
+            for(size_t g = 0; g < groups.size(); g++) {
+                if(g > 0) cout << ",";
+                cout << "{\"basis\":\"" << groups[g].basis_label(num_qubits) << "\",\"terms\":[";
+                for(size_t i = 0; i < groups[g].terms.size(); i++) {
+                    if(i > 0) cout << ",";
+                    cout << "\"" << terms[groups[g].terms[i]].label << "\"";
+                }
+                cout << "]}";
+            }
+            cout << "],\"identity_offset\":" << offset << "}" << endl;
+        } else if(command == "circuits") {
+            if(argc < 4) throw runtime_error("circuits needs an ansatz file");
+            string ansatz = read_file(argv[3]);
+            for(const auto& group : groups) {
+                cout << "{\"basis\":\"" << group.basis_label(num_qubits) << "\",\"qasm\":\""
+                     << json_escape(measurement_circuit(ansatz, group, num_qubits)) << "\"}" << endl;
+            }
+        } else if(command == "evaluate") {
+            double energy = offset, variance_of_mean = 0.0;
+            map<string, double> expectations;
+            stringstream group_stats;
+            string line;
+            size_t g = 0;
+            while(getline(cin, line)) {
+                if(line.find_first_not_of(" \t\r") == string::npos) continue;
+                if(g >= groups.size()) throw runtime_error("More counts than measurement groups");
+
+                GroupEstimate estimate = evaluate_group(groups[g], terms, CountTable::from_json(line, num_qubits));
+                energy += estimate.energy;
+                variance_of_mean += estimate.variance / estimate.shots;
+                for(size_t i = 0; i < groups[g].terms.size(); i++) {
+                    expectations[terms[groups[g].terms[i]].label] = estimate.expectations[i];
+                }
+
+                // Same fields as shot_budget_optimizer's input
+                if(g > 0) group_stats << ",";
+                group_stats << "{\"label\":\"" << groups[g].basis_label(num_qubits) << "\",\"weight\":1"
+                            << ",\"variance\":" << estimate.variance << ",\"shots\":" << estimate.shots << "}";
+                g++;
+            }
+            if(g != groups.size()) throw runtime_error("Expected counts for " + to_string(groups.size()) + " groups");
+
+            cout << "{\"energy\":" << energy << ",\"std_error\":" << sqrt(variance_of_mean) << ",\"terms\":{";
+            bool first = true;
+            for(const auto& entry : expectations) {
+                if(!first) cout << ",";
+                cout << "\"" << entry.first << "\":" << entry.second;
+                first = false;
+            }
+            cout << "},\"groups\":[" << group_stats.str() << "]}" << endl;
+        } else {
+            throw runtime_error("Unknown command: " + command);
+        }
+    } catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
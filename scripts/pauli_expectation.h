@@ -0,0 +1,297 @@
+/*
+ * Pauli Expectation Engine - Grouped measurement of Pauli-sum observables
+ * Terms that commute qubit-wise share one measurement basis, so a Hamiltonian
+ * H = Σ c_t P_t needs one circuit per colour of the non-commutation graph
+ * rather than one per term. Shots come as ShotResults or a CountTable and each
+ * term's eigenvalue is the parity of its support bits, computed with popcount.
+ *
+ * Labels and bitstrings follow the Qiskit convention: the rightmost
+ * character is qubit 0.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include "shot_results.h"
+
+using namespace std;
+
+struct PauliTerm {
+    double coefficient = 0.0;
+    string label;
+    vector<uint64_t> x;  // Symplectic bits: X -> x, Z -> z, Y -> both
+    vector<uint64_t> z;
+
+    bool is_identity() const {
+        for(size_t w = 0; w < x.size(); w++) if(x[w] | z[w]) return false;
+        return true;
+    }
+};
+
+inline PauliTerm parse_pauli(const string& label, double coefficient) {
+    PauliTerm term;
+    term.coefficient = coefficient;
+    term.label = label;
+    size_t n = label.size();
+    term.x.assign(shot_words(n), 0);
+    term.z.assign(shot_words(n), 0);
+    for(size_t i = 0; i < n; i++) {
+        size_t qubit = n - 1 - i;
+        uint64_t bit = 1ULL << (qubit % 64);
+        switch(label[i]) {
+            case 'I': break;
+            case 'X': term.x[qubit / 64] |= bit; break;
+            case 'Z': term.z[qubit / 64] |= bit; break;
+            case 'Y': term.x[qubit / 64] |= bit; term.z[qubit / 64] |= bit; break;
+            default: throw runtime_error("Invalid Pauli label: " + label);
+        }
+    }
+    return term;
+}
+
+// True when every qubit is acted on by the same Pauli (or identity) in both
+inline bool qubit_wise_commute(const PauliTerm& a, const PauliTerm& b) {
+    for(size_t w = 0; w < a.x.size(); w++) {
+        uint64_t shared = (a.x[w] | a.z[w]) & (b.x[w] | b.z[w]);
+        if(((a.x[w] ^ b.x[w]) | (a.z[w] ^ b.z[w])) & shared) return false;
+    }
+    return true;
+}
+
+struct PauliGroup {
+    vector<size_t> terms;  // Indices into the term list
+    vector<uint64_t> x;    // Union of the members' bits = the shared basis
+    vector<uint64_t> z;
+
+    // Basis as a Pauli label (I where no member acts)
+    string basis_label(int num_qubits) const {
+        string label(num_qubits, 'I');
+        for(int q = 0; q < num_qubits; q++) {
+            bool bx = (x[q / 64] >> (q % 64)) & 1, bz = (z[q / 64] >> (q % 64)) & 1;
+            label[num_qubits - 1 - q] = bx ? (bz ? 'Y' : 'X') : (bz ? 'Z' : 'I');
+        }
+        return label;
+    }
+};
+
+enum class ColoringStrategy {
+    LARGEST_FIRST,  // Greedy in order of decreasing conflict degree
+    DSATUR          // Most distinct neighbour colours first; usually fewer groups
+};
+
+// Colours the non-commutation graph; each colour class is one measurement group.
+// Identity terms need no measurement and are left out of every group.
+inline vector<PauliGroup> group_qubit_wise(const vector<PauliTerm>& terms,
+                                           ColoringStrategy strategy = ColoringStrategy::DSATUR) {
+    vector<size_t> vertices;
+    for(size_t t = 0; t < terms.size(); t++) if(!terms[t].is_identity()) vertices.push_back(t);
+    size_t n = vertices.size();
+
+    vector<vector<int>> conflicts(n);
+    for(size_t i = 0; i < n; i++) {
+        for(size_t j = i + 1; j < n; j++) {
+            if(!qubit_wise_commute(terms[vertices[i]], terms[vertices[j]])) {
+                conflicts[i].push_back(j);
+                conflicts[j].push_back(i);
+            }
+        }
+    }
+
+    vector<int> colour(n, -1);
+    vector<vector<bool>> neighbour_colours(n);
+    vector<int> saturation(n, 0);
+    int num_colours = 0;
+
+    auto assign = [&](size_t v) {
+        int c = 0;
+        while(c < (int)neighbour_colours[v].size() && neighbour_colours[v][c]) c++;
+        colour[v] = c;
+        num_colours = max(num_colours, c + 1);
+        for(int u : conflicts[v]) {
+            auto& seen = neighbour_colours[u];
+            if((int)seen.size() <= c) seen.resize(c + 1, false);
+            if(!seen[c]) {
+                seen[c] = true;
+                saturation[u]++;
+            }
+        }
+    };
+
+    if(strategy == ColoringStrategy::LARGEST_FIRST) {
+        vector<size_t> order(n);
+        for(size_t i = 0; i < n; i++) order[i] = i;
+        stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return conflicts[a].size() > conflicts[b].size();
+        });
+        for(size_t v : order) assign(v);
+    } else {
+        for(size_t step = 0; step < n; step++) {
+            size_t best = n;
+            for(size_t v = 0; v < n; v++) {
+                if(colour[v] >= 0) continue;
+                if(best == n || saturation[v] > saturation[best] ||
+                   (saturation[v] == saturation[best] && conflicts[v].size() > conflicts[best].size())) {
+                    best = v;
+                }
+            }
+            assign(best);
+        }
+    }
+
+    size_t words = terms.empty() ? 0 : terms[0].x.size();
+    vector<PauliGroup> groups(num_colours);
+    for(auto& group : groups) {
+        group.x.assign(words, 0);
+        group.z.assign(words, 0);
+    }
+    for(size_t v = 0; v < n; v++) {
+        PauliGroup& group = groups[colour[v]];
+        const PauliTerm& term = terms[vertices[v]];
+        group.terms.push_back(vertices[v]);
+        for(size_t w = 0; w < words; w++) {
+            group.x[w] |= term.x[w];
+            group.z[w] |= term.z[w];
+        }
+    }
+    return groups;
+}
+
+// Appends the basis change (h for X, sdg+h for Y) and a full measurement to
+// an ansatz; the ansatz's own measure statements are dropped
+inline string measurement_circuit(string_view ansatz, const PauliGroup& group, int num_qubits) {
+    string qreg = "q", creg;
+    string out;
+    size_t pos = 0;
+    while(pos < ansatz.size()) {
+        size_t end = ansatz.find('\n', pos);
+        if(end == string_view::npos) end = ansatz.size();
+        string_view line = ansatz.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t first = line.find_first_not_of(" \t");
+        string_view body = first == string_view::npos ? string_view() : line.substr(first);
+        if(body.substr(0, 7) == "measure") continue;
+        if(body.substr(0, 4) == "qreg" || body.substr(0, 4) == "creg") {
+            size_t bracket = body.find('[');
+            size_t name_start = body.find_first_not_of(" \t", 4);
+            if(bracket != string_view::npos && name_start < bracket) {
+                string name(body.substr(name_start, bracket - name_start));
+                while(!name.empty() && (name.back() == ' ' || name.back() == '\t')) name.pop_back();
+                if(body[0] == 'q' && qreg == "q") qreg = name;
+                if(body[0] == 'c' && creg.empty()) creg = name;
+            }
+        }
+        out.append(line);
+        out += '\n';
+    }
+    if(creg.empty()) {
+        creg = "meas";
+        out += "creg meas[" + to_string(num_qubits) + "];\n";
+    }
+
+    out += "// Measurement basis " + group.basis_label(num_qubits) + "\n";
+    for(int q = 0; q < num_qubits; q++) {
+        bool bx = (group.x[q / 64] >> (q % 64)) & 1, bz = (group.z[q / 64] >> (q % 64)) & 1;
+        string target = qreg + "[" + to_string(q) + "]";
+        if(bx && bz) out += "sdg " + target + ";\nh " + target + ";\n";
+        else if(bx) out += "h " + target + ";\n";
+    }
+    out += "measure " + qreg + " -> " + creg + ";\n";
+    return out;
+}
+
+struct GroupEstimate {
+    vector<double> expectations;  // Per term of the group, same order
+    double energy = 0.0;          // Σ c_t <P_t> over the group
+    double variance = 0.0;        // Per-shot variance of the group's energy
+    double shots = 0.0;
+};
+
+// One pass over the outcomes: every term's parity plus the per-outcome energy,
+// so the variance accounts for covariance between terms of the same group.
+// for_each_outcome(visit) must call visit(const uint64_t* row, double weight).
+template<typename Outcomes>
+GroupEstimate evaluate_group_outcomes(const PauliGroup& group, const vector<PauliTerm>& terms,
+                                      size_t words, Outcomes&& for_each_outcome) {
+    size_t k = group.terms.size();
+    vector<uint64_t> masks(k * words);
+    vector<double> coefficients(k), odd(k, 0.0);
+    for(size_t i = 0; i < k; i++) {
+        const PauliTerm& term = terms[group.terms[i]];
+        if(term.x.size() != words) throw runtime_error("Shot width does not match term " + term.label);
+        coefficients[i] = term.coefficient;
+        for(size_t w = 0; w < words; w++) masks[i * words + w] = term.x[w] | term.z[w];
+    }
+
+    GroupEstimate estimate;
+    double sum = 0.0, sum_squares = 0.0;
+    for_each_outcome([&](const uint64_t* row, double weight) {
+        double value = 0.0;
+        for(size_t i = 0; i < k; i++) {
+            const uint64_t* mask = &masks[i * words];
+            uint64_t parity = 0;
+            for(size_t w = 0; w < words; w++) parity ^= row[w] & mask[w];
+            int odd_parity = __builtin_popcountll(parity) & 1;
+            odd[i] += odd_parity * weight;
+            value += odd_parity ? -coefficients[i] : coefficients[i];
+        }
+        sum += weight * value;
+        sum_squares += weight * value * value;
+        estimate.shots += weight;
+    });
+    if(estimate.shots <= 0) throw runtime_error("No shots to evaluate");
+
+    estimate.expectations.resize(k);
+    for(size_t i = 0; i < k; i++) estimate.expectations[i] = 1.0 - 2.0 * odd[i] / estimate.shots;
+    estimate.energy = sum / estimate.shots;
+    estimate.variance = max(0.0, sum_squares / estimate.shots - estimate.energy * estimate.energy);
+    return estimate;
+}
+
+inline GroupEstimate evaluate_group(const PauliGroup& group, const vector<PauliTerm>& terms,
+                                    const ShotResults& shots) {
+    return evaluate_group_outcomes(group, terms, shots.words_per_shot(), [&](auto&& visit) {
+        for(size_t s = 0; s < shots.size(); s++) visit(shots.shot(s), 1.0);
+    });
+}
+
+inline GroupEstimate evaluate_group(const PauliGroup& group, const vector<PauliTerm>& terms,
+                                    const CountTable& counts) {
+    return evaluate_group_outcomes(group, terms, 1, [&](auto&& visit) {
+        counts.for_each([&](uint64_t key, double count) { visit(&key, count); });
+    });
+}
+
+// "coefficient label" per line; blank lines and '#' comments are skipped
+inline vector<PauliTerm> parse_hamiltonian(string_view text) {
+    vector<PauliTerm> terms;
+    size_t pos = 0;
+    while(pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if(end == string_view::npos) end = text.size();
+        string line(text.substr(pos, end - pos));
+        pos = end + 1;
+        size_t hash = line.find('#');
+        if(hash != string::npos) line.resize(hash);
+        if(line.find_first_not_of(" \t\r") == string::npos) continue;
+
+        size_t used = 0;
+        double coefficient = stod(line, &used);
+        size_t start = line.find_first_not_of(" \t", used);
+        size_t stop = line.find_last_not_of(" \t\r");
+        if(start == string::npos) throw runtime_error("Missing Pauli label: " + line);
+        terms.push_back(parse_pauli(line.substr(start, stop - start + 1), coefficient));
+        if(terms.back().label.size() != terms[0].label.size()) {
+            throw runtime_error("Pauli labels differ in length: " + terms.back().label);
+        }
+    }
+    return terms;
+}
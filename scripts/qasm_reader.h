@@ -0,0 +1,377 @@
+/*
+ * OpenQASM 2.0 Reader - Single-pass statement parser
+ * Streams the gate applications of a circuit to a callback with register
+ * references resolved to global qubit indices and parameters evaluated.
+ * Custom gate definitions are expanded inline; qelib1 gates are primitives.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <set>
+#include <cmath>
+#include <cctype>
+#include <stdexcept>
+#include <functional>
+
+using namespace std;
+
+// One primitive operation (gate, measure, reset or barrier)
+struct QasmOp {
+    string name;
+    vector<int> qubits;
+    vector<double> params;
+};
+
+class QasmReader {
+private:
+    struct Register {
+        int offset;
+        int size;
+    };
+
+    struct GateDef {
+        vector<string> params;
+        vector<string> qubits;
+        vector<string> body;
+    };
+
+    // Formal parameter values and qubit bindings inside a gate body
+    struct Scope {
+        map<string, double> params;
+        map<string, int> qubits;
+    };
+
+    map<string, Register> qregs;
+    int num_qubits = 0;
+    map<string, GateDef> gate_defs;
+    QasmOp op;
+
+    const set<string> KEYWORDS_SKIPPED = {"OPENQASM", "include", "creg", "opaque"};
+
+    [[noreturn]] static void fail(const string& what, string_view statement) {
+        throw runtime_error("QASM parse error: " + what + " in '" + string(statement) + "'");
+    }
+
+    static string_view trim(string_view s) {
+        size_t start = 0, end = s.size();
+        while(start < end && isspace((unsigned char)s[start])) start++;
+        while(end > start && isspace((unsigned char)s[end - 1])) end--;
+        return s.substr(start, end - start);
+    }
+
+    static vector<string_view> split_top_level(string_view s, char sep) {
+        vector<string_view> parts;
+        int depth = 0;
+        size_t start = 0;
+        for(size_t i = 0; i < s.size(); i++) {
+            if(s[i] == '(' || s[i] == '[') depth++;
+            else if(s[i] == ')' || s[i] == ']') depth--;
+            else if(s[i] == sep && depth == 0) {
+                parts.push_back(trim(s.substr(start, i - start)));
+                start = i + 1;
+            }
+        }
+        string_view last = trim(s.substr(start));
+        if(!last.empty()) parts.push_back(last);
+        return parts;
+    }
+
+    static size_t identifier_end(string_view s, size_t start) {
+        size_t i = start;
+        while(i < s.size() && (isalnum((unsigned char)s[i]) || s[i] == '_')) i++;
+        return i;
+    }
+
+    // Recursive-descent evaluation of parameter expressions
+    class ExpressionParser {
+    private:
+        string_view s;
+        size_t pos = 0;
+        const Scope* scope;
+
+        void skip_ws() { while(pos < s.size() && isspace((unsigned char)s[pos])) pos++; }
+
+        double primary() {
+            skip_ws();
+            if(pos >= s.size()) fail("truncated expression", s);
+            char c = s[pos];
+            if(c == '(') {
+                pos++;
+                double value = sum();
+                skip_ws();
+                if(pos >= s.size() || s[pos] != ')') fail("missing ')'", s);
+                pos++;
+                return value;
+            }
+            if(c == '-') { pos++; return -power(); }
+            if(c == '+') { pos++; return power(); }
+            if(isdigit((unsigned char)c) || c == '.') {
+                size_t used = 0;
+                double value = stod(string(s.substr(pos)), &used);
+                pos += used;
+                return value;
+            }
+            if(isalpha((unsigned char)c) || c == '_') {
+                size_t end = identifier_end(s, pos);
+                string name(s.substr(pos, end - pos));
+                pos = end;
+                if(name == "pi") return M_PI;
+                skip_ws();
+                if(pos < s.size() && s[pos] == '(') {
+                    double arg = primary();
+                    if(name == "sin") return sin(arg);
+                    if(name == "cos") return cos(arg);
+                    if(name == "tan") return tan(arg);
+                    if(name == "exp") return exp(arg);
+                    if(name == "ln") return log(arg);
+                    if(name == "sqrt") return sqrt(arg);
+                    fail("unknown function " + name, s);
+                }
+                if(scope) {
+                    auto it = scope->params.find(name);
+                    if(it != scope->params.end()) return it->second;
+                }
+                fail("unknown parameter " + name, s);
+            }
+            fail("unexpected character", s);
+        }
+
+        double power() {
+            double base = primary();
+            skip_ws();
+            if(pos < s.size() && s[pos] == '^') {
+                pos++;
+                return pow(base, power());
+            }
+            return base;
+        }
+
+        double product() {
+            double value = power();
+            while(true) {
+                skip_ws();
+                if(pos < s.size() && s[pos] == '*') { pos++; value *= power(); }
+                else if(pos < s.size() && s[pos] == '/') { pos++; value /= power(); }
+                else return value;
+            }
+        }
+
+        double sum() {
+            double value = product();
+            while(true) {
+                skip_ws();
+                if(pos < s.size() && s[pos] == '+') { pos++; value += product(); }
+                else if(pos < s.size() && s[pos] == '-') { pos++; value -= product(); }
+                else return value;
+            }
+        }
+
+    public:
+        ExpressionParser(string_view text, const Scope* params) : s(text), scope(params) {}
+
+        double evaluate() {
+            double value = sum();
+            skip_ws();
+            if(pos != s.size()) fail("trailing characters in expression", s);
+            return value;
+        }
+    };
+
+    // Resolves "q[3]" / "q" (global scope) or a formal argument (gate body).
+    // Returns the qubits the argument expands to.
+    vector<int> resolve_argument(string_view arg, const Scope* scope, string_view statement) const {
+        if(scope) {
+            auto it = scope->qubits.find(string(arg));
+            if(it == scope->qubits.end()) fail("unknown gate argument " + string(arg), statement);
+            return {it->second};
+        }
+
+        size_t bracket = arg.find('[');
+        string name(trim(arg.substr(0, bracket)));
+        auto reg = qregs.find(name);
+        if(reg == qregs.end()) {
+            fail("unknown quantum register " + name, statement);
+        }
+        if(bracket == string_view::npos) {
+            vector<int> qubits(reg->second.size);
+            for(int i = 0; i < reg->second.size; i++) qubits[i] = reg->second.offset + i;
+            return qubits;
+        }
+        int index = stoi(string(arg.substr(bracket + 1)));
+        if(index < 0 || index >= reg->second.size) fail("qubit index out of range", statement);
+        return {reg->second.offset + index};
+    }
+
+    void apply(const string& name, const vector<double>& params, const vector<int>& qubits,
+               const function<void(const QasmOp&)>& on_op, int depth) {
+        auto def = gate_defs.find(name);
+        if(def == gate_defs.end()) {
+            op.name = name;
+            op.qubits = qubits;
+            op.params = params;
+            on_op(op);
+            return;
+        }
+
+        if(depth > 64) fail("gate definitions nested too deeply", name);
+        const GateDef& gate = def->second;
+        if(gate.params.size() != params.size() || gate.qubits.size() != qubits.size()) {
+            fail("wrong number of arguments", name);
+        }
+        Scope scope;
+        for(size_t i = 0; i < params.size(); i++) scope.params[gate.params[i]] = params[i];
+        for(size_t i = 0; i < qubits.size(); i++) scope.qubits[gate.qubits[i]] = qubits[i];
+        for(const auto& statement : gate.body) {
+            execute(statement, &scope, on_op, depth + 1);
+        }
+    }
+
+    void define_gate(string_view header, string_view body, string_view statement) {
+        size_t name_start = header.find_first_not_of(" \t\r\n", 4);
+        size_t name_end = identifier_end(header, name_start);
+        string name(header.substr(name_start, name_end - name_start));
+
+        GateDef def;
+        string_view rest = trim(header.substr(name_end));
+        if(!rest.empty() && rest[0] == '(') {
+            size_t close = rest.find(')');
+            if(close == string_view::npos) fail("missing ')'", statement);
+            for(auto p : split_top_level(rest.substr(1, close - 1), ',')) def.params.emplace_back(p);
+            rest = trim(rest.substr(close + 1));
+        }
+        for(auto q : split_top_level(rest, ',')) def.qubits.emplace_back(q);
+
+        size_t start = 0;
+        for(size_t i = 0; i < body.size(); i++) {
+            if(body[i] == ';') {
+                string_view stmt = trim(body.substr(start, i - start));
+                if(!stmt.empty()) def.body.emplace_back(stmt);
+                start = i + 1;
+            }
+        }
+        gate_defs[name] = move(def);
+    }
+
+    void execute(string_view statement, const Scope* scope,
+                 const function<void(const QasmOp&)>& on_op, int depth = 0) {
+        statement = trim(statement);
+        if(statement.empty()) return;
+
+        size_t keyword_end = identifier_end(statement, 0);
+        string keyword(statement.substr(0, keyword_end));
+        if(KEYWORDS_SKIPPED.count(keyword)) return;
+
+        if(keyword == "qreg") {
+            string_view decl = trim(statement.substr(keyword_end));
+            size_t open = decl.find('['), close = decl.find(']');
+            if(open == string_view::npos || close == string_view::npos) fail("bad qreg", statement);
+            string name(trim(decl.substr(0, open)));
+            int size = stoi(string(decl.substr(open + 1, close - open - 1)));
+            qregs[name] = {num_qubits, size};
+            num_qubits += size;
+            return;
+        }
+        if(keyword == "if") {
+            size_t close = statement.find(')');
+            if(close == string_view::npos) fail("missing ')'", statement);
+            execute(statement.substr(close + 1), scope, on_op, depth);
+            return;
+        }
+
+        // Gate application, barrier, measure or reset
+        string_view rest = statement.substr(keyword_end);
+        vector<double> params;
+        string_view trimmed = trim(rest);
+        if(!trimmed.empty() && trimmed[0] == '(') {
+            int level = 0;
+            size_t close = 0;
+            for(size_t i = 0; i < trimmed.size(); i++) {
+                if(trimmed[i] == '(') level++;
+                else if(trimmed[i] == ')' && --level == 0) { close = i; break; }
+            }
+            if(close == 0) fail("missing ')'", statement);
+            for(auto expr : split_top_level(trimmed.substr(1, close - 1), ',')) {
+                params.push_back(ExpressionParser(expr, scope).evaluate());
+            }
+            trimmed = trim(trimmed.substr(close + 1));
+        }
+        if(keyword == "measure") {
+            size_t arrow = trimmed.find("->");
+            if(arrow != string_view::npos) trimmed = trim(trimmed.substr(0, arrow));
+        }
+
+        vector<vector<int>> args;
+        size_t broadcast = 1;
+        for(auto arg : split_top_level(trimmed, ',')) {
+            args.push_back(resolve_argument(arg, scope, statement));
+            if(args.back().size() > 1) {
+                if(broadcast > 1 && args.back().size() != broadcast) fail("register size mismatch", statement);
+                broadcast = args.back().size();
+            }
+        }
+
+        // Barriers cover all their qubits at once; everything else broadcasts
+        if(keyword == "barrier") {
+            vector<int> qubits;
+            for(const auto& arg : args) qubits.insert(qubits.end(), arg.begin(), arg.end());
+            apply(keyword, params, qubits, on_op, depth);
+            return;
+        }
+        vector<int> qubits(args.size());
+        for(size_t i = 0; i < broadcast; i++) {
+            for(size_t a = 0; a < args.size(); a++) {
+                qubits[a] = args[a].size() > 1 ? args[a][i] : args[a][0];
+            }
+            apply(keyword, params, qubits, on_op, depth);
+        }
+    }
+
+public:
+    // Parses a whole program in one pass, calling on_op for each primitive operation
+    void parse(string_view source, const function<void(const QasmOp&)>& on_op) {
+        string statement;
+        size_t i = 0;
+        while(i < source.size()) {
+            char c = source[i];
+            if(c == '/' && i + 1 < source.size() && source[i + 1] == '/') {
+                i = skip_comment(source, i);
+                continue;
+            }
+            if(c == ';') {
+                execute(statement, nullptr, on_op);
+                statement.clear();
+            } else if(c == '{') {
+                // Gate definition: header is the statement so far, body runs to '}'
+                string body;
+                for(i++; i < source.size() && source[i] != '}'; i++) {
+                    if(source[i] == '/' && i + 1 < source.size() && source[i + 1] == '/') {
+                        i = skip_comment(source, i) - 1;
+                        continue;
+                    }
+                    body += source[i];
+                }
+                if(i >= source.size()) fail("unterminated gate body", statement);
+                string_view header = trim(statement);
+                if(header.substr(0, 4) == "gate") define_gate(header, body, header);
+                statement.clear();
+            } else {
+                statement += c;
+            }
+            i++;
+        }
+        if(!trim(statement).empty()) fail("missing ';'", statement);
+    }
+
+    int get_num_qubits() const { return num_qubits; }
+
+private:
+    // Returns the index just past the end of the comment's line
+    static size_t skip_comment(string_view source, size_t i) {
+        size_t newline = source.find('\n', i);
+        return newline == string_view::npos ? source.size() : newline + 1;
+    }
+};
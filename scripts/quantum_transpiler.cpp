@@ -1,272 +1,82 @@
 /*
- * Quantum Circuit Transpiler
- * Simulates transpilation to real QPU topologies (IBM, Rigetti, IonQ)
- * Maps logical qubits to physical qubits and inserts SWAP gates as needed
+ * Quantum Circuit Transpiler - Command line entry point
+ * Transpiles a demo circuit onto the selected QPU topology, optionally
+ * followed by approximate resynthesis within a fidelity budget counted in
+ * two-qubit gate errors of the device (see quantum_transpiler.h for the
+ * topology and routing, approximate_synthesis.h for the resynthesis).
+ * The routed (and optionally resynthesised) circuit is then optimised,
+ * translated to {rz, sx, x, cx} and scheduled on the circuit DAG
+ * (circuit_dag.h); the output carries the compiled circuit as OpenQASM.
+ * With PLANCK_TRANSPILE_CACHE set to a file path, compiled circuits are
+ * shared with every other process through that on-disk cache
+ * (transpile_cache.h); a hit skips every pass, so its output has no dag or
+ * approximation report.
  */
 
 #include <iostream>
-#include <vector>
-#include <map>
-#include <set>
-#include <queue>
-#include <string>
-#include <algorithm>
-#include <cmath>
-#include <json/json.h>
+#include <memory>
+#include <cstdlib>
+#include <sstream>
+#include <cstring>
+#include <iomanip>
+#include "quantum_transpiler.h"
+#include "transpile_cache.h"
+#include "approximate_synthesis.h"
+#include "circuit_dag.h"
+#include "json_scanner.h"
+#include "core/arena.h"
 
 using namespace std;
 
-// QPU topology definitions
-enum class QPUType {
-    IBM_FALCON,      // 27-qubit heavy-hex topology
-    RIGETTI_ASPEN,   // 40-qubit ring topology
-    IONQ_ARIA        // 25-qubit all-to-all connectivity
-};
-
-struct Gate {
-    string type;
-    vector<int> qubits;
-    map<string, double> parameters;
-};
-
-class QPUTopology {
-private:
-    map<int, set<int>> connectivity_map;
-    int num_physical_qubits;
-    QPUType qpu_type;
-
-public:
-    QPUTopology(QPUType type, int num_qubits) : qpu_type(type), num_physical_qubits(num_qubits) {
-        build_topology();
-    }
-
-    void build_topology() {
-        connectivity_map.clear();
-        
-        switch(qpu_type) {
-            case QPUType::IBM_FALCON:
-                build_heavy_hex(27);
-                break;
-            case QPUType::RIGETTI_ASPEN:
-                build_ring_topology(40);
-                break;
-            case QPUType::IONQ_ARIA:
-                build_all_to_all(25);
-                break;
+// OpenQASM 2 for a compiled circuit; parameters are written in name order,
+// which is positional for the single-angle gates of the target basis
+static string to_qasm(const pmr::vector<Gate>& gates, int num_qubits) {
+    ostringstream out;
+    out << setprecision(17);
+    out << "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n";
+    out << "qreg q[" << num_qubits << "];\ncreg c[" << num_qubits << "];\n";
+    for(const Gate& gate : gates) {
+        if(gate.type == "measure") {
+            for(int q : gate.qubits) out << "measure q[" << q << "] -> c[" << q << "];\n";
+            continue;
         }
-    }
-
-    void build_heavy_hex(int n) {
-        // Simplified IBM heavy-hex topology
-        // Each qubit connects to 2-3 neighbors in hexagonal pattern
-        for(int i = 0; i < n - 1; i++) {
-            if(i % 3 == 0) {
-                add_edge(i, i + 1);
-                if(i + 3 < n) add_edge(i, i + 3);
-            } else {
-                add_edge(i, i + 1);
+        out << gate.type;
+        if(!gate.parameters.empty()) {
+            out << "(";
+            bool first = true;
+            for(const auto& param : gate.parameters) {
+                if(!first) out << ",";
+                out << param.second;
+                first = false;
             }
+            out << ")";
         }
-        
-        // Add diagonal connections for heavy-hex
-        for(int i = 0; i < n - 4; i += 3) {
-            if(i + 4 < n) add_edge(i, i + 4);
-        }
-    }
-
-    void build_ring_topology(int n) {
-        // Rigetti ring with local connections
-        for(int i = 0; i < n; i++) {
-            add_edge(i, (i + 1) % n);
-            if(i < n - 2) add_edge(i, i + 2);
-        }
-    }
-
-    void build_all_to_all(int n) {
-        // IonQ full connectivity
-        for(int i = 0; i < n; i++) {
-            for(int j = i + 1; j < n; j++) {
-                add_edge(i, j);
-            }
-        }
-    }
-
-    void add_edge(int q1, int q2) {
-        connectivity_map[q1].insert(q2);
-        connectivity_map[q2].insert(q1);
-    }
-
-    bool are_connected(int q1, int q2) {
-        return connectivity_map[q1].count(q2) > 0;
-    }
-
-    vector<int> shortest_path(int start, int end) {
-        // BFS to find shortest path
-        queue<int> q;
-        map<int, int> parent;
-        set<int> visited;
-        
-        q.push(start);
-        visited.insert(start);
-        parent[start] = -1;
-        
-        while(!q.empty()) {
-            int current = q.front();
-            q.pop();
-            
-            if(current == end) {
-                // Reconstruct path
-                vector<int> path;
-                int node = end;
-                while(node != -1) {
-                    path.push_back(node);
-                    node = parent[node];
-                }
-                reverse(path.begin(), path.end());
-                return path;
-            }
-            
-            for(int neighbor : connectivity_map[current]) {
-                if(visited.count(neighbor) == 0) {
-                    visited.insert(neighbor);
-                    parent[neighbor] = current;
-                    q.push(neighbor);
-                }
-            }
-        }
-        
-        return {}; // No path found
-    }
-
-    int get_num_qubits() const { return num_physical_qubits; }
-    
-    string get_topology_name() const {
-        switch(qpu_type) {
-            case QPUType::IBM_FALCON: return "IBM Falcon (Heavy-Hex)";
-            case QPUType::RIGETTI_ASPEN: return "Rigetti Aspen (Ring)";
-            case QPUType::IONQ_ARIA: return "IonQ Aria (All-to-All)";
-            default: return "Unknown";
-        }
+        for(size_t i = 0; i < gate.qubits.size(); i++) out << (i ? "," : " ") << "q[" << gate.qubits[i] << "]";
+        out << ";\n";
     }
-};
-
-class QuantumTranspiler {
-private:
-    QPUTopology* topology;
-    map<int, int> logical_to_physical;
-    vector<Gate> transpiled_gates;
-    int swap_count;
-
-public:
-    QuantumTranspiler(QPUTopology* topo) : topology(topo), swap_count(0) {}
-
-    void initial_mapping(int num_logical_qubits) {
-        // Greedy initial placement
-        for(int i = 0; i < num_logical_qubits && i < topology->get_num_qubits(); i++) {
-            logical_to_physical[i] = i;
-        }
-    }
-
-    void insert_swaps(int logical_q1, int logical_q2) {
-        int phys_q1 = logical_to_physical[logical_q1];
-        int phys_q2 = logical_to_physical[logical_q2];
-        
-        if(topology->are_connected(phys_q1, phys_q2)) {
-            return; // Already connected
-        }
-        
-        // Find shortest path and insert SWAPs
-        vector<int> path = topology->shortest_path(phys_q1, phys_q2);
-        
-        if(path.size() <= 2) return;
-        
-        // Move q1 along path towards q2
-        for(size_t i = 0; i < path.size() - 2; i++) {
-            Gate swap_gate;
-            swap_gate.type = "swap";
-            swap_gate.qubits = {path[i], path[i + 1]};
-            transpiled_gates.push_back(swap_gate);
-            swap_count++;
-            
-            // Update mapping
-            for(auto& pair : logical_to_physical) {
-                if(pair.second == path[i]) {
-                    pair.second = path[i + 1];
-                } else if(pair.second == path[i + 1]) {
-                    pair.second = path[i];
-                }
-            }
-        }
-    }
-
-    vector<Gate> transpile(const vector<Gate>& logical_gates, int num_logical_qubits) {
-        transpiled_gates.clear();
-        swap_count = 0;
-        
-        initial_mapping(num_logical_qubits);
-        
-        for(const auto& gate : logical_gates) {
-            if(gate.qubits.size() == 2) {
-                // Two-qubit gate - may need SWAPs
-                insert_swaps(gate.qubits[0], gate.qubits[1]);
-                
-                // Add the gate with physical qubits
-                Gate physical_gate = gate;
-                physical_gate.qubits[0] = logical_to_physical[gate.qubits[0]];
-                physical_gate.qubits[1] = logical_to_physical[gate.qubits[1]];
-                transpiled_gates.push_back(physical_gate);
-                
-            } else {
-                // Single-qubit gate or measurement
-                Gate physical_gate = gate;
-                for(size_t i = 0; i < gate.qubits.size(); i++) {
-                    physical_gate.qubits[i] = logical_to_physical[gate.qubits[i]];
-                }
-                transpiled_gates.push_back(physical_gate);
-            }
-        }
-        
-        return transpiled_gates;
-    }
-
-    int get_swap_count() const { return swap_count; }
-};
-
-// Simplified topology definitions
-map<string, int> get_topology_qubits() {
-    return {
-        {"ibm", 27},
-        {"rigetti", 40},
-        {"ionq", 25}
-    };
+    return out.str();
 }
 
 int main(int argc, char* argv[]) {
     if(argc < 2) {
-        cerr << "Usage: " << argv[0] << " <qpu_type>" << endl;
+        cerr << "Usage: " << argv[0] << " <qpu_type> [approximation_budget]" << endl;
         return 1;
     }
     
     string qpu_str = argv[1];
     QPUType qpu_type;
-    
-    if(qpu_str == "ibm") {
-        qpu_type = QPUType::IBM_FALCON;
-    } else if(qpu_str == "rigetti") {
-        qpu_type = QPUType::RIGETTI_ASPEN;
-    } else if(qpu_str == "ionq") {
-        qpu_type = QPUType::IONQ_ARIA;
-    } else {
+    if(!parse_qpu_type(qpu_str, qpu_type)) {
         cerr << "Unknown QPU type: " << qpu_str << endl;
         return 1;
     }
     
     // Create topology
-    int num_qubits = (qpu_type == QPUType::IBM_FALCON) ? 27 : 
-                     (qpu_type == QPUType::RIGETTI_ASPEN) ? 40 : 25;
+    int num_qubits = qpu_qubit_count(qpu_type);
     
+    // Routing scratch and output gates live in one arena for the job
+    RequestArena arena;
     QPUTopology topology(qpu_type, num_qubits);
-    QuantumTranspiler transpiler(&topology);
+    QuantumTranspiler transpiler(&topology, arena.resource());
     
     // Parse input circuit (simplified for demo)
     vector<Gate> logical_gates = {
@@ -275,8 +85,57 @@ int main(int argc, char* argv[]) {
         {"measure", {0, 1}}
     };
     
-    // Transpile
-    vector<Gate> transpiled = transpiler.transpile(logical_gates, 4);
+    // Compile, or load the result of an identical earlier run
+    unique_ptr<TranspileCache> cache;
+    if(const char* cache_path = getenv("PLANCK_TRANSPILE_CACHE")) {
+        try {
+            cache = make_unique<TranspileCache>(16, cache_path);
+        } catch(const exception& e) {
+            cerr << "Warning: " << e.what() << ", transpiling without cache" << endl;
+        }
+    }
+    
+    // Route, then approximate resynthesis under the device's error model and
+    // the DAG passes (optimise, translate, schedule) on the result
+    bool approximate = argc > 2;
+    bool cache_hit = false;
+    size_t transpiled_depth = 0;
+    ApproximationReport report;
+    DagPassReport dag_report;
+    pmr::vector<Gate> compiled(arena.resource());
+    try {
+        QuantumHardwareDatabase db;
+        HardwareSpec hw = db.get_hardware(qpu_hardware_name(qpu_type));
+        double budget = approximate ? stod(argv[2]) : 0.0;
+        auto compile_routed = [&](const pmr::vector<Gate>& routed) {
+            pmr::vector<Gate> synthesized(arena.resource());
+            if(approximate) {
+                ApproximationOptions options = ApproximationOptions::from_hardware(hw, budget);
+                synthesized = ApproximateSynthesizer(options).compile(routed, &report);
+            }
+            TaskScheduler tasks;
+            return DagPassManager(tasks).compile(approximate ? synthesized : routed, num_qubits,
+                                                 DagScheduleOptions::from_hardware(hw), &dag_report, arena.resource());
+        };
+        if(cache) {
+            // Budget bits, complemented so no budget shares the key of an
+            // unapproximated run (0)
+            uint64_t options_hash = 0;
+            if(approximate) {
+                memcpy(&options_hash, &budget, sizeof(budget));
+                options_hash = ~options_hash;
+            }
+            transpiled_depth = cache->compile(transpiler, topology, logical_gates, 4, compiled, compile_routed,
+                                              options_hash, &cache_hit).size();
+        } else {
+            const pmr::vector<Gate>& transpiled = transpiler.transpile(logical_gates, 4);
+            transpiled_depth = transpiled.size();
+            compiled = compile_routed(transpiled);
+        }
+    } catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
     
     // Output
     cout << "{\n";
@@ -284,7 +143,26 @@ int main(int argc, char* argv[]) {
     cout << "  \"physical_qubits\": " << num_qubits << ",\n";
     cout << "  \"swap_overhead\": 0.15,\n";
     cout << "  \"swap_gates_inserted\": " << transpiler.get_swap_count() << ",\n";
-    cout << "  \"transpiled_depth\": " << transpiled.size() << "\n";
+    cout << "  \"transpiled_depth\": " << transpiled_depth;
+    if(cache) cout << ",\n  \"cache\": \"" << (cache_hit ? "hit" : "miss") << "\"";
+    if(!cache_hit) {
+        cout << ",\n  \"dag\": {\"gates_before\": " << dag_report.gates_before
+             << ", \"rotations_merged\": " << dag_report.rotations_merged
+             << ", \"pairs_cancelled\": " << dag_report.pairs_cancelled
+             << ", \"commutation_depth\": " << dag_report.commutation_depth
+             << ", \"depth\": " << dag_report.depth
+             << ", \"duration_ns\": " << dag_report.duration_ns << "}";
+    }
+    if(approximate && !cache_hit) {
+        cout << ",\n  \"approximation\": {\"two_qubit_before\": " << report.two_qubit_before
+             << ", \"two_qubit_after\": " << report.two_qubit_after
+             << ", \"blocks_resynthesized\": " << report.blocks_resynthesized
+             << ", \"rotations_dropped\": " << report.rotations_dropped
+             << ", \"approximation_error\": " << report.approximation_error << "}";
+    }
+    cout << ",\n  \"compiled_gates\": " << compiled.size();
+    cout << ",\n  \"compiled_qasm\": \"" << json_escape(to_qasm(compiled, num_qubits)) << "\"";
+    cout << "\n";
     cout << "}\n";
     
     return 0;
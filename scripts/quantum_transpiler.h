@@ -0,0 +1,569 @@
+/*
+ * Quantum Circuit Transpiler
+ * Simulates transpilation to real QPU topologies (IBM, Rigetti, IonQ)
+ * Maps logical qubits to physical qubits and inserts SWAP gates as needed,
+ * and patches an existing routing when calibration changes the coupling map
+ */
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <memory_resource>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "core/topology.h"
+#include "core/metrics.h"
+
+using namespace std;
+
+using GateParameters = pmr::map<pmr::string, double, less<>>;
+
+// Calibration change to apply to a QPUTopology
+struct CouplingMapDiff {
+    vector<pair<int, int>> removed_edges;  // Disabled couplers
+    vector<pair<int, int>> added_edges;    // Restored or new couplers
+    vector<int> disabled_qubits;           // Dead qubits lose every coupler
+};
+
+// Allocator-aware, so a routed circuit can live entirely in a request arena
+// (core/arena.h); copies made without an allocator use the default heap
+struct Gate {
+    using allocator_type = pmr::polymorphic_allocator<byte>;
+
+    pmr::string type;
+    pmr::vector<int> qubits;
+    GateParameters parameters;
+
+    explicit Gate(allocator_type alloc = {}) : type(alloc), qubits(alloc), parameters(alloc) {}
+
+    Gate(string_view name, initializer_list<int> targets,
+         initializer_list<GateParameters::value_type> params = {}, allocator_type alloc = {})
+        : type(name, alloc), qubits(targets, alloc), parameters(params, alloc) {}
+
+    Gate(string_view name, const vector<int>& targets, allocator_type alloc = {})
+        : type(name, alloc), qubits(targets.begin(), targets.end(), alloc), parameters(alloc) {}
+
+    Gate(const Gate& other, allocator_type alloc = {})
+        : type(other.type, alloc), qubits(other.qubits, alloc), parameters(other.parameters, alloc) {}
+
+    Gate(Gate&& other) = default;
+
+    Gate(Gate&& other, allocator_type alloc)
+        : type(move(other.type), alloc), qubits(move(other.qubits), alloc),
+          parameters(move(other.parameters), alloc) {}
+
+    Gate& operator=(const Gate&) = default;
+    Gate& operator=(Gate&&) = default;
+};
+
+class QPUTopology {
+private:
+    pmr::map<int, pmr::set<int>> connectivity_map;
+    int num_physical_qubits;
+    QPUType qpu_type;
+    pmr::set<int> disabled_qubits;
+
+    // All-pairs hop counts (row-major, table_size^2); empty until
+    // build_distance_table(), then kept current by every edge change
+    pmr::vector<int> distances;
+    int table_size = 0;
+
+    int& dist(int a, int b) { return distances[(size_t)a * table_size + b]; }
+
+    // Recomputes row and column source of the distance table
+    void distance_row(int source) {
+        PLANCK_COUNT(BFS_CALLS, 1);
+        int* row = &distances[(size_t)source * table_size];
+        fill(row, row + table_size, UNREACHABLE);
+        pmr::vector<int> queue(distances.get_allocator());
+        queue.reserve(table_size);
+        queue.push_back(source);
+        row[source] = 0;
+        for(size_t head = 0; head < queue.size(); head++) {
+            int current = queue[head];
+            auto neighbors = connectivity_map.find(current);
+            if(neighbors == connectivity_map.end()) continue;
+            for(int neighbor : neighbors->second) {
+                if(row[neighbor] == UNREACHABLE) {
+                    row[neighbor] = row[current] + 1;
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+        for(int t = 0; t < table_size; t++) dist(t, source) = row[t];
+    }
+
+public:
+    static constexpr int UNREACHABLE = 1 << 29;
+
+    QPUTopology(QPUType type, int num_qubits, pmr::memory_resource* memory = pmr::get_default_resource())
+        : connectivity_map(memory), num_physical_qubits(num_qubits), qpu_type(type),
+          disabled_qubits(memory), distances(memory) {
+        build_topology();
+    }
+
+    void build_topology() {
+        connectivity_map.clear();
+        disabled_qubits.clear();
+        distances.clear();
+        for(const auto& edge : qpu_coupling_map(qpu_type)) add_edge(edge.first, edge.second);
+    }
+
+    // A new edge can only shorten paths through it, so every pair is
+    // relaxed against the two rows it joins: O(n^2) instead of n BFS runs
+    void add_edge(int q1, int q2) {
+        if(!connectivity_map[q1].insert(q2).second) return;
+        connectivity_map[q2].insert(q1);
+        disabled_qubits.erase(q1);
+        disabled_qubits.erase(q2);
+        if(distances.empty()) return;
+        if(max(q1, q2) >= table_size) {
+            build_distance_table();
+            return;
+        }
+
+        pmr::vector<int> from_q1(&distances[(size_t)q1 * table_size], &distances[(size_t)(q1 + 1) * table_size],
+                                 distances.get_allocator());
+        pmr::vector<int> from_q2(&distances[(size_t)q2 * table_size], &distances[(size_t)(q2 + 1) * table_size],
+                                 distances.get_allocator());
+        for(int s = 0; s < table_size; s++) {
+            for(int t = 0; t < table_size; t++) {
+                int through = min(from_q1[s] + 1 + from_q2[t], from_q2[s] + 1 + from_q1[t]);
+                if(through < dist(s, t)) dist(s, t) = through;
+            }
+        }
+    }
+
+    // Only sources with the edge on one of their shortest paths, i.e. whose
+    // distances to the two ends differ by one, need their BFS row redone
+    void remove_edge(int q1, int q2) {
+        auto a = connectivity_map.find(q1);
+        auto b = connectivity_map.find(q2);
+        if(a == connectivity_map.end() || b == connectivity_map.end() || !a->second.erase(q2)) return;
+        b->second.erase(q1);
+        // Empty entries are dropped so the structural hash matches a fresh build
+        if(a->second.empty()) connectivity_map.erase(a);
+        if(b->second.empty()) connectivity_map.erase(b);
+        if(distances.empty()) return;
+
+        pmr::vector<int> affected(distances.get_allocator());
+        for(int s = 0; s < table_size; s++) {
+            int d1 = dist(s, q1), d2 = dist(s, q2);
+            if(d1 != UNREACHABLE && abs(d1 - d2) == 1) affected.push_back(s);
+        }
+        for(int s : affected) distance_row(s);
+    }
+
+    void disable_qubit(int q) {
+        auto node = connectivity_map.find(q);
+        if(node != connectivity_map.end()) {
+            pmr::vector<int> neighbors(node->second.begin(), node->second.end(), distances.get_allocator());
+            for(int neighbor : neighbors) remove_edge(q, neighbor);
+        }
+        disabled_qubits.insert(q);
+    }
+
+    void apply_diff(const CouplingMapDiff& diff) {
+        for(int q : diff.disabled_qubits) disable_qubit(q);
+        for(const auto& edge : diff.removed_edges) remove_edge(edge.first, edge.second);
+        for(const auto& edge : diff.added_edges) add_edge(edge.first, edge.second);
+    }
+
+    bool is_disabled(int q) const { return disabled_qubits.count(q) > 0; }
+
+    bool are_connected(int q1, int q2) const {
+        auto node = connectivity_map.find(q1);
+        return node != connectivity_map.end() && node->second.count(q2) > 0;
+    }
+
+    // One BFS per qubit; afterwards edge changes update the table in place
+    void build_distance_table() {
+        table_size = num_physical_qubits;
+        if(!connectivity_map.empty()) table_size = max(table_size, connectivity_map.rbegin()->first + 1);
+        distances.assign((size_t)table_size * table_size, UNREACHABLE);
+        for(int s = 0; s < table_size; s++) distance_row(s);
+    }
+
+    bool has_distance_table() const { return !distances.empty(); }
+
+    int distance(int a, int b) const {
+        if(a >= table_size || b >= table_size) return a == b ? 0 : UNREACHABLE;
+        return distances[(size_t)a * table_size + b];
+    }
+
+    // Shortest path from start to end, allocated from memory. With a
+    // distance table the walk takes the lowest-numbered neighbour one hop
+    // closer at each step; otherwise a BFS runs over the coupling map with
+    // scratch space from memory (qubit ids index the scratch arrays).
+    pmr::vector<int> shortest_path(int start, int end,
+                                   pmr::memory_resource* memory = pmr::get_default_resource()) const {
+        if(has_distance_table()) {
+            pmr::vector<int> path(memory);
+            int remaining = distance(start, end);
+            if(remaining == UNREACHABLE) return path;
+            path.reserve(remaining + 1);
+            path.push_back(start);
+            for(int current = start; current != end; remaining--) {
+                for(int neighbor : connectivity_map.find(current)->second) {
+                    if(distance(neighbor, end) == remaining - 1) {
+                        current = neighbor;
+                        break;
+                    }
+                }
+                path.push_back(current);
+            }
+            return path;
+        }
+
+        PLANCK_COUNT(BFS_CALLS, 1);
+        int size = max({num_physical_qubits, start + 1, end + 1});
+        if(!connectivity_map.empty()) size = max(size, connectivity_map.rbegin()->first + 1);
+
+        const int UNVISITED = -2;
+        pmr::vector<int> parent(size, UNVISITED, memory);
+        pmr::vector<int> queue(memory);
+        queue.reserve(size);
+        queue.push_back(start);
+        parent[start] = -1;
+
+        for(size_t head = 0; head < queue.size(); head++) {
+            int current = queue[head];
+
+            if(current == end) {
+                // Reconstruct path
+                pmr::vector<int> path(memory);
+                for(int node = end; node != -1; node = parent[node]) path.push_back(node);
+                reverse(path.begin(), path.end());
+                return path;
+            }
+
+            auto neighbors = connectivity_map.find(current);
+            if(neighbors == connectivity_map.end()) continue;
+            for(int neighbor : neighbors->second) {
+                if(parent[neighbor] == UNVISITED) {
+                    parent[neighbor] = current;
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+
+        return pmr::vector<int>(memory); // No path found
+    }
+
+    int get_num_qubits() const { return num_physical_qubits; }
+
+    // FNV-1a over the coupling map; equal for identical connectivity
+    uint64_t structural_hash() const {
+        uint64_t hash = 14695981039346656037ULL;
+        auto mix = [&](uint64_t value) {
+            hash ^= value;
+            hash *= 1099511628211ULL;
+        };
+        mix(num_physical_qubits);
+        for(const auto& node : connectivity_map) {
+            mix(node.first);
+            for(int neighbor : node.second) mix(((uint64_t)node.first << 32) | (uint32_t)neighbor);
+        }
+        for(int q : disabled_qubits) mix(~(uint64_t)q);
+        return hash;
+    }
+    
+    string get_topology_name() const { return qpu_topology_name(qpu_type); }
+};
+
+class QuantumTranspiler {
+private:
+    QPUTopology* topology;
+    pmr::memory_resource* memory;
+    pmr::vector<int> logical_to_physical;
+    pmr::vector<int> physical_to_logical;  // -1 for free qubits
+    pmr::vector<Gate> transpiled_gates;
+    pmr::vector<int> source_gates;  // Per transpiled gate: index of its logical gate, -1 for SWAPs
+    int swap_count;
+    size_t rerouted_windows = 0;
+
+    template<typename GateAllocator>
+    void check_circuit(const vector<Gate, GateAllocator>& logical_gates, int num_logical_qubits) const {
+        if(num_logical_qubits > topology->get_num_qubits()) {
+            throw runtime_error("Circuit needs " + to_string(num_logical_qubits) + " qubits, topology has " +
+                                to_string(topology->get_num_qubits()) + " (cut it with CircuitCutter)");
+        }
+        for(const Gate& gate : logical_gates) {
+            for(int q : gate.qubits) {
+                if(q < 0 || q >= num_logical_qubits) throw runtime_error("Gate on qubit " + to_string(q) + " outside the circuit");
+            }
+        }
+    }
+
+    void swap_physical(int a, int b) {
+        int la = physical_to_logical[a], lb = physical_to_logical[b];
+        physical_to_logical[a] = lb;
+        physical_to_logical[b] = la;
+        if(la >= 0) logical_to_physical[la] = b;
+        if(lb >= 0) logical_to_physical[lb] = a;
+    }
+
+    // Appends the gate on its current physical qubits, preceded by any
+    // SWAPs a two-qubit gate needs
+    void route_gate(const Gate& gate, int index) {
+        if(gate.qubits.size() == 2) {
+            // Two-qubit gate - may need SWAPs
+            insert_swaps(gate.qubits[0], gate.qubits[1]);
+        }
+        // Add the gate with physical qubits
+        Gate& physical_gate = transpiled_gates.emplace_back(gate);
+        for(size_t i = 0; i < gate.qubits.size(); i++) {
+            physical_gate.qubits[i] = logical_to_physical[gate.qubits[i]];
+        }
+        source_gates.push_back(index);
+    }
+
+    // Free, enabled qubit closest to where the logical qubit's two-qubit
+    // partners start; lowest index on ties
+    template<typename GateAllocator>
+    int relocation_target(const vector<Gate, GateAllocator>& logical_gates, int logical) const {
+        pmr::vector<int> partners(memory);
+        for(const Gate& gate : logical_gates) {
+            if(gate.qubits.size() != 2) continue;
+            if(gate.qubits[0] == logical) partners.push_back(logical_to_physical[gate.qubits[1]]);
+            else if(gate.qubits[1] == logical) partners.push_back(logical_to_physical[gate.qubits[0]]);
+        }
+        int best = -1;
+        long best_cost = 0;
+        for(int p = 0; p < topology->get_num_qubits(); p++) {
+            if(physical_to_logical[p] >= 0 || topology->is_disabled(p)) continue;
+            long cost = 0;
+            for(int partner : partners) {
+                if(!topology->is_disabled(partner)) cost += topology->distance(p, partner);
+            }
+            if(best < 0 || cost < best_cost) {
+                best = p;
+                best_cost = cost;
+            }
+        }
+        if(best < 0) throw runtime_error("No free qubit to move logical qubit " + to_string(logical) + " to");
+        return best;
+    }
+
+    // Layout a routing started from: each logical qubit's first use, traced
+    // back through the SWAPs before it. Logical qubits no gate touches go to
+    // the lowest free enabled qubits.
+    template<typename GateAllocator, typename RoutedGates, typename SourceIndices>
+    void recover_layout(const vector<Gate, GateAllocator>& logical_gates, int num_logical_qubits,
+                        const RoutedGates& routed, const SourceIndices& source) {
+        int num_physical = topology->get_num_qubits();
+        logical_to_physical.assign(num_logical_qubits, -1);
+        physical_to_logical.assign(num_physical, -1);
+        // origin[p]: where the state now on p started
+        pmr::vector<int> origin(num_physical, 0, memory);
+        for(int p = 0; p < num_physical; p++) origin[p] = p;
+        for(size_t i = 0; i < routed.size(); i++) {
+            const auto& qubits = routed[i].qubits;
+            if(source[i] < 0) {
+                swap(origin[qubits[0]], origin[qubits[1]]);
+                continue;
+            }
+            const Gate& logical = logical_gates[source[i]];
+            for(size_t k = 0; k < logical.qubits.size() && k < qubits.size(); k++) {
+                int l = logical.qubits[k];
+                if(logical_to_physical[l] >= 0) continue;
+                logical_to_physical[l] = origin[qubits[k]];
+                physical_to_logical[origin[qubits[k]]] = l;
+            }
+        }
+        int p = 0;
+        for(int l = 0; l < num_logical_qubits; l++) {
+            if(logical_to_physical[l] >= 0) continue;
+            while(p < num_physical && (physical_to_logical[p] >= 0 || topology->is_disabled(p))) p++;
+            if(p == num_physical) throw runtime_error("No free qubit to place logical qubit " + to_string(l) + " on");
+            logical_to_physical[l] = p;
+            physical_to_logical[p] = l;
+        }
+    }
+
+public:
+    // All routing state and output gates are allocated from memory, e.g. a
+    // per-job RequestArena
+    QuantumTranspiler(QPUTopology* topo, pmr::memory_resource* mem = pmr::get_default_resource())
+        : topology(topo), memory(mem), logical_to_physical(mem), physical_to_logical(mem),
+          transpiled_gates(mem), source_gates(mem), swap_count(0) {}
+
+    // Logical qubit i on the i-th enabled physical qubit
+    void initial_mapping(int num_logical_qubits) {
+        logical_to_physical.assign(num_logical_qubits, -1);
+        physical_to_logical.assign(topology->get_num_qubits(), -1);
+        int p = 0;
+        for(int i = 0; i < num_logical_qubits; i++, p++) {
+            while(p < topology->get_num_qubits() && topology->is_disabled(p)) p++;
+            if(p == topology->get_num_qubits()) {
+                throw runtime_error("Circuit needs " + to_string(num_logical_qubits) + " enabled qubits, topology has " + to_string(i));
+            }
+            logical_to_physical[i] = p;
+            physical_to_logical[p] = i;
+        }
+    }
+
+    void insert_swaps(int logical_q1, int logical_q2) {
+        int phys_q1 = logical_to_physical[logical_q1];
+        int phys_q2 = logical_to_physical[logical_q2];
+        
+        if(topology->are_connected(phys_q1, phys_q2)) {
+            return; // Already connected
+        }
+        
+        // Find shortest path and insert SWAPs
+        pmr::vector<int> path = topology->shortest_path(phys_q1, phys_q2, memory);
+        
+        if(path.empty()) {
+            throw runtime_error("No route between physical qubits " + to_string(phys_q1) + " and " + to_string(phys_q2));
+        }
+        if(path.size() <= 2) return;
+        PLANCK_COUNT(SWAPS_INSERTED, path.size() - 2);
+        
+        // Move q1 along path towards q2
+        for(size_t i = 0; i < path.size() - 2; i++) {
+            Gate& swap_gate = transpiled_gates.emplace_back();
+            swap_gate.type = "swap";
+            swap_gate.qubits = {path[i], path[i + 1]};
+            source_gates.push_back(-1);
+            swap_count++;
+            swap_physical(path[i], path[i + 1]);
+        }
+    }
+
+    // The result is owned by the transpiler and valid until the next call
+    template<typename GateAllocator>
+    const pmr::vector<Gate>& transpile(const vector<Gate, GateAllocator>& logical_gates, int num_logical_qubits) {
+        PLANCK_TIME_STAGE(ROUTE);
+        check_circuit(logical_gates, num_logical_qubits);
+        transpiled_gates.clear();
+        source_gates.clear();
+        transpiled_gates.reserve(logical_gates.size());
+        source_gates.reserve(logical_gates.size());
+        swap_count = 0;
+        
+        initial_mapping(num_logical_qubits);
+        
+        for(size_t index = 0; index < logical_gates.size(); index++) {
+            route_gate(logical_gates[index], index);
+        }
+        
+        return transpiled_gates;
+    }
+
+    // Loads a routing produced elsewhere (e.g. a cached template) as if this
+    // transpiler had produced it, for reroute() or to serve a cache hit
+    template<typename RoutedGates, typename SourceIndices>
+    const pmr::vector<Gate>& set_routing(const RoutedGates& gates, const SourceIndices& source) {
+        transpiled_gates.assign(gates.begin(), gates.end());
+        source_gates.assign(source.begin(), source.end());
+        swap_count = count(source_gates.begin(), source_gates.end(), -1);
+        return transpiled_gates;
+    }
+
+    // Patches the current routing of logical_gates after the topology has
+    // changed (QPUTopology::apply_diff). The routing is split into windows,
+    // one logical gate and the SWAPs in front of it. Old qubits are tracked
+    // through a permutation onto the new layout; a window whose relabelled
+    // couplers all still exist is copied, any other window is routed again
+    // from the current layout. The old routing's starting layout is recovered
+    // from the routing itself; logical qubits that start on a disabled qubit
+    // are first moved to the closest free qubit. Builds the topology's
+    // distance table if needed, so later diffs update it instead of
+    // re-running BFS.
+    template<typename GateAllocator>
+    const pmr::vector<Gate>& reroute(const vector<Gate, GateAllocator>& logical_gates, int num_logical_qubits) {
+        PLANCK_TIME_STAGE(ROUTE);
+        check_circuit(logical_gates, num_logical_qubits);
+        if(!topology->has_distance_table()) topology->build_distance_table();
+        int num_physical = topology->get_num_qubits();
+
+        pmr::vector<Gate> previous_gates(memory);
+        pmr::vector<int> previous_source(memory);
+        previous_gates.swap(transpiled_gates);
+        previous_source.swap(source_gates);
+        // Headroom for detours, so the output never moves every gate to grow
+        transpiled_gates.reserve(previous_gates.size() + previous_gates.size() / 4);
+        source_gates.reserve(transpiled_gates.capacity());
+        swap_count = 0;
+        rerouted_windows = 0;
+        recover_layout(logical_gates, num_logical_qubits, previous_gates, previous_source);
+
+        // relabel[p]: where whatever sits on the old routing's qubit p now
+        // sits; placed[q] is the inverse
+        pmr::vector<int> relabel(num_physical, 0, memory);
+        for(int p = 0; p < num_physical; p++) relabel[p] = p;
+        pmr::vector<int> placed(relabel, memory);
+        // A SWAP applied to only the old or only the new routing
+        auto old_side_swap = [&](int a, int b) {
+            swap(relabel[a], relabel[b]);
+            placed[relabel[a]] = a;
+            placed[relabel[b]] = b;
+        };
+        auto new_side_swap = [&](int x, int y) {
+            swap(placed[x], placed[y]);
+            relabel[placed[x]] = x;
+            relabel[placed[y]] = y;
+        };
+        for(int logical = 0; logical < num_logical_qubits; logical++) {
+            int dead = logical_to_physical[logical];
+            if(!topology->is_disabled(dead)) continue;
+            int target = relocation_target(logical_gates, logical);
+            swap_physical(dead, target);
+            new_side_swap(dead, target);
+        }
+
+        auto usable = [&](const Gate& gate) {
+            for(int q : gate.qubits) if(topology->is_disabled(relabel[q])) return false;
+            return gate.qubits.size() != 2 || topology->are_connected(relabel[gate.qubits[0]], relabel[gate.qubits[1]]);
+        };
+
+        size_t start = 0;
+        while(start < previous_gates.size()) {
+            size_t end = start;
+            while(end < previous_gates.size() && previous_source[end] < 0) end++;
+            if(end == previous_gates.size()) break;  // Trailing SWAPs without a gate
+
+            bool copy = true;
+            for(size_t i = start; copy && i <= end; i++) copy = usable(previous_gates[i]);
+
+            if(copy) {
+                // Same move on both sides, so the permutation is unchanged
+                for(size_t i = start; i <= end; i++) {
+                    Gate& gate = transpiled_gates.emplace_back(move(previous_gates[i]));
+                    for(int& q : gate.qubits) q = relabel[q];
+                    source_gates.push_back(previous_source[i]);
+                    if(previous_source[i] < 0) {
+                        swap_count++;
+                        swap_physical(gate.qubits[0], gate.qubits[1]);
+                    }
+                }
+            } else {
+                for(size_t i = start; i < end; i++) {
+                    old_side_swap(previous_gates[i].qubits[0], previous_gates[i].qubits[1]);
+                }
+                size_t first_new = transpiled_gates.size();
+                route_gate(logical_gates[previous_source[end]], previous_source[end]);
+                for(size_t i = first_new; i + 1 < transpiled_gates.size(); i++) {
+                    new_side_swap(transpiled_gates[i].qubits[0], transpiled_gates[i].qubits[1]);
+                }
+                rerouted_windows++;
+            }
+            start = end + 1;
+        }
+
+        return transpiled_gates;
+    }
+
+    int get_swap_count() const { return swap_count; }
+    size_t get_rerouted_windows() const { return rerouted_windows; }
+    const pmr::vector<int>& get_source_gates() const { return source_gates; }
+};
@@ -0,0 +1,130 @@
+/*
+ * Shot Budget Optimizer - Command line entry point
+ * Reads one measurement group per line (NDJSON) from stdin and prints the
+ * cheapest shot allocation reaching the target standard error on each backend
+ * (see shot_budget_optimizer.h for the allocation itself)
+ *
+ * Group fields (all optional):
+ *   label, weight, depth, gates_1q, gates_2q
+ *   variance                 per-shot variance, used as is
+ *   expectation              prior <O> of a Pauli observable
+ *   std_error + shots        result of an earlier run of the same group
+ *   pilot + mask             pilot counts {"bits": count, ...} and parity mask
+ * Without any of these the worst case (variance 1) is assumed.
+ */
+
+#include <iostream>
+#include <sstream>
+#include "shot_budget_optimizer.h"
+#include "json_scanner.h"
+
+using namespace std;
+
+MeasurementGroup parse_group(string_view line) {
+    MeasurementGroup group;
+    double std_error = -1, prior_shots = -1, expectation = 2;
+    bool has_variance = false;
+    map<string, double> pilot;
+    string mask, text;
+
+    JsonScanner(line).scan_object([&](string_view key, const JsonValue& value) {
+        if(key == "label") { json_unescape(value.text, text); group.label = text; }
+        else if(key == "weight") group.weight = value.number;
+        else if(key == "depth") group.depth = (int)value.number;
+        else if(key == "gates_1q") group.gates_1q = (int)value.number;
+        else if(key == "gates_2q") group.gates_2q = (int)value.number;
+        else if(key == "variance") { group.variance = value.number; has_variance = true; }
+        else if(key == "expectation") expectation = value.number;
+        else if(key == "std_error") std_error = value.number;
+        else if(key == "shots") prior_shots = value.number;
+        else if(key == "mask") mask = string(value.text);
+        else if(key == "pilot" && value.type == JsonType::OBJECT) {
+            JsonScanner(value.text).scan_object([&](string_view bits, const JsonValue& count) {
+                pilot[string(bits)] = count.number;
+            });
+        }
+    });
+
+    if(has_variance) return group;
+    if(!pilot.empty()) {
+        if(mask.empty()) mask = string(pilot.begin()->first.size(), '1');
+        group.variance = variance_from_counts(pilot, mask);
+    } else if(std_error >= 0 && prior_shots > 0) {
+        group.variance = variance_from_history(std_error, (long)prior_shots);
+    } else if(expectation <= 1) {
+        group.variance = pauli_variance(expectation);
+    }
+    return group;
+}
+
+string plan_to_json(const ShotPlan& plan, const vector<MeasurementGroup>& groups) {
+    stringstream ss;
+    ss << "{\"backend\":\"" << plan.backend << "\",\"feasible\":" << (plan.feasible ? "true" : "false")
+       << ",\"total_shots\":" << plan.total_shots << ",\"std_error\":" << plan.std_error
+       << ",\"qpu_seconds\":" << plan.qpu_seconds << ",\"wall_seconds\":" << plan.wall_seconds
+       << ",\"uniform_qpu_seconds\":" << plan.uniform_qpu_seconds << ",\"groups\":[";
+    for(size_t g = 0; g < groups.size(); g++) {
+        if(g > 0) ss << ",";
+        ss << "{\"label\":\"" << json_escape(groups[g].label) << "\",\"variance\":" << groups[g].variance
+           << ",\"shots\":" << plan.shots[g] << "}";
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 3) {
+        cerr << "Usage: " << argv[0] << " <backend[,backend...]|all> <target_std_error>"
+             << " [--min-shots N] [--max-shots N] < groups.ndjson" << endl;
+        return 1;
+    }
+
+    QuantumHardwareDatabase db;
+    try {
+        vector<string> backends;
+        string list = argv[1];
+        if(list == "all") {
+            backends = db.list_hardware();
+        } else {
+            stringstream names(list);
+            string name;
+            while(getline(names, name, ',')) if(!name.empty()) backends.push_back(name);
+        }
+        double target = stod(argv[2]);
+
+        long min_shots = 100, max_shots = 100000;
+        for(int i = 3; i + 1 < argc; i++) {
+            string arg = argv[i];
+            if(arg == "--min-shots") min_shots = stol(argv[++i]);
+            else if(arg == "--max-shots") max_shots = stol(argv[++i]);
+        }
+
+        vector<MeasurementGroup> groups;
+        string line;
+        while(getline(cin, line)) {
+            if(line.find_first_not_of(" \t\r") == string::npos) continue;
+            groups.push_back(parse_group(line));
+            if(groups.back().label.empty()) groups.back().label = "g" + to_string(groups.size() - 1);
+        }
+
+        ShotBudgetOptimizer optimizer(db, min_shots, max_shots);
+        vector<ShotPlan> plans;
+        for(const auto& backend : backends) plans.push_back(optimizer.plan(backend, groups, target));
+        sort(plans.begin(), plans.end(), [](const ShotPlan& a, const ShotPlan& b) {
+            if(a.feasible != b.feasible) return a.feasible;
+            return a.wall_seconds < b.wall_seconds;
+        });
+
+        cout << "[";
+        for(size_t i = 0; i < plans.size(); i++) {
+            if(i > 0) cout << ",";
+            cout << plan_to_json(plans[i], groups);
+        }
+        cout << "]" << endl;
+    } catch(const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
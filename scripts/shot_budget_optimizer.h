@@ -0,0 +1,180 @@
+/*
+ * Shot Budget Optimizer - Minimum shots for a target precision
+ * A ±1-valued observable estimated from n shots has standard error σ/√n, so
+ * the minimum shot count for a target error ε is ⌈σ²/ε²⌉. For an observable
+ * H = Σ w_g O_g measured in several groups, minimizing Σ c_g n_g subject to
+ * Var(H) = Σ w_g² σ_g² / n_g ≤ ε² gives n_g ∝ |w_g| σ_g / √c_g, where c_g is
+ * the per-shot cost of group g on the backend (from readout_time and CLOPS).
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "quantum_hardware_benchmarks.h"
+
+using namespace std;
+
+// One measurement setting (circuit) contributing w * <O> to the observable
+struct MeasurementGroup {
+    string label;
+    double weight = 1.0;
+    double variance = 1.0;   // Per-shot variance; 1 is the worst case for a Pauli
+    int depth = 1;           // Circuit layers including the basis change
+    int gates_1q = 0;
+    int gates_2q = 0;
+};
+
+struct ShotPlan {
+    string backend;
+    vector<long> shots;        // Per group, same order as the input
+    long total_shots = 0;
+    double std_error = 0.0;    // Predicted standard error of the weighted sum
+    double qpu_seconds = 0.0;  // Shot time only
+    double wall_seconds = 0.0; // Including one submission latency per group
+    double uniform_qpu_seconds = 0.0;  // Same precision with equal shots per group
+    bool feasible = true;      // False when max_shots stops us reaching the target
+};
+
+// Per-shot variance of a ±1 observable with the given expectation value
+inline double pauli_variance(double expectation) {
+    expectation = max(-1.0, min(1.0, expectation));
+    return 1.0 - expectation * expectation;
+}
+
+// Per-shot variance implied by an earlier run that reached std_error at shots
+inline double variance_from_history(double std_error, long shots) {
+    return std_error * std_error * shots;
+}
+
+// Sample variance of the parity of the masked bits over pilot counts.
+// mask is aligned with the bitstrings ('1' marks a measured qubit).
+inline double variance_from_counts(const map<string, double>& counts, const string& mask,
+                                   double* expectation = nullptr) {
+    double total = 0.0, sum = 0.0;
+    for(const auto& entry : counts) {
+        const string& bits = entry.first;
+        if(bits.size() != mask.size()) throw runtime_error("Pilot bitstring does not match mask: " + bits);
+        int parity = 0;
+        for(size_t i = 0; i < bits.size(); i++) {
+            if(mask[i] == '1' && bits[i] == '1') parity ^= 1;
+        }
+        total += entry.second;
+        sum += parity ? -entry.second : entry.second;
+    }
+    if(total < 2) throw runtime_error("Pilot run needs at least two shots");
+
+    double mean = sum / total;
+    if(expectation) *expectation = mean;
+    return pauli_variance(mean) * total / (total - 1);  // Unbiased
+}
+
+inline long minimum_shots(double variance, double target_std_error) {
+    if(target_std_error <= 0) throw runtime_error("Target standard error must be positive");
+    return max(1L, (long)ceil(variance / (target_std_error * target_std_error)));
+}
+
+class ShotBudgetOptimizer {
+private:
+    const QuantumHardwareDatabase& db;
+    long min_shots;
+    long max_shots;
+
+public:
+    ShotBudgetOptimizer(const QuantumHardwareDatabase& database, long min_group_shots = 100,
+                        long max_group_shots = 100000)
+        : db(database), min_shots(min_group_shots), max_shots(max_group_shots) {}
+
+    // Seconds of QPU time per shot: the slower of the gate-level estimate
+    // (gates plus readout) and the CLOPS throughput bound for depth layers
+    double shot_seconds(const string& backend, const MeasurementGroup& group) const {
+        HardwareSpec hw = db.get_hardware(backend);
+        double circuit_ns;
+        if(group.gates_1q + group.gates_2q > 0) {
+            circuit_ns = db.estimate_circuit_time(backend, group.gates_1q, group.gates_2q, group.depth);
+        } else {
+            circuit_ns = group.depth * hw.two_qubit_gate_time + hw.readout_time;  // Pessimistic layers
+        }
+        double clops_seconds = hw.clops > 0 ? group.depth / hw.clops : 0.0;
+        return max(circuit_ns * 1e-9, clops_seconds);
+    }
+
+    // Cost-weighted Neyman allocation. Groups pushed past min/max shots are
+    // pinned there and the remaining variance budget is re-split among the rest.
+    ShotPlan plan(const string& backend, const vector<MeasurementGroup>& groups, double target_std_error) const {
+        if(groups.empty()) throw runtime_error("No measurement groups");
+        if(target_std_error <= 0) throw runtime_error("Target standard error must be positive");
+        HardwareSpec hw = db.get_hardware(backend);
+
+        size_t n = groups.size();
+        vector<double> cost(n), spread(n);   // c_g and |w_g| σ_g
+        for(size_t g = 0; g < n; g++) {
+            cost[g] = shot_seconds(backend, groups[g]);
+            spread[g] = fabs(groups[g].weight) * sqrt(max(0.0, groups[g].variance));
+        }
+
+        ShotPlan plan;
+        plan.backend = backend;
+        plan.shots.assign(n, 0);
+        vector<bool> pinned(n, false);
+        double budget = target_std_error * target_std_error;
+
+        // Groups with nothing to estimate only need the floor
+        for(size_t g = 0; g < n; g++) {
+            if(spread[g] == 0) {
+                plan.shots[g] = min_shots;
+                pinned[g] = true;
+            }
+        }
+
+        bool changed = true;
+        while(changed) {
+            changed = false;
+            double free_budget = budget, scale = 0.0;
+            for(size_t g = 0; g < n; g++) {
+                if(pinned[g]) free_budget -= spread[g] * spread[g] / plan.shots[g];
+                else scale += spread[g] * sqrt(cost[g]);
+            }
+            if(scale == 0) break;
+            if(free_budget <= 0) {
+                // The pinned-at-max groups alone exceed the budget
+                for(size_t g = 0; g < n; g++) if(!pinned[g]) plan.shots[g] = max_shots;
+                plan.feasible = false;
+                break;
+            }
+            for(size_t g = 0; g < n; g++) {
+                if(pinned[g]) continue;
+                double optimum = spread[g] / sqrt(cost[g]) * scale / free_budget;
+                long shots = (long)ceil(optimum);
+                if(shots < min_shots || shots > max_shots) {
+                    plan.shots[g] = max(min_shots, min(max_shots, shots));
+                    pinned[g] = true;
+                    changed = true;
+                } else {
+                    plan.shots[g] = shots;
+                }
+            }
+        }
+
+        double variance = 0.0, uniform_scale = 0.0, cost_sum = 0.0;
+        for(size_t g = 0; g < n; g++) {
+            plan.total_shots += plan.shots[g];
+            variance += spread[g] * spread[g] / plan.shots[g];
+            plan.qpu_seconds += plan.shots[g] * cost[g];
+            uniform_scale += spread[g] * spread[g];
+            cost_sum += cost[g];
+        }
+        plan.std_error = sqrt(variance);
+        if(variance > budget * (1 + 1e-9)) plan.feasible = false;
+        plan.wall_seconds = plan.qpu_seconds + n * hw.typical_latency / 1000.0;
+
+        long uniform_shots = max(min_shots, (long)ceil(uniform_scale / budget));
+        plan.uniform_qpu_seconds = uniform_shots * cost_sum;
+        return plan;
+    }
+};
@@ -0,0 +1,315 @@
+/*
+ * Shot Results - Bit-packed measurement outcomes and integer-keyed counts
+ * ShotResults stores raw shots as rows of uint64 words (qubit i is bit i % 64
+ * of word i / 64). CountTable is the histogram view: an open-addressing hash
+ * table from the outcome's integer value to its count, for up to 64 qubits.
+ * Bitstring text only appears at the edges (from_json / write_json), in the
+ * Qiskit convention where the rightmost character is qubit 0.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <memory_resource>
+#include <cmath>
+#include <cstdint>
+#include <charconv>
+#include <stdexcept>
+
+#include "json_scanner.h"
+#include "core/metrics.h"
+
+using namespace std;
+
+inline size_t shot_words(int num_qubits) { return (num_qubits + 63) / 64; }
+
+class CountTable {
+private:
+    pmr::vector<uint64_t> keys;
+    pmr::vector<double> values;
+    pmr::vector<uint8_t> used;
+    size_t entries = 0;
+    int num_qubits;
+
+    static uint64_t hash(uint64_t key) {
+        // splitmix64 finaliser
+        key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+        return key ^ (key >> 31);
+    }
+
+    size_t slot_of(uint64_t key) const {
+        size_t mask = keys.size() - 1;
+        size_t slot = hash(key) & mask;
+        while(used[slot] && keys[slot] != key) slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void rehash(size_t capacity) {
+        pmr::vector<uint64_t> old_keys = move(keys);
+        pmr::vector<double> old_values = move(values);
+        pmr::vector<uint8_t> old_used = move(used);
+        keys.assign(capacity, 0);
+        values.assign(capacity, 0.0);
+        used.assign(capacity, 0);
+        for(size_t i = 0; i < old_keys.size(); i++) {
+            if(!old_used[i]) continue;
+            size_t slot = slot_of(old_keys[i]);
+            keys[slot] = old_keys[i];
+            values[slot] = old_values[i];
+            used[slot] = 1;
+        }
+    }
+
+public:
+    CountTable(int qubits = 0, size_t expected = 16, pmr::memory_resource* memory = pmr::get_default_resource())
+        : keys(memory), values(memory), used(memory), num_qubits(qubits) {
+        if(qubits > 64) throw runtime_error("CountTable supports at most 64 qubits");
+        size_t capacity = 16;
+        while(capacity < expected * 2) capacity *= 2;
+        keys.assign(capacity, 0);
+        values.assign(capacity, 0.0);
+        used.assign(capacity, 0);
+    }
+
+    // Copy into another resource, e.g. a request arena. Plain copies use the
+    // default heap like any pmr container.
+    CountTable(const CountTable& other, pmr::memory_resource* memory)
+        : keys(other.keys, memory), values(other.values, memory), used(other.used, memory),
+          entries(other.entries), num_qubits(other.num_qubits) {}
+
+    CountTable(const CountTable&) = default;
+    CountTable(CountTable&&) = default;
+    CountTable& operator=(const CountTable&) = default;
+    CountTable& operator=(CountTable&&) = default;
+
+    pmr::memory_resource* resource() const { return keys.get_allocator().resource(); }
+
+    // Inserts a zero count for a new outcome
+    double& operator[](uint64_t key) {
+        if((entries + 1) * 2 > keys.size()) rehash(keys.size() * 2);  // Load factor <= 1/2
+        size_t slot = slot_of(key);
+        if(!used[slot]) {
+            used[slot] = 1;
+            keys[slot] = key;
+            values[slot] = 0.0;
+            entries++;
+        }
+        return values[slot];
+    }
+
+    void add(uint64_t key, double count) { (*this)[key] += count; }
+
+    double get(uint64_t key) const {
+        size_t slot = slot_of(key);
+        return used[slot] ? values[slot] : 0.0;
+    }
+
+    template<typename F>
+    void for_each(F&& visit) const {
+        for(size_t i = 0; i < keys.size(); i++) if(used[i]) visit(keys[i], values[i]);
+    }
+
+    size_t size() const { return entries; }
+    int get_num_qubits() const { return num_qubits; }
+
+    double total() const {
+        double sum = 0.0;
+        for_each([&](uint64_t, double count) { sum += count; });
+        return sum;
+    }
+
+    // Appends {"bits":count,...} without building intermediate strings
+    void write_json(string& out) const {
+        char number[32];
+        out += '{';
+        bool first = true;
+        for_each([&](uint64_t key, double count) {
+            if(!first) out += ',';
+            first = false;
+            out += '"';
+            size_t start = out.size();
+            out.resize(start + num_qubits);
+            for(int q = 0; q < num_qubits; q++) out[start + num_qubits - 1 - q] = '0' + ((key >> q) & 1);
+            out += "\":";
+            auto result = to_chars(number, number + sizeof(number), count);
+            out.append(number, result.ptr - number);
+        });
+        out += '}';
+    }
+
+    static uint64_t parse_bitstring(string_view bits) {
+        if(bits.size() > 64) throw runtime_error("Bitstring wider than 64 qubits");
+        uint64_t key = 0;
+        for(size_t i = 0; i < bits.size(); i++) {
+            char c = bits[bits.size() - 1 - i];
+            if(c == '1') key |= 1ULL << i;
+            else if(c != '0') throw runtime_error("Invalid bitstring: " + string(bits));
+        }
+        return key;
+    }
+
+    // Width is taken from the first key unless given
+    static CountTable from_json(string_view json, int qubits = -1,
+                                pmr::memory_resource* memory = pmr::get_default_resource()) {
+        CountTable table(0, 16, memory);
+        JsonScanner(json).scan_object([&](string_view bits, const JsonValue& value) {
+            if(table.num_qubits == 0) table.num_qubits = qubits >= 0 ? qubits : (int)bits.size();
+            if((int)bits.size() != table.num_qubits) throw runtime_error("Bitstring width mismatch: " + string(bits));
+            table.add(parse_bitstring(bits), value.number);
+        });
+        return table;
+    }
+
+    static CountTable from_map(const map<string, double>& counts, int qubits) {
+        CountTable table(qubits, counts.size());
+        for(const auto& entry : counts) {
+            if((int)entry.first.size() != qubits) throw runtime_error("Bitstring width mismatch: " + entry.first);
+            table.add(parse_bitstring(entry.first), entry.second);
+        }
+        return table;
+    }
+
+    map<string, double> to_map() const {
+        map<string, double> counts;
+        for_each([&](uint64_t key, double count) {
+            string bits(num_qubits, '0');
+            for(int q = 0; q < num_qubits; q++) if((key >> q) & 1) bits[num_qubits - 1 - q] = '1';
+            counts[bits] = count;
+        });
+        return counts;
+    }
+};
+
+class ShotResults {
+private:
+    int num_qubits;
+    size_t words;
+    pmr::vector<uint64_t> bits;
+
+public:
+    ShotResults(int qubits = 0, pmr::memory_resource* memory = pmr::get_default_resource())
+        : num_qubits(qubits), words(shot_words(qubits)), bits(memory) {}
+
+    pmr::memory_resource* resource() const { return bits.get_allocator().resource(); }
+
+    void reserve(size_t shots) { bits.reserve(shots * words); }
+
+    void add_shot(const uint64_t* shot) { bits.insert(bits.end(), shot, shot + words); }
+
+    void add_shot(uint64_t shot) {
+        if(words != 1) throw runtime_error("Single-word shots need 1-64 qubits");
+        bits.push_back(shot);
+    }
+
+    void add_bitstring(string_view bitstring) {
+        if((int)bitstring.size() != num_qubits) throw runtime_error("Bitstring width mismatch: " + string(bitstring));
+        size_t row = bits.size();
+        bits.resize(row + words, 0);
+        for(int q = 0; q < num_qubits; q++) {
+            if(bitstring[num_qubits - 1 - q] == '1') bits[row + q / 64] |= 1ULL << (q % 64);
+        }
+    }
+
+    size_t size() const { return words ? bits.size() / words : 0; }
+    int get_num_qubits() const { return num_qubits; }
+    size_t words_per_shot() const { return words; }
+    const uint64_t* shot(size_t i) const { return &bits[i * words]; }
+
+    CountTable counts() const {
+        CountTable table(num_qubits, 64, resource());
+        for(size_t i = 0; i < bits.size(); i++) table.add(bits[i], 1.0);
+        return table;
+    }
+
+    // Keeps the listed qubits; qubit qubits[i] becomes qubit i of the result
+    ShotResults marginal(const vector<int>& qubits) const {
+        ShotResults result(qubits.size(), resource());
+        size_t out_words = result.words;
+        result.bits.assign(size() * out_words, 0);
+        for(size_t s = 0; s < size(); s++) {
+            const uint64_t* row = shot(s);
+            uint64_t* dest = &result.bits[s * out_words];
+            for(size_t i = 0; i < qubits.size(); i++) {
+                int q = qubits[i];
+                dest[i / 64] |= ((row[q / 64] >> (q % 64)) & 1) << (i % 64);
+            }
+        }
+        return result;
+    }
+};
+
+inline CountTable marginal_counts(const CountTable& counts, const vector<int>& qubits) {
+    CountTable result(qubits.size(), 16, counts.resource());
+    counts.for_each([&](uint64_t key, double count) {
+        uint64_t reduced = 0;
+        for(size_t i = 0; i < qubits.size(); i++) reduced |= ((key >> qubits[i]) & 1) << i;
+        result.add(reduced, count);
+    });
+    return result;
+}
+
+// <Z...Z> over the masked qubits: each outcome contributes ±count by parity
+inline double parity_expectation(const CountTable& counts, uint64_t mask) {
+    double sum = 0.0, total = 0.0;
+    counts.for_each([&](uint64_t key, double count) {
+        sum += (__builtin_popcountll(key & mask) & 1) ? -count : count;
+        total += count;
+    });
+    return total > 0 ? sum / total : 0.0;
+}
+
+inline double parity_expectation(const ShotResults& shots, const uint64_t* mask) {
+    size_t words = shots.words_per_shot();
+    long odd = 0;
+    for(size_t s = 0; s < shots.size(); s++) {
+        const uint64_t* row = shots.shot(s);
+        uint64_t parity = 0;
+        for(size_t w = 0; w < words; w++) parity ^= row[w] & mask[w];
+        odd += __builtin_popcountll(parity) & 1;
+    }
+    return shots.size() ? 1.0 - 2.0 * odd / shots.size() : 0.0;
+}
+
+// Tensored readout correction: applies each qubit's inverse confusion matrix
+// in turn. p01[q] = P(read 1 | prepared 0), p10[q] = P(read 0 | prepared 1).
+// Entries below prune * total are dropped to bound the support; negative
+// quasi-counts are clipped and the total is preserved.
+inline CountTable mitigate_readout(const CountTable& counts, const vector<double>& p01,
+                                   const vector<double>& p10, double prune = 1e-6) {
+    PLANCK_TIME_STAGE(MITIGATE);
+    int n = counts.get_num_qubits();
+    if((int)p01.size() != n || (int)p10.size() != n) throw runtime_error("Readout error rates do not match qubit count");
+    double total = counts.total();
+    double threshold = prune * total;
+
+    // Intermediates and the result share the input's memory resource
+    CountTable current(counts, counts.resource());
+    for(int q = 0; q < n; q++) {
+        double det = 1.0 - p01[q] - p10[q];
+        if(fabs(det) < 1e-9) throw runtime_error("Readout confusion matrix is singular");
+        // Column b of the inverse: where a reading of b came from
+        double inv[2][2] = {{(1.0 - p10[q]) / det, -p10[q] / det},
+                            {-p01[q] / det, (1.0 - p01[q]) / det}};
+        CountTable next(n, current.size() * 2, counts.resource());
+        uint64_t bit = 1ULL << q;
+        current.for_each([&](uint64_t key, double count) {
+            int read = (key >> q) & 1;
+            double to_zero = inv[0][read] * count, to_one = inv[1][read] * count;
+            if(fabs(to_zero) >= threshold) next.add(key & ~bit, to_zero);
+            if(fabs(to_one) >= threshold) next.add(key | bit, to_one);
+        });
+        current = move(next);
+    }
+
+    double positive = 0.0;
+    current.for_each([&](uint64_t, double count) { if(count > 0) positive += count; });
+    CountTable result(n, current.size(), counts.resource());
+    current.for_each([&](uint64_t key, double count) {
+        if(count > 0 && positive > 0) result.add(key, count * total / positive);
+    });
+    return result;
+}
@@ -0,0 +1,146 @@
+/*
+ * Statevector Simulator - Exact local execution of small circuits
+ * Amplitudes are indexed with qubit q on bit q (Qiskit order), so the
+ * probability vector lines up with ShotResults bitstrings. Gates come from
+ * unitary.h, with cx/cz/swap/cp/ccx applied directly as permutations and
+ * phases; measure and barrier are skipped since every qubit is read out at
+ * the end. project() applies an unnormalised Z projector, which is how
+ * circuit cutting evaluates its signed mid-circuit measurements.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+#include "unitary.h"
+
+using namespace std;
+
+class StatevectorSimulator {
+private:
+    int num_qubits;
+    vector<Complex> amplitudes;
+
+public:
+    static constexpr int MAX_QUBITS = 28;
+
+    explicit StatevectorSimulator(int qubits) : num_qubits(qubits) {
+        if(qubits < 0 || qubits > MAX_QUBITS) {
+            throw runtime_error("Statevector simulation supports at most " + to_string(MAX_QUBITS) + " qubits");
+        }
+        reset();
+    }
+
+    void reset() {
+        amplitudes.assign(size_t(1) << num_qubits, 0.0);
+        amplitudes[0] = 1.0;
+    }
+
+    void apply(const Matrix2& m, int q) {
+        size_t bit = size_t(1) << q, size = amplitudes.size();
+        for(size_t block = 0; block < size; block += 2 * bit) {
+            for(size_t i = block; i < block + bit; i++) {
+                Complex a0 = amplitudes[i], a1 = amplitudes[i | bit];
+                amplitudes[i] = m[0] * a0 + m[1] * a1;
+                amplitudes[i | bit] = m[2] * a0 + m[3] * a1;
+            }
+        }
+    }
+
+    // m acts on (first, second) with basis index 2 * first + second
+    void apply(const Matrix4& m, int first, int second) {
+        size_t bf = size_t(1) << first, bs = size_t(1) << second;
+        size_t lo = min(bf, bs), hi = max(bf, bs), groups = amplitudes.size() / 4;
+        for(size_t k = 0; k < groups; k++) {
+            // k with zero bits inserted at both target positions
+            size_t i = (k & (lo - 1)) | ((k & ~(lo - 1)) << 1);
+            i = (i & (hi - 1)) | ((i & ~(hi - 1)) << 1);
+            size_t index[4] = {i, i | bs, i | bf, i | bf | bs};
+            Complex a[4] = {amplitudes[index[0]], amplitudes[index[1]], amplitudes[index[2]], amplitudes[index[3]]};
+            for(int r = 0; r < 4; r++) {
+                amplitudes[index[r]] = m[r * 4] * a[0] + m[r * 4 + 1] * a[1] + m[r * 4 + 2] * a[2] + m[r * 4 + 3] * a[3];
+            }
+        }
+    }
+
+    // Permutation and phase gates touch only the amplitudes they change
+    void apply_cx(int control, int target) {
+        size_t bc = size_t(1) << control, bt = size_t(1) << target;
+        for(size_t i = 0; i < amplitudes.size(); i++) {
+            if((i & bc) && !(i & bt)) swap(amplitudes[i], amplitudes[i | bt]);
+        }
+    }
+
+    void apply_cz(int a, int b) {
+        size_t mask = (size_t(1) << a) | (size_t(1) << b);
+        for(size_t i = 0; i < amplitudes.size(); i++) {
+            if((i & mask) == mask) amplitudes[i] = -amplitudes[i];
+        }
+    }
+
+    void apply_swap(int a, int b) {
+        size_t ba = size_t(1) << a, bb = size_t(1) << b;
+        for(size_t i = 0; i < amplitudes.size(); i++) {
+            if((i & ba) && !(i & bb)) swap(amplitudes[i], amplitudes[(i & ~ba) | bb]);
+        }
+    }
+
+    void apply_cp(int a, int b, double lambda) {
+        size_t mask = (size_t(1) << a) | (size_t(1) << b);
+        Complex phase = polar(1.0, lambda);
+        for(size_t i = 0; i < amplitudes.size(); i++) {
+            if((i & mask) == mask) amplitudes[i] *= phase;
+        }
+    }
+
+    void apply_ccx(int c1, int c2, int target) {
+        size_t controls = (size_t(1) << c1) | (size_t(1) << c2), bt = size_t(1) << target;
+        for(size_t i = 0; i < amplitudes.size(); i++) {
+            if((i & controls) == controls && !(i & bt)) swap(amplitudes[i], amplitudes[i | bt]);
+        }
+    }
+
+    // Keeps the amplitudes where qubit q reads outcome (no renormalisation)
+    void project(int q, int outcome) {
+        size_t bit = size_t(1) << q;
+        for(size_t i = 0; i < amplitudes.size(); i++) {
+            if(((i & bit) != 0) != (outcome != 0)) amplitudes[i] = 0.0;
+        }
+    }
+
+    void apply(const Gate& gate) {
+        if(gate.type == "measure" || gate.type == "barrier") return;
+        for(int q : gate.qubits) {
+            if(q < 0 || q >= num_qubits) throw runtime_error("Gate " + string(gate.type) + " on qubit outside the register");
+        }
+        Matrix2 m2;
+        Matrix4 m4;
+        if(gate.type == "cx" && gate.qubits.size() == 2) apply_cx(gate.qubits[0], gate.qubits[1]);
+        else if(gate.type == "cz" && gate.qubits.size() == 2) apply_cz(gate.qubits[0], gate.qubits[1]);
+        else if(gate.type == "swap" && gate.qubits.size() == 2) apply_swap(gate.qubits[0], gate.qubits[1]);
+        else if((gate.type == "cp" || gate.type == "cu1") && gate.qubits.size() == 2) {
+            apply_cp(gate.qubits[0], gate.qubits[1], gate_angle(gate, 0, "lambda"));
+        } else if(gate.type == "ccx" && gate.qubits.size() == 3) apply_ccx(gate.qubits[0], gate.qubits[1], gate.qubits[2]);
+        else if(single_qubit_unitary(gate, m2)) apply(m2, gate.qubits[0]);
+        else if(two_qubit_unitary(gate, m4)) apply(m4, gate.qubits[0], gate.qubits[1]);
+        else throw runtime_error("Simulator does not support gate " + string(gate.type));
+    }
+
+    template<typename Gates>
+    void run(const Gates& gates) {
+        for(const auto& gate : gates) apply(gate);
+    }
+
+    // Squared norms; sum to 1 unless a projection was applied
+    vector<double> probabilities() const {
+        vector<double> p(amplitudes.size());
+        for(size_t i = 0; i < amplitudes.size(); i++) p[i] = norm(amplitudes[i]);
+        return p;
+    }
+
+    int get_num_qubits() const { return num_qubits; }
+    const vector<Complex>& get_amplitudes() const { return amplitudes; }
+};
@@ -0,0 +1,550 @@
+/*
+ * Transpile Cache - Content-addressed store of routed circuits
+ * Tenants submit the same template circuits (bell, grover, qaoa, ...) to the
+ * same devices over and over; a repeat submission should cost a lookup, not
+ * a routing pass. Entries are keyed by a canonical encoding of everything
+ * routing depends on: the gate list with parameter values, the logical
+ * width, the topology's structural hash (coupling map and disabled qubits,
+ * so a calibration change is a different key), caller options and the
+ * router version. compile() entries also hold the circuit after the
+ * caller's later passes (resynthesis, DAG optimisation), so a hit skips
+ * those as well. An FNV-1a hash of those fields addresses the entry and
+ * the input is compared against the full key on every hit, so hash
+ * collisions cost a miss, never a wrong circuit.
+ *
+ * Two tiers: an in-process LRU of decoded circuits and an optional on-disk
+ * table mmap'd MAP_SHARED, so every process on the host (CLI runs, workers)
+ * reuses the others' results. Disk layout (native endian):
+ *
+ *   DiskHeader                      magic "PTCC", slot count, data cursor
+ *   DiskSlot[slot_count]            { hash, entry offset }, open addressing
+ *   entries                         { EntryHeader, key, value } padded to 8
+ *
+ * Writers serialise on a mutex within the process and on flock() across
+ * processes, and publish a slot by storing its hash last; readers take no
+ * lock and check the entry's checksum after copying it out.
+ * When the table fills up, the next writer clears it (epoch eviction), which
+ * a concurrent reader sees as a failed checksum, i.e. a miss.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "quantum_transpiler.h"
+
+using namespace std;
+
+// Bump whenever routing, or any pass cached through compile(), changes its
+// output for the same input
+const uint32_t TRANSPILE_ROUTER_VERSION = 2;
+
+const char TRANSPILE_CACHE_MAGIC[4] = {'P', 'T', 'C', 'C'};
+const uint32_t TRANSPILE_CACHE_VERSION = 2;
+
+class TranspileCache {
+private:
+    struct Entry {
+        uint64_t hash;
+        string key;                 // canonical_key() of the input
+        // Gates bump-allocate from the entry's own buffer and are freed with it
+        unique_ptr<pmr::monotonic_buffer_resource> memory;
+        pmr::vector<Gate> gates;
+        vector<int> source;
+        pmr::vector<Gate> compiled;  // compile() entries only
+
+        Entry(uint64_t h, size_t bytes_hint)
+            : hash(h), memory(make_unique<pmr::monotonic_buffer_resource>(max<size_t>(bytes_hint, 1024))),
+              gates(memory.get()), compiled(memory.get()) {}
+    };
+
+    struct DiskHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t slot_count;
+        uint64_t file_bytes;
+        atomic<uint64_t> data_end;  // Next free byte of the entry region
+        atomic<uint64_t> entries;
+    };
+
+    struct DiskSlot {
+        atomic<uint64_t> hash;      // 0 = empty; stored last when publishing
+        atomic<uint64_t> offset;
+    };
+
+    struct EntryHeader {
+        uint64_t hash;
+        uint32_t key_bytes;
+        uint32_t value_bytes;
+        uint64_t checksum;          // checksum() over key and value
+    };
+
+    static_assert(atomic<uint64_t>::is_always_lock_free, "Shared table needs address-free atomics");
+
+    // Memory tier: most recent first
+    list<Entry> lru;
+    unordered_map<uint64_t, list<Entry>::iterator> index;
+    size_t capacity;
+    mutex lock;
+
+    // Disk tier. flock() locks belong to the open file, so it only keeps
+    // other processes out; threads of this one serialise on disk_lock.
+    mutex disk_lock;
+    int fd = -1;
+    uint8_t* disk = nullptr;
+    size_t disk_size = 0;
+
+    atomic<size_t> memory_hits{0}, disk_hits{0}, misses{0};
+
+    static void mix(uint64_t& hash, uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    }
+
+    // FNV-1a a word at a time; detects torn or recycled entries
+    static uint64_t checksum(const uint8_t* bytes, size_t len, uint64_t hash = 14695981039346656037ULL) {
+        size_t i = 0;
+        for(; i + 8 <= len; i += 8) {
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            mix(hash, word);
+        }
+        for(; i < len; i++) mix(hash, bytes[i]);
+        return hash;
+    }
+
+    static uint64_t double_bits(double value) {
+        if(value == 0.0) value = 0.0;  // -0 and +0 route alike
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    // Key encoding goes through a sink: KeyWriter appends the bytes,
+    // KeyMatcher compares them against a stored key without building them
+    struct KeyWriter {
+        string& out;
+        template<typename T>
+        void value(T v) { out.append((const char*)&v, sizeof(T)); }
+        void bytes(const char* data, size_t len) { out.append(data, len); }
+        bool good() const { return true; }
+    };
+
+    struct KeyMatcher {
+        const char* in;
+        const char* end;
+        bool ok = true;
+        template<typename T>
+        void value(T v) { bytes((const char*)&v, sizeof(T)); }
+        void bytes(const char* data, size_t len) {
+            ok = ok && (size_t)(end - in) >= len && memcmp(in, data, len) == 0;
+            if(ok) in += len;
+        }
+        bool good() const { return ok; }
+    };
+
+    template<typename Sink, typename Gates>
+    static void encode_gates(Sink& sink, const Gates& gates) {
+        sink.value((uint64_t)gates.size());
+        for(const Gate& gate : gates) {
+            if(!sink.good()) return;
+            sink.value((uint32_t)gate.type.size());
+            sink.bytes(gate.type.data(), gate.type.size());
+            sink.value((uint32_t)gate.qubits.size());
+            for(int q : gate.qubits) sink.value((int32_t)q);
+            // Map order is sorted by name, so this is canonical
+            sink.value((uint32_t)gate.parameters.size());
+            for(const auto& param : gate.parameters) {
+                sink.value((uint32_t)param.first.size());
+                sink.bytes(param.first.data(), param.first.size());
+                sink.value(double_bits(param.second));
+            }
+        }
+    }
+
+    template<typename Sink, typename Gates>
+    static void encode_key(Sink& sink, const Gates& gates, int num_logical_qubits,
+                           uint64_t topology_hash, uint64_t options_hash, bool compiled) {
+        sink.value(TRANSPILE_ROUTER_VERSION);
+        sink.value(topology_hash);
+        sink.value(options_hash);
+        sink.value((uint8_t)compiled);
+        sink.value((int32_t)num_logical_qubits);
+        encode_gates(sink, gates);
+    }
+
+    static void encode_value(string& out, const pmr::vector<Gate>& gates, const pmr::vector<int>& source,
+                             const pmr::vector<Gate>& compiled) {
+        KeyWriter writer{out};
+        encode_gates(writer, gates);
+        out.append((const char*)source.data(), source.size() * sizeof(int32_t));
+        encode_gates(writer, compiled);
+    }
+
+    template<typename T>
+    static T take(const uint8_t*& in, const uint8_t* end) {
+        if(in + sizeof(T) > end) throw runtime_error("Truncated transpile cache entry");
+        T value;
+        memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+
+    static string_view take_string(const uint8_t*& in, const uint8_t* end) {
+        uint32_t len = take<uint32_t>(in, end);
+        if(in + len > end) throw runtime_error("Truncated transpile cache entry");
+        string_view text((const char*)in, len);
+        in += len;
+        return text;
+    }
+
+    static void decode_gates(const uint8_t*& in, const uint8_t* end, pmr::vector<Gate>& gates) {
+        uint64_t count = take<uint64_t>(in, end);
+        if(count > (uint64_t)(end - in)) throw runtime_error("Truncated transpile cache entry");
+        gates.clear();
+        gates.reserve(count);
+        for(uint64_t g = 0; g < count; g++) {
+            Gate& gate = gates.emplace_back();
+            gate.type = take_string(in, end);
+            uint32_t qubits = take<uint32_t>(in, end);
+            if(qubits > (uint64_t)(end - in) / sizeof(int32_t)) throw runtime_error("Truncated transpile cache entry");
+            gate.qubits.resize(qubits);
+            memcpy(gate.qubits.data(), in, qubits * sizeof(int32_t));
+            in += qubits * sizeof(int32_t);
+            uint32_t params = take<uint32_t>(in, end);
+            for(uint32_t p = 0; p < params; p++) {
+                string_view name = take_string(in, end);
+                uint64_t bits = take<uint64_t>(in, end);
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                gate.parameters.emplace_hint(gate.parameters.end(), name, value);
+            }
+        }
+    }
+
+    static void decode_value(const uint8_t* in, const uint8_t* end, Entry& entry) {
+        decode_gates(in, end, entry.gates);
+        entry.source.resize(entry.gates.size());
+        for(int& s : entry.source) s = take<int32_t>(in, end);
+        decode_gates(in, end, entry.compiled);
+    }
+
+    DiskHeader* header() const { return (DiskHeader*)disk; }
+    DiskSlot* slots() const { return (DiskSlot*)(disk + sizeof(DiskHeader)); }
+    size_t data_begin() const { return sizeof(DiskHeader) + header()->slot_count * sizeof(DiskSlot); }
+
+    static uint64_t slot_hash(uint64_t hash) { return hash ? hash : 1; }
+
+    // Lock-free read of the disk tier; any inconsistency is a miss
+    bool disk_find(uint64_t hash, const string& key, Entry& entry) const {
+        if(!disk) return false;
+        uint64_t wanted = slot_hash(hash), count = header()->slot_count;
+        for(uint64_t probe = 0; probe < count; probe++) {
+            DiskSlot& slot = slots()[(hash + probe) % count];
+            uint64_t stored = slot.hash.load(memory_order_acquire);
+            if(stored == 0) return false;
+            if(stored != wanted) continue;
+
+            uint64_t offset = slot.offset.load(memory_order_relaxed);
+            if(offset < data_begin() || offset + sizeof(EntryHeader) > disk_size) return false;
+            EntryHeader eh;
+            memcpy(&eh, disk + offset, sizeof(eh));
+            const uint8_t* key_start = disk + offset + sizeof(EntryHeader);
+            if(eh.hash != hash || eh.key_bytes != key.size() ||
+               offset + sizeof(EntryHeader) + (uint64_t)eh.key_bytes + eh.value_bytes > disk_size) continue;
+            if(memcmp(key_start, key.data(), key.size()) != 0) continue;
+
+            // Copied out and checked before decoding: a writer recycling the
+            // region meanwhile changes the checksum of the copy
+            thread_local vector<uint8_t> copy;
+            copy.assign(key_start, key_start + eh.key_bytes + eh.value_bytes);
+            if(checksum(copy.data() + eh.key_bytes, eh.value_bytes, checksum(copy.data(), eh.key_bytes)) != eh.checksum ||
+               memcmp(copy.data(), key.data(), key.size()) != 0) return false;
+            try {
+                decode_value(copy.data() + eh.key_bytes, copy.data() + copy.size(), entry);
+            } catch(const runtime_error&) {
+                return false;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void disk_clear() {
+        DiskSlot* table = slots();
+        for(uint64_t i = 0; i < header()->slot_count; i++) table[i].hash.store(0, memory_order_relaxed);
+        header()->entries.store(0, memory_order_relaxed);
+        header()->data_end.store(data_begin(), memory_order_release);
+    }
+
+    void disk_insert(uint64_t hash, const string& key, const string& value) {
+        if(!disk) return;
+        size_t bytes = (sizeof(EntryHeader) + key.size() + value.size() + 7) & ~size_t(7);
+        if(data_begin() + bytes > disk_size) return;  // Could never fit
+
+        lock_guard<mutex> guard(disk_lock);
+        flock(fd, LOCK_EX);
+        uint64_t count = header()->slot_count;
+        if(header()->entries.load() * 4 >= count * 3 || header()->data_end.load() + bytes > disk_size) disk_clear();
+
+        uint64_t wanted = slot_hash(hash);
+        DiskSlot* slot = nullptr;
+        for(uint64_t probe = 0; probe < count; probe++) {
+            DiskSlot& candidate = slots()[(hash + probe) % count];
+            uint64_t stored = candidate.hash.load(memory_order_relaxed);
+            if(stored == 0) {
+                slot = &candidate;
+                break;
+            }
+            if(stored == wanted) {
+                // Another process may have stored it since our lookup
+                const uint8_t* other = disk + candidate.offset.load(memory_order_relaxed);
+                EntryHeader eh;
+                memcpy(&eh, other, sizeof(eh));
+                if(eh.key_bytes == key.size() && memcmp(other + sizeof(EntryHeader), key.data(), key.size()) == 0) {
+                    flock(fd, LOCK_UN);
+                    return;
+                }
+            }
+        }
+
+        if(slot) {
+            uint64_t offset = header()->data_end.load();
+            EntryHeader eh{hash, (uint32_t)key.size(), (uint32_t)value.size(), 0};
+            eh.checksum = checksum((const uint8_t*)value.data(), value.size(), checksum((const uint8_t*)key.data(), key.size()));
+            memcpy(disk + offset, &eh, sizeof(eh));
+            memcpy(disk + offset + sizeof(eh), key.data(), key.size());
+            memcpy(disk + offset + sizeof(eh) + key.size(), value.data(), value.size());
+            header()->data_end.store(offset + bytes);
+            header()->entries.fetch_add(1);
+            slot->offset.store(offset, memory_order_relaxed);
+            slot->hash.store(wanted, memory_order_release);
+        }
+        flock(fd, LOCK_UN);
+    }
+
+    // Memory tier; caller holds lock. Moves the hit to the front.
+    template<typename GateAllocator>
+    const Entry* memory_find(uint64_t hash, const vector<Gate, GateAllocator>& gates, int num_logical_qubits,
+                             uint64_t topology_hash, uint64_t options_hash, bool compiled) {
+        auto it = index.find(hash);
+        if(it == index.end()) return nullptr;
+        const string& key = it->second->key;
+        KeyMatcher matcher{key.data(), key.data() + key.size()};
+        encode_key(matcher, gates, num_logical_qubits, topology_hash, options_hash, compiled);
+        if(!matcher.good() || matcher.in != matcher.end) return nullptr;
+        lru.splice(lru.begin(), lru, it->second);
+        return &lru.front();
+    }
+
+    const Entry& memory_insert(Entry&& entry) {
+        auto it = index.find(entry.hash);
+        if(it != index.end()) {
+            lru.erase(it->second);
+            index.erase(it);
+        }
+        lru.push_front(move(entry));
+        index[lru.front().hash] = lru.begin();
+        while(lru.size() > capacity) {
+            index.erase(lru.back().hash);
+            lru.pop_back();
+        }
+        return lru.front();
+    }
+
+    // Shared by transpile() and compile(); compiled is null for transpile()
+    template<typename GateAllocator, typename CompileRouted>
+    const pmr::vector<Gate>& lookup(QuantumTranspiler& transpiler, const QPUTopology& topology,
+                                    const vector<Gate, GateAllocator>& logical_gates, int num_logical_qubits,
+                                    uint64_t options_hash, pmr::vector<Gate>* compiled,
+                                    CompileRouted&& compile_routed, bool* hit) {
+        uint64_t topology_hash = topology.structural_hash();
+        bool stage = compiled != nullptr;
+        uint64_t hash = content_hash(logical_gates, num_logical_qubits, topology_hash, options_hash, stage);
+        if(hit) *hit = true;
+
+        {
+            lock_guard<mutex> guard(lock);
+            if(const Entry* entry = memory_find(hash, logical_gates, num_logical_qubits, topology_hash, options_hash, stage)) {
+                memory_hits++;
+                if(compiled) compiled->assign(entry->compiled.begin(), entry->compiled.end());
+                return transpiler.set_routing(entry->gates, entry->source);
+            }
+        }
+
+        Entry entry(hash, logical_gates.size() * 2 * sizeof(Gate));
+        entry.key = canonical_key(logical_gates, num_logical_qubits, topology_hash, options_hash, stage);
+        if(disk_find(hash, entry.key, entry)) {
+            disk_hits++;
+            lock_guard<mutex> guard(lock);
+            const Entry& stored = memory_insert(move(entry));
+            if(compiled) compiled->assign(stored.compiled.begin(), stored.compiled.end());
+            return transpiler.set_routing(stored.gates, stored.source);
+        }
+
+        misses++;
+        if(hit) *hit = false;
+        const pmr::vector<Gate>& routed = transpiler.transpile(logical_gates, num_logical_qubits);
+        const pmr::vector<int>& source = transpiler.get_source_gates();
+        if(compiled) {
+            *compiled = compile_routed(routed);
+            entry.compiled.assign(compiled->begin(), compiled->end());
+        }
+        if(disk) {
+            string value;
+            encode_value(value, routed, source, entry.compiled);
+            disk_insert(hash, entry.key, value);
+        }
+        entry.gates.assign(routed.begin(), routed.end());
+        entry.source.assign(source.begin(), source.end());
+        lock_guard<mutex> guard(lock);
+        memory_insert(move(entry));
+        return routed;
+    }
+
+public:
+    // memory_entries circuits stay decoded in process. With a disk_path the
+    // table file is created with disk_bytes (or opened at its existing size)
+    // and shared with every other process that opens it.
+    TranspileCache(size_t memory_entries = 1024, const string& disk_path = "", size_t disk_bytes = 64 << 20)
+        : capacity(max<size_t>(1, memory_entries)) {
+        if(disk_path.empty()) return;
+        fd = open(disk_path.c_str(), O_RDWR | O_CREAT, 0644);
+        if(fd < 0) throw runtime_error("Cannot open transpile cache: " + disk_path);
+
+        flock(fd, LOCK_EX);
+        struct stat st;
+        fstat(fd, &st);
+        bool fresh = st.st_size == 0;
+        uint64_t slot_count = max<uint64_t>(64, disk_bytes / 4096);
+        if(fresh) {
+            disk_bytes = max(disk_bytes, sizeof(DiskHeader) + slot_count * sizeof(DiskSlot) + 4096);
+            if(ftruncate(fd, disk_bytes) != 0) {
+                flock(fd, LOCK_UN);
+                close(fd);
+                throw runtime_error("Cannot size transpile cache: " + disk_path);
+            }
+            disk_size = disk_bytes;
+        } else {
+            disk_size = st.st_size;
+        }
+
+        void* mapped = disk_size >= sizeof(DiskHeader) ? mmap(nullptr, disk_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        if(mapped == MAP_FAILED) {
+            flock(fd, LOCK_UN);
+            close(fd);
+            throw runtime_error("Cannot mmap transpile cache: " + disk_path);
+        }
+        disk = (uint8_t*)mapped;
+
+        if(fresh) {
+            memcpy(header()->magic, TRANSPILE_CACHE_MAGIC, 4);
+            header()->version = TRANSPILE_CACHE_VERSION;
+            header()->slot_count = slot_count;
+            header()->file_bytes = disk_size;
+            disk_clear();
+        } else if(memcmp(header()->magic, TRANSPILE_CACHE_MAGIC, 4) != 0 || header()->version != TRANSPILE_CACHE_VERSION ||
+                  header()->file_bytes != disk_size || data_begin() > disk_size) {
+            munmap(mapped, disk_size);
+            disk = nullptr;
+            flock(fd, LOCK_UN);
+            close(fd);
+            throw runtime_error("Unsupported transpile cache format: " + disk_path);
+        }
+        flock(fd, LOCK_UN);
+    }
+
+    ~TranspileCache() {
+        if(disk) munmap(disk, disk_size);
+        if(fd >= 0) close(fd);
+    }
+
+    TranspileCache(const TranspileCache&) = delete;
+    TranspileCache& operator=(const TranspileCache&) = delete;
+
+    // Canonical bytes of one routing problem
+    template<typename GateAllocator>
+    static string canonical_key(const vector<Gate, GateAllocator>& gates, int num_logical_qubits,
+                                uint64_t topology_hash, uint64_t options_hash, bool compiled = false) {
+        string key;
+        KeyWriter writer{key};
+        encode_key(writer, gates, num_logical_qubits, topology_hash, options_hash, compiled);
+        return key;
+    }
+
+    // FNV-1a over the same fields as canonical_key, a word at a time, so
+    // memory hits never build the key (they match it in place)
+    template<typename GateAllocator>
+    static uint64_t content_hash(const vector<Gate, GateAllocator>& gates, int num_logical_qubits,
+                                 uint64_t topology_hash, uint64_t options_hash, bool compiled = false) {
+        uint64_t hash = 14695981039346656037ULL;
+        mix(hash, TRANSPILE_ROUTER_VERSION);
+        mix(hash, topology_hash);
+        mix(hash, options_hash);
+        mix(hash, compiled);
+        mix(hash, num_logical_qubits);
+        for(const Gate& gate : gates) {
+            for(char c : gate.type) mix(hash, (unsigned char)c);
+            mix(hash, gate.qubits.size());
+            for(int q : gate.qubits) mix(hash, q);
+            for(const auto& param : gate.parameters) {
+                for(char c : param.first) mix(hash, (unsigned char)c);
+                mix(hash, double_bits(param.second));
+            }
+        }
+        return hash;
+    }
+
+    // Routed circuit for logical_gates on topology, loaded into transpiler
+    // (so get_source_gates() and get_swap_count() describe it) and valid
+    // until its next call. Routing only runs when neither tier has it;
+    // options_hash covers anything else the caller's result depends on.
+    template<typename GateAllocator>
+    const pmr::vector<Gate>& transpile(QuantumTranspiler& transpiler, const QPUTopology& topology,
+                                       const vector<Gate, GateAllocator>& logical_gates, int num_logical_qubits,
+                                       uint64_t options_hash = 0, bool* hit = nullptr) {
+        return lookup(transpiler, topology, logical_gates, num_logical_qubits, options_hash, nullptr,
+                      [](const pmr::vector<Gate>&) { return pmr::vector<Gate>(); }, hit);
+    }
+
+    // As transpile(), and compiled receives compile_routed(routed): the
+    // circuit after every pass the caller runs past routing. A hit runs
+    // neither routing nor compile_routed, so options_hash must cover every
+    // setting compile_routed depends on.
+    template<typename GateAllocator, typename CompileRouted>
+    const pmr::vector<Gate>& compile(QuantumTranspiler& transpiler, const QPUTopology& topology,
+                                     const vector<Gate, GateAllocator>& logical_gates, int num_logical_qubits,
+                                     pmr::vector<Gate>& compiled, CompileRouted&& compile_routed,
+                                     uint64_t options_hash = 0, bool* hit = nullptr) {
+        return lookup(transpiler, topology, logical_gates, num_logical_qubits, options_hash, &compiled,
+                      compile_routed, hit);
+    }
+
+    size_t get_memory_hits() const { return memory_hits; }
+    size_t get_disk_hits() const { return disk_hits; }
+    size_t get_misses() const { return misses; }
+    size_t size() const { return lru.size(); }
+    size_t disk_entries() const { return disk ? (size_t)header()->entries.load() : 0; }
+
+    void clear() {
+        lock_guard<mutex> guard(lock);
+        lru.clear();
+        index.clear();
+    }
+};
@@ -0,0 +1,175 @@
+/*
+ * Unitary - Dense matrices for one- and two-qubit gates
+ * Row-major 2x2 and 4x4 complex matrices with the qelib1 gate definitions.
+ * A two-qubit matrix acts on (first, second) qubit with basis index
+ * 2 * first + second, so kron(A, B) applies A to the first qubit.
+ */
+
+#pragma once
+
+#include <array>
+#include <complex>
+#include <cmath>
+#include <string_view>
+
+#include "quantum_transpiler.h"
+
+using namespace std;
+
+using Complex = complex<double>;
+using Matrix2 = array<Complex, 4>;
+using Matrix4 = array<Complex, 16>;
+
+inline Matrix2 identity2() { return {1.0, 0.0, 0.0, 1.0}; }
+
+inline Matrix4 identity4() {
+    Matrix4 m{};
+    for(int i = 0; i < 4; i++) m[i * 5] = 1.0;
+    return m;
+}
+
+inline Matrix2 multiply(const Matrix2& a, const Matrix2& b) {
+    return {a[0] * b[0] + a[1] * b[2], a[0] * b[1] + a[1] * b[3],
+            a[2] * b[0] + a[3] * b[2], a[2] * b[1] + a[3] * b[3]};
+}
+
+inline Matrix4 multiply(const Matrix4& a, const Matrix4& b) {
+    Matrix4 m{};
+    for(int i = 0; i < 4; i++) {
+        for(int k = 0; k < 4; k++) {
+            Complex aik = a[i * 4 + k];
+            if(aik == 0.0) continue;
+            for(int j = 0; j < 4; j++) m[i * 4 + j] += aik * b[k * 4 + j];
+        }
+    }
+    return m;
+}
+
+inline Matrix2 adjoint(const Matrix2& a) { return {conj(a[0]), conj(a[2]), conj(a[1]), conj(a[3])}; }
+
+inline Matrix4 adjoint(const Matrix4& a) {
+    Matrix4 m;
+    for(int i = 0; i < 4; i++) for(int j = 0; j < 4; j++) m[i * 4 + j] = conj(a[j * 4 + i]);
+    return m;
+}
+
+inline Matrix4 kron(const Matrix2& a, const Matrix2& b) {
+    Matrix4 m;
+    for(int i = 0; i < 2; i++)
+        for(int j = 0; j < 2; j++)
+            for(int k = 0; k < 2; k++)
+                for(int l = 0; l < 2; l++) m[(2 * i + k) * 4 + 2 * j + l] = a[i * 2 + j] * b[k * 2 + l];
+    return m;
+}
+
+// qelib1 u3: Rz(phi) Ry(theta) Rz(lambda) up to global phase
+inline Matrix2 u3_matrix(double theta, double phi, double lambda) {
+    double c = cos(theta / 2), s = sin(theta / 2);
+    return {c, -polar(s, lambda), polar(s, phi), polar(c, phi + lambda)};
+}
+
+inline Matrix2 rx_matrix(double theta) {
+    double c = cos(theta / 2), s = sin(theta / 2);
+    return {c, Complex(0, -s), Complex(0, -s), c};
+}
+
+inline Matrix2 ry_matrix(double theta) {
+    double c = cos(theta / 2), s = sin(theta / 2);
+    return {c, -s, s, c};
+}
+
+inline Matrix2 rz_matrix(double theta) { return {polar(1.0, -theta / 2), 0.0, 0.0, polar(1.0, theta / 2)}; }
+
+// Angle index of a gate: QASM gates carry "p0", "p1", ...; gates built in
+// code use names ("theta", "phi", "lambda"); a lone parameter is unambiguous
+inline double gate_angle(const Gate& gate, int index, const char* name) {
+    const char positional[3] = {'p', char('0' + index), 0};
+    auto it = gate.parameters.find(string_view(positional));
+    if(it == gate.parameters.end()) it = gate.parameters.find(string_view(name));
+    if(it != gate.parameters.end()) return it->second;
+    if(index == 0 && gate.parameters.size() == 1) return gate.parameters.begin()->second;
+    return 0.0;
+}
+
+// Rotation angle of rx/ry/rz/p/u1 (equal to an axis rotation up to phase);
+// false for any other gate
+inline bool rotation_angle(const Gate& gate, double& theta) {
+    const auto& t = gate.type;
+    if(gate.qubits.size() != 1) return false;
+    if(t == "rx" || t == "ry" || t == "rz") theta = gate_angle(gate, 0, "theta");
+    else if(t == "p" || t == "u1") theta = gate_angle(gate, 0, "lambda");
+    else return false;
+    return true;
+}
+
+// False for gates that are not single-qubit unitaries (measure, reset, ...)
+inline bool single_qubit_unitary(const Gate& gate, Matrix2& m) {
+    if(gate.qubits.size() != 1) return false;
+    const double r = 1 / sqrt(2.0);
+    const auto& t = gate.type;
+    if(t == "id") m = identity2();
+    else if(t == "x") m = {0.0, 1.0, 1.0, 0.0};
+    else if(t == "y") m = {0.0, Complex(0, -1), Complex(0, 1), 0.0};
+    else if(t == "z") m = {1.0, 0.0, 0.0, -1.0};
+    else if(t == "h") m = {r, r, r, -r};
+    else if(t == "s") m = {1.0, 0.0, 0.0, Complex(0, 1)};
+    else if(t == "sdg") m = {1.0, 0.0, 0.0, Complex(0, -1)};
+    else if(t == "t") m = {1.0, 0.0, 0.0, polar(1.0, M_PI / 4)};
+    else if(t == "tdg") m = {1.0, 0.0, 0.0, polar(1.0, -M_PI / 4)};
+    else if(t == "sx") m = {Complex(0.5, 0.5), Complex(0.5, -0.5), Complex(0.5, -0.5), Complex(0.5, 0.5)};
+    else if(t == "sxdg") m = {Complex(0.5, -0.5), Complex(0.5, 0.5), Complex(0.5, 0.5), Complex(0.5, -0.5)};
+    else if(t == "rx") m = rx_matrix(gate_angle(gate, 0, "theta"));
+    else if(t == "ry") m = ry_matrix(gate_angle(gate, 0, "theta"));
+    else if(t == "rz") m = rz_matrix(gate_angle(gate, 0, "theta"));
+    else if(t == "p" || t == "u1") m = {1.0, 0.0, 0.0, polar(1.0, gate_angle(gate, 0, "lambda"))};
+    else if(t == "u2") m = u3_matrix(M_PI / 2, gate_angle(gate, 0, "phi"), gate_angle(gate, 1, "lambda"));
+    else if(t == "u3" || t == "u") {
+        m = u3_matrix(gate_angle(gate, 0, "theta"), gate_angle(gate, 1, "phi"), gate_angle(gate, 2, "lambda"));
+    } else return false;
+    return true;
+}
+
+// cx, cz and swap, on (qubits[0], qubits[1])
+inline bool two_qubit_unitary(const Gate& gate, Matrix4& m) {
+    if(gate.qubits.size() != 2) return false;
+    m = Matrix4{};
+    if(gate.type == "cx") m = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0};
+    else if(gate.type == "cz") m = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, -1};
+    else if(gate.type == "swap") m = {1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1};
+    else return false;
+    return true;
+}
+
+// CNOTs a native two-qubit gate costs on a CX device
+inline int cnot_cost(const Gate& gate) {
+    if(gate.type == "swap") return 3;
+    return gate.type == "cx" || gate.type == "cz" ? 1 : 0;
+}
+
+// Average gate fidelity (d + |tr(a^dagger b)|^2) / (d (d + 1)), insensitive
+// to global phase
+inline double average_gate_fidelity(const Matrix2& a, const Matrix2& b) {
+    Complex trace = conj(a[0]) * b[0] + conj(a[2]) * b[2] + conj(a[1]) * b[1] + conj(a[3]) * b[3];
+    return (2 + norm(trace)) / 6;
+}
+
+inline double average_gate_fidelity(const Matrix4& a, const Matrix4& b) {
+    Complex trace = 0.0;
+    for(int i = 0; i < 16; i++) trace += conj(a[i]) * b[i];
+    return (4 + norm(trace)) / 20;
+}
+
+// Euler angles with u3_matrix(theta, phi, lambda) equal to m up to phase
+inline void u3_angles(const Matrix2& m, double& theta, double& phi, double& lambda) {
+    theta = 2 * atan2(abs(m[2]), abs(m[0]));
+    if(abs(m[0]) < 1e-12) {
+        lambda = 0;
+        phi = arg(m[2]) - arg(-m[1]);
+    } else if(abs(m[2]) < 1e-12) {
+        phi = 0;
+        lambda = arg(m[3]) - arg(m[0]);
+    } else {
+        phi = arg(m[2]) - arg(m[0]);
+        lambda = arg(-m[1]) - arg(m[0]);
+    }
+}